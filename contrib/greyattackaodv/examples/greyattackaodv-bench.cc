@@ -0,0 +1,1033 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Microbenchmarks for the greyattackaodv data structures.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/greyattackaodv-module.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/udp-socket-factory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <vector>
+
+using namespace ns3;
+using namespace ns3::greyattackaodv;
+
+namespace
+{
+/// Calls to the global operator new since the program started
+uint64_t g_allocations = 0;
+} // namespace
+
+/**
+ * Counting replacement of the global operator new; the array and nothrow
+ * forms forward to it
+ * \param size the number of bytes to allocate
+ * \returns the allocated memory
+ */
+void*
+operator new(std::size_t size)
+{
+    ++g_allocations;
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+/**
+ * Replacement of the global operator delete matching operator new
+ * \param p the memory to release
+ */
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * Replacement of the global sized operator delete matching operator new
+ * \param p the memory to release
+ */
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * \ingroup greyattackaodv-examples
+ * \brief Routing table microbenchmark.
+ *
+ * Fills a routing table with \p nRoutes destinations and then replays, over
+ * simulated time, the lookup / lifetime refresh pattern that packet
+ * forwarding applies to the table.  Routes that are not refreshed expire
+ * and are re-added, so the purge path is exercised too.
+ */
+class RtableBench
+{
+  public:
+    /**
+     * constructor
+     * \param backend the routing table storage backend
+     * \param nRoutes number of destinations
+     * \param nOps number of lookup / refresh operations
+     */
+    RtableBench(RoutingTableBackend backend, uint32_t nRoutes, uint32_t nOps)
+        : m_table(Seconds(15)),
+          m_nRoutes(nRoutes),
+          m_nOps(nOps),
+          m_state(1),
+          m_found(0)
+    {
+        m_table.SetBackend(backend);
+    }
+
+    /**
+     * Run the benchmark
+     * \returns wall clock time, in seconds
+     */
+    double Run()
+    {
+        for (uint32_t i = 0; i < m_nRoutes; ++i)
+        {
+            AddRoute(i);
+        }
+        // 1000 operations per millisecond of simulated time
+        for (uint32_t op = 0; op < m_nOps; op += 1000)
+        {
+            Simulator::Schedule(MicroSeconds(op), &RtableBench::Burst, this, 1000);
+        }
+        auto start = std::chrono::steady_clock::now();
+        Simulator::Run();
+        auto stop = std::chrono::steady_clock::now();
+        Simulator::Destroy();
+        return std::chrono::duration<double>(stop - start).count();
+    }
+
+    /**
+     * \returns the number of successful lookups, identical for all backends
+     */
+    uint64_t GetFound() const
+    {
+        return m_found;
+    }
+
+  private:
+    /**
+     * Add the route to destination number i
+     * \param i the destination index
+     */
+    void AddRoute(uint32_t i)
+    {
+        RoutingTableEntry rt(nullptr,
+                             Ipv4Address(0x0a000001 + i),
+                             true,
+                             1,
+                             Ipv4InterfaceAddress(),
+                             1,
+                             Ipv4Address(0x0a000001 + i % 16),
+                             MilliSeconds(1 + Draw(3000)));
+        m_table.AddRoute(rt);
+    }
+
+    /**
+     * Perform n forwarding-like operations
+     * \param n number of operations
+     */
+    void Burst(uint32_t n)
+    {
+        RoutingTableEntry rt;
+        for (uint32_t k = 0; k < n; ++k)
+        {
+            uint32_t i = Draw(m_nRoutes);
+            if (m_table.LookupValidRoute(Ipv4Address(0x0a000001 + i), rt))
+            {
+                ++m_found;
+                rt.SetLifeTime(std::max(MilliSeconds(Draw(3000)), rt.GetLifeTime()));
+                m_table.Update(rt);
+            }
+            else if (!m_table.LookupRoute(Ipv4Address(0x0a000001 + i), rt))
+            {
+                AddRoute(i);
+            }
+        }
+    }
+
+    /**
+     * \param n the range
+     * \returns a pseudo-random integer in [0, n)
+     */
+    uint32_t Draw(uint32_t n)
+    {
+        m_state = m_state * 1103515245 + 12345;
+        return (m_state >> 8) % n;
+    }
+
+    RoutingTable m_table; //!< table under test
+    uint32_t m_nRoutes;   //!< number of destinations
+    uint32_t m_nOps;      //!< number of operations
+    uint32_t m_state;     //!< pseudo-random generator state
+    uint64_t m_found;     //!< successful lookups
+};
+
+/**
+ * \ingroup greyattackaodv-examples
+ * \brief Forwarding path microbenchmark.
+ *
+ * Replays a stream of forwarded packets, given as (time, origin,
+ * destination) records, against a routing table and a neighbor table, and
+ * applies to them what RoutingProtocol::Forwarding() does for each packet.
+ * The stream is read from a file with one "<microseconds> <origin>
+ * <destination>" record per line, as written by "--bench=record", or
+ * generated if no file is given.
+ * Heap allocations made while forwarding are counted too.
+ */
+class ForwardingBench
+{
+  public:
+    /// A forwarded packet
+    struct Record
+    {
+        Time time;           //!< time the packet is forwarded
+        Ipv4Address origin;  //!< source address
+        Ipv4Address dst;     //!< destination address
+    };
+
+    /**
+     * constructor
+     * \param trace the recorded stream
+     * \param nRoutes number of destinations in the routing table
+     * \param fused use RoutingTable::RefreshActivePath() rather than one
+     * lookup and one update per refreshed route
+     */
+    ForwardingBench(const std::vector<Record>& trace, uint32_t nRoutes, bool fused)
+        : m_trace(trace),
+          m_table(Seconds(15)),
+          m_nb(Seconds(1)),
+          m_nRoutes(nRoutes),
+          m_fused(fused),
+          m_forwarded(0),
+          m_allocations(0)
+    {
+    }
+
+    /**
+     * Generate a stream of forwarded packets
+     * \param nRoutes number of destinations
+     * \param nOps number of packets
+     * \returns the stream
+     */
+    static std::vector<Record> Generate(uint32_t nRoutes, uint32_t nOps)
+    {
+        std::vector<Record> trace;
+        uint32_t state = 1;
+        for (uint32_t op = 0; op < nOps; ++op)
+        {
+            state = state * 1103515245 + 12345;
+            uint32_t origin = (state >> 8) % nRoutes;
+            state = state * 1103515245 + 12345;
+            uint32_t dst = (state >> 8) % nRoutes;
+            trace.push_back({MicroSeconds(op), Ipv4Address(0x0a000001 + origin),
+                             Ipv4Address(0x0a000001 + dst)});
+        }
+        return trace;
+    }
+
+    /**
+     * Read a recorded stream
+     * \param fileName the file name
+     * \returns the stream, empty if the file cannot be read
+     */
+    static std::vector<Record> Read(const std::string& fileName)
+    {
+        std::vector<Record> trace;
+        std::ifstream in(fileName);
+        int64_t us;
+        std::string origin;
+        std::string dst;
+        while (in >> us >> origin >> dst)
+        {
+            trace.push_back({MicroSeconds(us),
+                             Ipv4Address(origin.c_str()),
+                             Ipv4Address(dst.c_str())});
+        }
+        return trace;
+    }
+
+    /**
+     * Run the benchmark
+     * \returns wall clock time, in seconds
+     */
+    double Run()
+    {
+        for (uint32_t i = 0; i < m_nRoutes; ++i)
+        {
+            // Every destination is reached through one of 16 neighbors
+            RoutingTableEntry rt(nullptr,
+                                 Ipv4Address(0x0a000001 + i),
+                                 true,
+                                 1,
+                                 Ipv4InterfaceAddress(),
+                                 (i < 16) ? 1 : 2,
+                                 Ipv4Address(0x0a000001 + i % 16),
+                                 Seconds(3));
+            m_table.AddRoute(rt);
+        }
+        // Routes left unused expire after 3 s
+        for (uint32_t i = 0; i < m_trace.size(); i += 1000)
+        {
+            Simulator::Schedule(m_trace[i].time,
+                                &ForwardingBench::Burst,
+                                this,
+                                i,
+                                std::min<uint32_t>(i + 1000, m_trace.size()));
+        }
+        auto start = std::chrono::steady_clock::now();
+        Simulator::Run();
+        auto stop = std::chrono::steady_clock::now();
+        Simulator::Destroy();
+        return std::chrono::duration<double>(stop - start).count();
+    }
+
+    /**
+     * \returns the number of packets forwarded, identical in both modes
+     */
+    uint64_t GetForwarded() const
+    {
+        return m_forwarded;
+    }
+
+    /**
+     * \returns the number of heap allocations made by the forwarding bursts
+     */
+    uint64_t GetAllocations() const
+    {
+        return m_allocations;
+    }
+
+  private:
+    /**
+     * Forward the packets of records [begin, end)
+     * \param begin first record
+     * \param end past the last record
+     */
+    void Burst(uint32_t begin, uint32_t end)
+    {
+        uint64_t allocations = g_allocations;
+        Time activeRouteTimeout = Seconds(3);
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const Record& r = m_trace[i];
+            if (m_fused)
+            {
+                const RoutingTableEntry* toDst = m_table.FindEntry(r.dst);
+                if (!toDst || toDst->GetFlag() != VALID)
+                {
+                    continue;
+                }
+                Ipv4Address gateway = toDst->GetNextHop();
+                Ipv4Address toOriginNextHop =
+                    m_table.RefreshActivePath(r.origin, r.dst, activeRouteTimeout);
+                m_nb.Update(gateway, activeRouteTimeout);
+                m_nb.Update(toOriginNextHop, activeRouteTimeout);
+            }
+            else
+            {
+                RoutingTableEntry toDst;
+                if (!m_table.LookupValidRoute(r.dst, toDst))
+                {
+                    continue;
+                }
+                Refresh(r.origin, activeRouteTimeout);
+                Refresh(r.dst, activeRouteTimeout);
+                Refresh(toDst.GetNextHop(), activeRouteTimeout);
+                RoutingTableEntry toOrigin;
+                m_table.LookupRoute(r.origin, toOrigin);
+                Refresh(toOrigin.GetNextHop(), activeRouteTimeout);
+                m_nb.Update(toDst.GetNextHop(), activeRouteTimeout);
+                m_nb.Update(toOrigin.GetNextHop(), activeRouteTimeout);
+            }
+            ++m_forwarded;
+        }
+        m_allocations += g_allocations - allocations;
+    }
+
+    /**
+     * Refresh one route the way RoutingProtocol::UpdateRouteLifeTime() did
+     * before RefreshActivePath() existed
+     * \param addr the destination of the route
+     * \param lifetime the minimum lifetime
+     */
+    void Refresh(Ipv4Address addr, Time lifetime)
+    {
+        RoutingTableEntry rt;
+        if (m_table.LookupRoute(addr, rt) && rt.GetFlag() == VALID)
+        {
+            rt.SetRreqCnt(0);
+            rt.SetLifeTime(std::max(lifetime, rt.GetLifeTime()));
+            m_table.Update(rt);
+        }
+    }
+
+    const std::vector<Record>& m_trace; //!< recorded stream
+    RoutingTable m_table;               //!< routing table
+    Neighbors m_nb;                     //!< neighbor table
+    uint32_t m_nRoutes;                 //!< number of destinations
+    bool m_fused;                       //!< use RefreshActivePath()
+    uint64_t m_forwarded;               //!< forwarded packets
+    uint64_t m_allocations;             //!< heap allocations while forwarding
+};
+
+/**
+ * \ingroup greyattackaodv-examples
+ * \brief Deferred route output benchmark.
+ *
+ * Node 0 sends bursts of UDP packets, each burst to a destination it has
+ * no route to, so every packet of a burst takes the loopback detour and
+ * waits in the request queue for the route discovery to complete.  The
+ * nodes share one SimpleChannel.  With bursts closer than 100 ms, route
+ * discoveries are held back by the RREQ rate limit.
+ */
+class DeferredRouteBench
+{
+  public:
+    /**
+     * constructor
+     * \param fastPath value of the DeferredRouteFastPath attribute
+     * \param nNodes number of nodes
+     * \param nBursts number of bursts
+     * \param burstSize number of packets per burst
+     * \param interval time between bursts
+     */
+    DeferredRouteBench(bool fastPath,
+                       uint32_t nNodes,
+                       uint32_t nBursts,
+                       uint32_t burstSize,
+                       Time interval)
+        : m_fastPath(fastPath),
+          m_nNodes(std::max<uint32_t>(nNodes, 2)),
+          m_nBursts(nBursts),
+          m_burstSize(burstSize),
+          m_interval(interval),
+          m_received(0),
+          m_events(0)
+    {
+    }
+
+    /**
+     * Run the benchmark
+     * \returns wall clock time, in seconds
+     */
+    double Run()
+    {
+        NodeContainer nodes;
+        nodes.Create(m_nNodes);
+        greyattackaodvHelper greyattackaodv;
+        greyattackaodv.Set("DeferredRouteFastPath", BooleanValue(m_fastPath));
+        InternetStackHelper internet;
+        internet.SetRoutingHelper(greyattackaodv);
+        internet.Install(nodes);
+        SimpleNetDeviceHelper simple;
+        NetDeviceContainer devices = simple.Install(nodes);
+        Ipv4AddressHelper address;
+        address.SetBase("10.0.0.0", "255.255.0.0");
+        m_interfaces = address.Assign(devices);
+
+        for (uint32_t i = 1; i < m_nNodes; ++i)
+        {
+            Ptr<Socket> rx = Socket::CreateSocket(nodes.Get(i), UdpSocketFactory::GetTypeId());
+            rx->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+            rx->SetRecvCallback(MakeCallback(&DeferredRouteBench::Receive, this));
+        }
+        m_tx = Socket::CreateSocket(nodes.Get(0), UdpSocketFactory::GetTypeId());
+        // Destinations are visited in turn, routes expire after 3 s
+        for (uint32_t burst = 0; burst < m_nBursts; ++burst)
+        {
+            Simulator::ScheduleWithContext(0,
+                                           Seconds(1) + m_interval * burst,
+                                           &DeferredRouteBench::SendBurst,
+                                           this,
+                                           burst);
+        }
+        Simulator::Stop(Seconds(6) + m_interval * m_nBursts);
+        auto start = std::chrono::steady_clock::now();
+        Simulator::Run();
+        auto stop = std::chrono::steady_clock::now();
+        m_events = Simulator::GetEventCount();
+        m_tx = nullptr;
+        Simulator::Destroy();
+        return std::chrono::duration<double>(stop - start).count();
+    }
+
+    /**
+     * \returns the number of packets delivered
+     */
+    uint64_t GetReceived() const
+    {
+        return m_received;
+    }
+
+    /**
+     * \returns the number of simulator events executed
+     */
+    uint64_t GetEvents() const
+    {
+        return m_events;
+    }
+
+  private:
+    /**
+     * Send a burst to the next destination
+     * \param burst the burst index
+     */
+    void SendBurst(uint32_t burst)
+    {
+        Ipv4Address dst = m_interfaces.GetAddress(1 + burst % (m_nNodes - 1));
+        for (uint32_t i = 0; i < m_burstSize; ++i)
+        {
+            m_tx->SendTo(Create<Packet>(512), 0, InetSocketAddress(dst, 9));
+        }
+    }
+
+    /**
+     * Receive packets
+     * \param socket the receiving socket
+     */
+    void Receive(Ptr<Socket> socket)
+    {
+        while (socket->Recv())
+        {
+            ++m_received;
+        }
+    }
+
+    bool m_fastPath;                     //!< value of the DeferredRouteFastPath attribute
+    uint32_t m_nNodes;                   //!< number of nodes
+    uint32_t m_nBursts;                  //!< number of bursts
+    uint32_t m_burstSize;                //!< packets per burst
+    Time m_interval;                     //!< time between bursts
+    uint64_t m_received;                 //!< delivered packets
+    uint64_t m_events;                   //!< executed simulator events
+    Ipv4InterfaceContainer m_interfaces; //!< node addresses
+    Ptr<Socket> m_tx;                    //!< sending socket
+};
+
+/**
+ * \ingroup greyattackaodv-examples
+ * \brief Control overhead of link breaks, with and without RERR coalescing.
+ *
+ * Nodes are laid out on a grid and only hear their eight closest
+ * neighbors.  Random links break for one second, fifty times per second,
+ * while UDP flows cross the grid.  Every transmitted greyattackaodv message is
+ * accounted for, as well as the packets delivered by the flows.  The same
+ * scenario measures the simulator events saved by the TimerWheel of each node,
+ * and records the forwarded packets replayed by ForwardingBench.
+ */
+class RerrBench
+{
+  public:
+    /**
+     * constructor
+     * \param window value of the RerrCoalescingWindow attribute
+     * \param nNodes number of nodes
+     * \param nFlows number of UDP flows
+     * \param duration simulated time
+     * \param timerWheel run the timers on TimerWheels
+     */
+    RerrBench(Time window, uint32_t nNodes, uint32_t nFlows, Time duration, bool timerWheel = false)
+        : m_window(window),
+          m_nNodes(std::max<uint32_t>(nNodes, 4)),
+          m_nFlows(nFlows),
+          m_duration(duration),
+          m_timerWheel(timerWheel),
+          m_sent(0),
+          m_received(0),
+          m_controlBytes(0),
+          m_rerrBytes(0),
+          m_rerrs(0),
+          m_events(0),
+          m_ticks(0)
+    {
+    }
+
+    /**
+     * Write every packet forwarded during the run as a "<microseconds>
+     * <origin> <destination>" line, the input format of ForwardingBench
+     * \param fileName the file name
+     */
+    void Record(const std::string& fileName)
+    {
+        m_record.open(fileName);
+    }
+
+    /**
+     * Run the benchmark
+     * \returns wall clock time, in seconds
+     */
+    double Run()
+    {
+        NodeContainer nodes;
+        nodes.Create(m_nNodes);
+        greyattackaodvHelper greyattackaodv;
+        greyattackaodv.Set("RerrCoalescingWindow", TimeValue(m_window));
+        if (m_timerWheel)
+        {
+            greyattackaodv.EnableTimerWheel();
+        }
+        InternetStackHelper internet;
+        internet.SetRoutingHelper(greyattackaodv);
+        internet.Install(nodes);
+        SimpleNetDeviceHelper simple;
+        m_devices = simple.Install(nodes);
+        Ipv4AddressHelper address;
+        address.SetBase("10.0.0.0", "255.255.0.0");
+        Ipv4InterfaceContainer interfaces = address.Assign(m_devices);
+        // Both runs see the same link breaks and flows
+        int64_t stream = internet.AssignStreams(nodes, 0);
+        stream += greyattackaodv.AssignStreams(nodes, stream);
+        m_rng = CreateObject<UniformRandomVariable>();
+        m_rng->SetStream(stream);
+
+        m_channel = DynamicCast<SimpleChannel>(m_devices.Get(0)->GetChannel());
+        auto side = static_cast<uint32_t>(std::ceil(std::sqrt(m_nNodes)));
+        for (uint32_t i = 0; i < m_nNodes; ++i)
+        {
+            for (uint32_t j = 0; j < m_nNodes; ++j)
+            {
+                if (i == j)
+                {
+                    continue;
+                }
+                uint32_t dx = std::max(i % side, j % side) - std::min(i % side, j % side);
+                uint32_t dy = std::max(i / side, j / side) - std::min(i / side, j / side);
+                if (dx > 1 || dy > 1)
+                {
+                    m_channel->BlackList(GetDevice(i), GetDevice(j));
+                }
+                else if (i < j)
+                {
+                    m_links.emplace_back(i, j);
+                }
+            }
+            nodes.Get(i)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+                "Tx",
+                MakeCallback(&RerrBench::Tx, this));
+            if (m_record.is_open())
+            {
+                nodes.Get(i)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+                    "UnicastForward",
+                    MakeCallback(&RerrBench::Forward, this));
+            }
+            Ptr<Socket> rx = Socket::CreateSocket(nodes.Get(i), UdpSocketFactory::GetTypeId());
+            rx->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+            rx->SetRecvCallback(MakeCallback(&RerrBench::Receive, this));
+            m_sockets.push_back(rx);
+        }
+        m_down.assign(m_links.size(), false);
+        Simulator::Schedule(Seconds(1), &RerrBench::BreakLink, this);
+
+        for (uint32_t flow = 0; flow < m_nFlows; ++flow)
+        {
+            uint32_t src = m_rng->GetInteger(0, m_nNodes - 1);
+            uint32_t dst = (src + m_rng->GetInteger(1, m_nNodes - 1)) % m_nNodes;
+            Ptr<Socket> tx = Socket::CreateSocket(nodes.Get(src), UdpSocketFactory::GetTypeId());
+            m_sockets.push_back(tx);
+            for (Time t = Seconds(1); t < m_duration - Seconds(1); t += MilliSeconds(250))
+            {
+                Simulator::ScheduleWithContext(src,
+                                               t + MilliSeconds(flow),
+                                               &RerrBench::Send,
+                                               this,
+                                               tx,
+                                               interfaces.GetAddress(dst));
+            }
+        }
+        Simulator::Stop(m_duration);
+        auto start = std::chrono::steady_clock::now();
+        Simulator::Run();
+        auto stop = std::chrono::steady_clock::now();
+        m_events = Simulator::GetEventCount();
+        for (uint32_t i = 0; i < m_nNodes; ++i)
+        {
+            Ptr<TimerWheel> wheel = nodes.Get(i)->GetObject<RoutingProtocol>()->GetTimerWheel();
+            m_ticks += wheel ? wheel->GetTicks() : 0;
+        }
+        m_sockets.clear();
+        m_channel = nullptr;
+        m_devices = NetDeviceContainer();
+        Simulator::Destroy();
+        return std::chrono::duration<double>(stop - start).count();
+    }
+
+    /**
+     * \returns the ratio of delivered to sent data packets
+     */
+    double GetPdr() const
+    {
+        return m_sent ? static_cast<double>(m_received) / m_sent : 0;
+    }
+
+    /**
+     * \returns the bytes of greyattackaodv messages sent, IP header included
+     */
+    uint64_t GetControlBytes() const
+    {
+        return m_controlBytes;
+    }
+
+    /**
+     * \returns the bytes of RERR messages sent, IP header included
+     */
+    uint64_t GetRerrBytes() const
+    {
+        return m_rerrBytes;
+    }
+
+    /**
+     * \returns the number of RERR messages sent
+     */
+    uint64_t GetRerrs() const
+    {
+        return m_rerrs;
+    }
+
+    /**
+     * \returns the number of simulator events executed
+     */
+    uint64_t GetEvents() const
+    {
+        return m_events;
+    }
+
+    /**
+     * \returns the number of simulator events run by the TimerWheels
+     */
+    uint64_t GetTicks() const
+    {
+        return m_ticks;
+    }
+
+  private:
+    /**
+     * \param i node index
+     * \returns the device of node i
+     */
+    Ptr<SimpleNetDevice> GetDevice(uint32_t i) const
+    {
+        return DynamicCast<SimpleNetDevice>(m_devices.Get(i));
+    }
+
+    /// Break a random link for one second
+    void BreakLink()
+    {
+        uint32_t link = m_rng->GetInteger(0, m_links.size() - 1);
+        if (!m_down[link])
+        {
+            m_down[link] = true;
+            m_channel->BlackList(GetDevice(m_links[link].first), GetDevice(m_links[link].second));
+            m_channel->BlackList(GetDevice(m_links[link].second), GetDevice(m_links[link].first));
+            Simulator::Schedule(Seconds(1), &RerrBench::RestoreLink, this, link);
+        }
+        Simulator::Schedule(MilliSeconds(20), &RerrBench::BreakLink, this);
+    }
+
+    /**
+     * Restore a broken link
+     * \param link the link index
+     */
+    void RestoreLink(uint32_t link)
+    {
+        m_down[link] = false;
+        m_channel->UnBlackList(GetDevice(m_links[link].first), GetDevice(m_links[link].second));
+        m_channel->UnBlackList(GetDevice(m_links[link].second), GetDevice(m_links[link].first));
+    }
+
+    /**
+     * Send a data packet
+     * \param socket the sending socket
+     * \param dst the destination
+     */
+    void Send(Ptr<Socket> socket, Ipv4Address dst)
+    {
+        ++m_sent;
+        socket->SendTo(Create<Packet>(512), 0, InetSocketAddress(dst, 9));
+    }
+
+    /**
+     * Receive packets
+     * \param socket the receiving socket
+     */
+    void Receive(Ptr<Socket> socket)
+    {
+        while (socket->Recv())
+        {
+            ++m_received;
+        }
+    }
+
+    /**
+     * Account for the greyattackaodv messages sent by a node
+     * \param packet the packet, with its IP header
+     * \param ipv4 the IPv4 stack
+     * \param interface the output interface
+     */
+    void Tx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+    {
+        Ptr<Packet> p = packet->Copy();
+        Ipv4Header ipHeader;
+        p->RemoveHeader(ipHeader);
+        UdpHeader udpHeader;
+        if (ipHeader.GetProtocol() != UdpL4Protocol::PROT_NUMBER || !p->RemoveHeader(udpHeader) ||
+            udpHeader.GetDestinationPort() != RoutingProtocol::greyattack_aodv_PORT)
+        {
+            return;
+        }
+        m_controlBytes += packet->GetSize();
+        TypeHeader typeHeader;
+        p->RemoveHeader(typeHeader);
+        if (typeHeader.Get() == greyattack_aodvTYPE_RERR)
+        {
+            m_rerrBytes += packet->GetSize();
+            ++m_rerrs;
+        }
+    }
+
+    /**
+     * Record a forwarded packet
+     * \param header the IP header of the packet
+     * \param packet the packet, without its IP header
+     * \param interface the output interface
+     */
+    void Forward(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface)
+    {
+        m_record << Simulator::Now().GetMicroSeconds() << " " << header.GetSource() << " "
+                 << header.GetDestination() << "\n";
+    }
+
+    Time m_window;                                       //!< RERR coalescing window
+    uint32_t m_nNodes;                                   //!< number of nodes
+    uint32_t m_nFlows;                                   //!< number of UDP flows
+    Time m_duration;                                     //!< simulated time
+    bool m_timerWheel;                                   //!< timers on TimerWheels
+    uint64_t m_sent;                                     //!< sent data packets
+    uint64_t m_received;                                 //!< delivered data packets
+    uint64_t m_controlBytes;                             //!< bytes of greyattackaodv messages
+    uint64_t m_rerrBytes;                                //!< bytes of RERR messages
+    uint64_t m_rerrs;                                    //!< RERR messages
+    uint64_t m_events;                                   //!< executed simulator events
+    uint64_t m_ticks;                                    //!< events run by the TimerWheels
+    NetDeviceContainer m_devices;                        //!< node devices
+    Ptr<SimpleChannel> m_channel;                        //!< the shared channel
+    Ptr<UniformRandomVariable> m_rng;                    //!< link break and flow draws
+    std::vector<std::pair<uint32_t, uint32_t>> m_links;  //!< links between grid neighbors
+    std::vector<bool> m_down;                            //!< links currently broken
+    std::vector<Ptr<Socket>> m_sockets;                  //!< all sockets
+    std::ofstream m_record;                              //!< forwarded packets, if recorded
+};
+
+/**
+ * \ingroup greyattackaodv-examples
+ * \brief Per-packet cost of the PACKET_DROP_PERC attack draw.
+ *
+ * Compares creating and configuring a UniformRandomVariable for every
+ * forwarded packet with drawing from the pre-seeded per-protocol stream.
+ *
+ * \param nOps number of simulated packets
+ */
+void
+AttackRngBench(uint32_t nOps)
+{
+    double percentDrop = 0.3;
+    uint32_t dropped = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < nOps; ++i)
+    {
+        Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+        rng->SetAttribute("Min", DoubleValue(0));
+        rng->SetAttribute("Max", DoubleValue(1));
+        dropped += (rng->GetValue() < percentDrop);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    Ptr<UniformRandomVariable> attackRng = CreateObject<UniformRandomVariable>();
+    attackRng->SetStream(1);
+    for (uint32_t i = 0; i < nOps; ++i)
+    {
+        dropped += (attackRng->GetValue() < percentDrop);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double perPacket = std::chrono::duration<double, std::nano>(middle - start).count() / nOps;
+    double preSeeded = std::chrono::duration<double, std::nano>(stop - middle).count() / nOps;
+    std::cout << "attack-rng packets=" << nOps << " (dropped " << dropped << ")" << std::endl;
+    std::cout << "  per-packet RNG: " << perPacket << " ns/packet" << std::endl;
+    std::cout << "  pre-seeded RNG: " << preSeeded << " ns/packet" << std::endl;
+}
+
+int
+main(int argc, char** argv)
+{
+    std::string bench = "rtable";
+    uint32_t nRoutes = 1000;
+    uint32_t nOps = 1000000;
+    std::string traceFile;
+    uint32_t nNodes = 20;
+    uint32_t nBursts = 1000;
+    uint32_t burstSize = 32;
+    uint32_t nFlows = 20;
+    Time window = MilliSeconds(20);
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("bench",
+                 "Benchmark to run: rtable, attack-rng, forwarding, deferred, discovery, rerr, "
+                 "timers, record (write the rerr scenario packet stream to --trace)",
+                 bench);
+    cmd.AddValue("routes", "Number of routing table destinations", nRoutes);
+    cmd.AddValue("ops", "Number of operations", nOps);
+    cmd.AddValue("trace",
+                 "Forwarded packet stream to replay (forwarding) or to write (record)",
+                 traceFile);
+    cmd.AddValue("nodes", "Number of nodes (deferred, discovery, rerr, timers benchmarks)", nNodes);
+    cmd.AddValue("bursts", "Number of bursts (deferred, discovery benchmarks)", nBursts);
+    cmd.AddValue("burstSize", "Packets per burst (deferred, discovery benchmarks)", burstSize);
+    cmd.AddValue("flows", "Number of UDP flows (rerr, timers benchmarks)", nFlows);
+    cmd.AddValue("window", "RERR coalescing window (rerr benchmark)", window);
+    cmd.Parse(argc, argv);
+
+    if (bench == "rtable")
+    {
+        RtableBench ordered(ORDERED_MAP, nRoutes, nOps);
+        double orderedTime = ordered.Run();
+        RtableBench hashed(HASH_TABLE, nRoutes, nOps);
+        double hashedTime = hashed.Run();
+        std::cout << "rtable routes=" << nRoutes << " ops=" << nOps << std::endl;
+        std::cout << "  OrderedMap: " << orderedTime << " s (" << ordered.GetFound()
+                  << " hits)" << std::endl;
+        std::cout << "  HashTable:  " << hashedTime << " s (" << hashed.GetFound() << " hits)"
+                  << std::endl;
+    }
+    else if (bench == "attack-rng")
+    {
+        AttackRngBench(nOps);
+    }
+    else if (bench == "forwarding")
+    {
+        std::vector<ForwardingBench::Record> trace =
+            traceFile.empty() ? ForwardingBench::Generate(nRoutes, nOps)
+                              : ForwardingBench::Read(traceFile);
+        ForwardingBench separate(trace, nRoutes, false);
+        double separateTime = separate.Run();
+        ForwardingBench fused(trace, nRoutes, true);
+        double fusedTime = fused.Run();
+        std::cout << "forwarding routes=" << nRoutes << " packets=" << trace.size() << std::endl;
+        std::cout << "  lookup/update per route: " << separateTime << " s ("
+                  << separate.GetForwarded() << " forwarded, " << separate.GetAllocations()
+                  << " allocations)" << std::endl;
+        std::cout << "  RefreshActivePath:       " << fusedTime << " s ("
+                  << fused.GetForwarded() << " forwarded, " << fused.GetAllocations()
+                  << " allocations)" << std::endl;
+    }
+    else if (bench == "deferred")
+    {
+        DeferredRouteBench tagged(false, nNodes, nBursts, burstSize, Seconds(1));
+        double taggedTime = tagged.Run();
+        DeferredRouteBench fast(true, nNodes, nBursts, burstSize, Seconds(1));
+        double fastTime = fast.Run();
+        std::cout << "deferred nodes=" << nNodes << " bursts=" << nBursts
+                  << " burstSize=" << burstSize << std::endl;
+        std::cout << "  tagged:    " << taggedTime << " s (" << tagged.GetReceived()
+                  << " delivered)" << std::endl;
+        std::cout << "  fast path: " << fastTime << " s (" << fast.GetReceived()
+                  << " delivered)" << std::endl;
+    }
+    else if (bench == "discovery")
+    {
+        // 100 new destinations per second, ten times RreqRateLimit
+        DeferredRouteBench discovery(false, nNodes, nBursts, burstSize, MilliSeconds(10));
+        double time = discovery.Run();
+        std::cout << "discovery nodes=" << nNodes << " bursts=" << nBursts
+                  << " burstSize=" << burstSize << std::endl;
+        std::cout << "  " << time << " s, " << discovery.GetEvents() << " events ("
+                  << discovery.GetReceived() << " delivered)" << std::endl;
+    }
+    else if (bench == "rerr")
+    {
+        RerrBench immediate(Seconds(0), nNodes, nFlows, Seconds(60));
+        double immediateTime = immediate.Run();
+        RerrBench coalesced(window, nNodes, nFlows, Seconds(60));
+        double coalescedTime = coalesced.Run();
+        std::cout << "rerr nodes=" << nNodes << " flows=" << nFlows
+                  << " window=" << window.As(Time::MS) << std::endl;
+        std::cout << "  immediate: " << immediateTime << " s, " << immediate.GetEvents()
+                  << " events, " << immediate.GetControlBytes() << " control bytes ("
+                  << immediate.GetRerrBytes() << " in " << immediate.GetRerrs()
+                  << " RERRs), PDR " << immediate.GetPdr() << std::endl;
+        std::cout << "  coalesced: " << coalescedTime << " s, " << coalesced.GetEvents()
+                  << " events, " << coalesced.GetControlBytes() << " control bytes ("
+                  << coalesced.GetRerrBytes() << " in " << coalesced.GetRerrs()
+                  << " RERRs), PDR " << coalesced.GetPdr() << std::endl;
+    }
+    else if (bench == "timers")
+    {
+        RerrBench simulator(Seconds(0), nNodes, nFlows, Seconds(60));
+        double simulatorTime = simulator.Run();
+        RerrBench wheel(Seconds(0), nNodes, nFlows, Seconds(60), true);
+        double wheelTime = wheel.Run();
+        std::cout << "timers nodes=" << nNodes << " flows=" << nFlows << std::endl;
+        std::cout << "  per-timer events: " << simulatorTime << " s, " << simulator.GetEvents()
+                  << " events, " << simulator.GetControlBytes() << " control bytes, PDR "
+                  << simulator.GetPdr() << std::endl;
+        std::cout << "  timer wheel:      " << wheelTime << " s, " << wheel.GetEvents()
+                  << " events (" << wheel.GetTicks() << " ticks), " << wheel.GetControlBytes()
+                  << " control bytes, PDR " << wheel.GetPdr() << std::endl;
+    }
+    else if (bench == "record")
+    {
+        if (traceFile.empty())
+        {
+            std::cerr << "record needs --trace" << std::endl;
+            return 1;
+        }
+        // Replay with --bench=forwarding --routes=<nodes> --trace=<file>
+        RerrBench recorder(Seconds(0), nNodes, nFlows, Seconds(60));
+        recorder.Record(traceFile);
+        double time = recorder.Run();
+        std::cout << "record nodes=" << nNodes << " flows=" << nFlows << std::endl;
+        std::cout << "  " << time << " s, stream written to " << traceFile << std::endl;
+    }
+    else
+    {
+        std::cerr << "Unknown benchmark " << bench << std::endl;
+        return 1;
+    }
+    return 0;
+}
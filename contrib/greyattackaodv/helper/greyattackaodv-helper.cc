@@ -19,8 +19,10 @@
  */
 #include "greyattackaodv-helper.h"
 
+#include "ns3/greyattackaodv-grey-hole-routing-protocol.h"
 #include "ns3/greyattackaodv-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
+#include "ns3/log.h"
 #include "ns3/names.h"
 #include "ns3/node-list.h"
 #include "ns3/ptr.h"
@@ -28,6 +30,8 @@
 namespace ns3
 {
 
+NS_LOG_COMPONENT_DEFINE("greyattackaodvHelper");
+
 greyattackaodvHelper::greyattackaodvHelper()
     : Ipv4RoutingHelper()
 {
@@ -44,13 +48,44 @@ Ptr<Ipv4RoutingProtocol>
 greyattackaodvHelper::Create(Ptr<Node> node) const
 {
     Ptr<greyattackaodv::RoutingProtocol> agent = m_agentFactory.Create<greyattackaodv::RoutingProtocol>();
+    if (m_timerWheelFactory.IsTypeIdSet())
+    {
+        Ptr<greyattackaodv::TimerWheel> wheel =
+            m_timerWheelFactory.Create<greyattackaodv::TimerWheel>();
+        wheel->SetContext(node->GetId());
+        agent->SetTimerWheel(wheel);
+    }
     node->AggregateObject(agent);
     return agent;
 }
 
+void
+greyattackaodvHelper::EnableTimerWheel(Time resolution)
+{
+    m_timerWheelFactory.SetTypeId("ns3::greyattackaodv::TimerWheel");
+    m_timerWheelFactory.Set("Resolution", TimeValue(resolution));
+}
+
+void
+greyattackaodvHelper::SetGreyHole(bool greyHole)
+{
+    m_agentFactory.SetTypeId(greyHole ? greyattackaodv::GreyHoleRoutingProtocol::GetTypeId()
+                                      : greyattackaodv::RoutingProtocol::GetTypeId());
+}
+
 void
 greyattackaodvHelper::Set(std::string name, const AttributeValue& value)
 {
+    // Honest nodes do not carry the attack attributes
+    TypeId::AttributeInformation info;
+    TypeId greyHole = greyattackaodv::GreyHoleRoutingProtocol::GetTypeId();
+    if (!m_agentFactory.GetTypeId().LookupAttributeByName(name, &info) &&
+        greyHole.LookupAttributeByName(name, &info))
+    {
+        NS_LOG_INFO("Attribute " << name << " installs " << greyHole.GetName()
+                                 << ", call SetGreyHole (true) to make it explicit");
+        SetGreyHole(true);
+    }
     m_agentFactory.Set(name, value);
 }
 
@@ -21,6 +21,7 @@
 #ifndef greyattack_aodv_HELPER_H
 #define greyattack_aodv_HELPER_H
 
+#include "ns3/greyattackaodv-timer-wheel.h"
 #include "ns3/ipv4-routing-helper.h"
 #include "ns3/node-container.h"
 #include "ns3/node.h"
@@ -59,9 +60,23 @@ class greyattackaodvHelper : public Ipv4RoutingHelper
      * \param name the name of the attribute to set
      * \param value the value of the attribute to set.
      *
-     * This method controls the attributes of ns3::greyattackaodv::RoutingProtocol
+     * This method controls the attributes of ns3::greyattackaodv::RoutingProtocol,
+     * or of ns3::greyattackaodv::GreyHoleRoutingProtocol after SetGreyHole (true).
+     * For compatibility, setting an attribute that only the grey hole variant
+     * has, such as mStrat or AttackStrategyFactory, calls SetGreyHole (true)
+     * and logs it at INFO level.  Every node gets the same attribute values:
+     * set the attack strategy through AttackStrategyFactory, so that each node
+     * gets its own.
      */
     void Set(std::string name, const AttributeValue& value);
+    /**
+     * \param greyHole install ns3::greyattackaodv::GreyHoleRoutingProtocol
+     * rather than ns3::greyattackaodv::RoutingProtocol
+     *
+     * A grey hole without attack strategy forwards every packet, and may
+     * still record shadow decisions.  The attributes already set are kept.
+     */
+    void SetGreyHole(bool greyHole);
     /**
      * Assign a fixed random variable stream number to the random variables
      * used by this model.  Return the number of streams (possibly zero) that
@@ -74,10 +89,20 @@ class greyattackaodvHelper : public Ipv4RoutingHelper
      * \return the number of stream indices assigned by this helper
      */
     int64_t AssignStreams(NodeContainer c, int64_t stream);
+    /**
+     * Run the periodic timers of each node installed from now on by this
+     * helper, and by its copies, on a ns3::greyattackaodv::TimerWheel of its
+     * own, whose events run in the context of the node
+     *
+     * \param resolution the duration of a wheel tick
+     */
+    void EnableTimerWheel(Time resolution = MilliSeconds(1));
 
   private:
     /** the factory to create greyattackaodv routing object */
     ObjectFactory m_agentFactory;
+    /** the factory of the wheel of each routing object, type unset if disabled */
+    ObjectFactory m_timerWheelFactory;
 };
 
 } // namespace ns3
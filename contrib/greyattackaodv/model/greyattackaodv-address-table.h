@@ -0,0 +1,269 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_ADDRESS_TABLE_H
+#define greyattack_aodv_ADDRESS_TABLE_H
+
+#include "ns3/assert.h"
+#include "ns3/ipv4-address.h"
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+namespace greyattackaodv
+{
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Open-addressing hash table keyed by IPv4 address.
+ *
+ * Values are kept densely packed in insertion order (modulo the swap
+ * performed on erase), so a full walk over the table touches contiguous
+ * memory only.  The index uses linear probing with backward-shift deletion,
+ * so no tombstones accumulate under heavy insert/erase churn.
+ *
+ * Pointers returned by Find() and Insert() remain valid until the next
+ * Insert(), Erase() or Clear().
+ */
+template <typename T>
+class Ipv4AddressTable
+{
+  public:
+    Ipv4AddressTable()
+        : m_bits(0),
+          m_mask(0)
+    {
+    }
+
+    /**
+     * Find the value stored for an address
+     * \param key the address
+     * \returns a pointer to the value, or nullptr if not present
+     */
+    T* Find(Ipv4Address key)
+    {
+        uint32_t slot = FindSlot(key);
+        return (slot == NOT_FOUND) ? nullptr : &m_values[m_slots[slot] - 1];
+    }
+
+    /**
+     * Find the value stored for an address
+     * \param key the address
+     * \returns a pointer to the value, or nullptr if not present
+     */
+    const T* Find(Ipv4Address key) const
+    {
+        uint32_t slot = FindSlot(key);
+        return (slot == NOT_FOUND) ? nullptr : &m_values[m_slots[slot] - 1];
+    }
+
+    /**
+     * Insert a value if the address is not yet present
+     * \param key the address
+     * \param value the value to insert
+     * \returns a pointer to the stored value and true if the value was
+     * inserted, false if an entry for key already existed
+     */
+    std::pair<T*, bool> Insert(Ipv4Address key, const T& value)
+    {
+        uint32_t slot = FindSlot(key);
+        if (slot != NOT_FOUND)
+        {
+            return std::make_pair(&m_values[m_slots[slot] - 1], false);
+        }
+        if ((m_keys.size() + 1) * 2 > m_slots.size())
+        {
+            Grow();
+        }
+        m_keys.push_back(key);
+        m_values.push_back(value);
+        uint32_t i = Home(key);
+        while (m_slots[i] != 0)
+        {
+            i = (i + 1) & m_mask;
+        }
+        m_slots[i] = m_keys.size();
+        return std::make_pair(&m_values.back(), true);
+    }
+
+    /**
+     * Remove the entry for an address
+     * \param key the address
+     * \returns true if an entry was removed
+     */
+    bool Erase(Ipv4Address key)
+    {
+        uint32_t slot = FindSlot(key);
+        if (slot == NOT_FOUND)
+        {
+            return false;
+        }
+        uint32_t index = m_slots[slot] - 1;
+        // Backward-shift deletion (Knuth, Algorithm R)
+        uint32_t i = slot;
+        uint32_t j = slot;
+        while (true)
+        {
+            j = (j + 1) & m_mask;
+            if (m_slots[j] == 0)
+            {
+                break;
+            }
+            uint32_t k = Home(m_keys[m_slots[j] - 1]);
+            if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j)))
+            {
+                continue;
+            }
+            m_slots[i] = m_slots[j];
+            i = j;
+        }
+        m_slots[i] = 0;
+        // Keep values dense: move the last value into the hole
+        uint32_t last = m_keys.size() - 1;
+        if (index != last)
+        {
+            m_slots[FindSlot(m_keys[last])] = index + 1;
+            m_keys[index] = m_keys[last];
+            m_values[index] = std::move(m_values[last]);
+        }
+        m_keys.pop_back();
+        m_values.pop_back();
+        return true;
+    }
+
+    /// Remove all entries
+    void Clear()
+    {
+        m_slots.assign(m_slots.size(), 0);
+        m_keys.clear();
+        m_values.clear();
+    }
+
+    /**
+     * \returns the number of entries
+     */
+    uint32_t GetSize() const
+    {
+        return m_keys.size();
+    }
+
+    /**
+     * \returns true if the table holds no entries
+     */
+    bool IsEmpty() const
+    {
+        return m_keys.empty();
+    }
+
+    /**
+     * \param i dense position, less than GetSize()
+     * \returns the address stored at position i
+     */
+    Ipv4Address GetKey(uint32_t i) const
+    {
+        return m_keys[i];
+    }
+
+    /**
+     * \param i dense position, less than GetSize()
+     * \returns the value stored at position i
+     */
+    T& GetValue(uint32_t i)
+    {
+        return m_values[i];
+    }
+
+    /**
+     * \param i dense position, less than GetSize()
+     * \returns the value stored at position i
+     */
+    const T& GetValue(uint32_t i) const
+    {
+        return m_values[i];
+    }
+
+  private:
+    /// Marker returned by FindSlot() for missing keys
+    static const uint32_t NOT_FOUND = 0xffffffff;
+
+    /**
+     * Fibonacci hashing of the address onto the index
+     * \param key the address
+     * \returns the home slot of key
+     */
+    uint32_t Home(Ipv4Address key) const
+    {
+        return (key.Get() * 2654435769U) >> (32 - m_bits);
+    }
+
+    /**
+     * \param key the address
+     * \returns the index slot holding key, or NOT_FOUND
+     */
+    uint32_t FindSlot(Ipv4Address key) const
+    {
+        if (m_keys.empty())
+        {
+            return NOT_FOUND;
+        }
+        uint32_t i = Home(key);
+        while (m_slots[i] != 0)
+        {
+            if (m_keys[m_slots[i] - 1] == key)
+            {
+                return i;
+            }
+            i = (i + 1) & m_mask;
+        }
+        return NOT_FOUND;
+    }
+
+    /// Double the index size and rehash all keys
+    void Grow()
+    {
+        m_bits = (m_bits == 0) ? 4 : m_bits + 1;
+        NS_ASSERT(m_bits < 32);
+        m_mask = (1U << m_bits) - 1;
+        m_slots.assign(m_mask + 1, 0);
+        for (uint32_t n = 0; n < m_keys.size(); ++n)
+        {
+            uint32_t i = Home(m_keys[n]);
+            while (m_slots[i] != 0)
+            {
+                i = (i + 1) & m_mask;
+            }
+            m_slots[i] = n + 1;
+        }
+    }
+
+    /// log2 of the index size
+    uint32_t m_bits;
+    /// Index size minus one
+    uint32_t m_mask;
+    /// Index: dense position plus one, or zero for an empty slot
+    std::vector<uint32_t> m_slots;
+    /// Dense keys
+    std::vector<Ipv4Address> m_keys;
+    /// Dense values, parallel to m_keys
+    std::vector<T> m_values;
+};
+
+} // namespace greyattackaodv
+} // namespace ns3
+
+#endif /* greyattack_aodv_ADDRESS_TABLE_H */
@@ -0,0 +1,40 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_ATTACK_LOG_H
+#define greyattack_aodv_ATTACK_LOG_H
+
+#include "ns3/log.h"
+
+/*
+ * Per-packet attack log of the routing protocols.  Internal header, not
+ * installed.
+ */
+
+/**
+ * Per-packet attack log statement, logged at ERROR level in the log
+ * component of the file using it.  Compiled in only when the
+ * GREYATTACKAODV_ATTACK_LOG CMake option is enabled, as it is by default
+ * in debug builds, so that other builds do no string formatting on the
+ * forwarding path even with ERROR logging turned on; use the
+ * AttackDecision trace source instead.
+ */
+#ifdef GREYATTACKAODV_ATTACK_LOG
+#define GREYATTACKAODV_LOG_ATTACK(msg) NS_LOG_ERROR(msg)
+#else
+#define GREYATTACKAODV_LOG_ATTACK(msg)
+#endif
+
+#endif /* greyattack_aodv_ATTACK_LOG_H */
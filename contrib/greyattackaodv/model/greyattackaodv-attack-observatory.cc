@@ -0,0 +1,356 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "greyattackaodv-attack-observatory.h"
+
+#include "greyattackaodv-binary-io.h"
+#include "greyattackaodv-node-index.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("greyattackaodvAttackObservatory");
+
+namespace greyattackaodv
+{
+
+namespace
+{
+
+/// First bytes of an observatory file
+const char MAGIC[4] = {'G', 'A', 'A', 'O'};
+/// Version of the file format
+const uint8_t VERSION = 1;
+
+/**
+ * \returns the observatory of the simulation
+ */
+Ptr<AttackObservatory>&
+GetInstance()
+{
+    static Ptr<AttackObservatory> instance;
+    return instance;
+}
+
+} // namespace
+
+NS_OBJECT_ENSURE_REGISTERED(AttackObservatory);
+
+TypeId
+AttackObservatory::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::greyattackaodv::AttackObservatory")
+            .SetParent<Object>()
+            .SetGroupName("greyattackaodv")
+            .AddConstructor<AttackObservatory>()
+            .AddAttribute("BucketWidth",
+                          "The duration of a time bucket of the drop matrix, at least 1 ms. "
+                          "The matrix holds every bucket up to the last drop.",
+                          TimeValue(Seconds(10)),
+                          MakeTimeAccessor(&AttackObservatory::m_bucketWidth),
+                          MakeTimeChecker(MilliSeconds(1)));
+    return tid;
+}
+
+AttackObservatory::AttackObservatory()
+    : m_bucketWidth(Seconds(10)),
+      m_nNodes(0),
+      m_nBuckets(0),
+      m_nSnapshots(0)
+{
+}
+
+AttackObservatory::~AttackObservatory()
+{
+}
+
+void
+AttackObservatory::DoDispose()
+{
+    m_snapshotEvent.Cancel();
+    m_drops.clear();
+    m_rows.clear();
+    m_rowOf.clear();
+    m_nNodes = 0;
+    m_nBuckets = 0;
+    Object::DoDispose();
+}
+
+Ptr<AttackObservatory>
+AttackObservatory::Get()
+{
+    Ptr<AttackObservatory>& instance = GetInstance();
+    if (!instance)
+    {
+        instance = CreateObject<AttackObservatory>();
+        Simulator::ScheduleDestroy(&AttackObservatory::Reset);
+    }
+    return instance;
+}
+
+Ptr<AttackObservatory>
+AttackObservatory::Find()
+{
+    return GetInstance();
+}
+
+void
+AttackObservatory::Reset()
+{
+    Ptr<AttackObservatory>& instance = GetInstance();
+    if (instance)
+    {
+        instance->Dispose();
+        instance = nullptr;
+    }
+}
+
+uint32_t
+AttackObservatory::GetColumn(uint32_t precursor) const
+{
+    return precursor == Ipv4NodeIndex::NOT_FOUND ? m_nNodes : precursor;
+}
+
+uint32_t
+AttackObservatory::GetRow(uint32_t attacker) const
+{
+    if (attacker >= m_rowOf.size())
+    {
+        return NO_ROW;
+    }
+    return m_rowOf[attacker];
+}
+
+uint64_t
+AttackObservatory::GetOffset(uint32_t bucket, uint32_t row) const
+{
+    return (uint64_t(bucket) * m_rows.size() + row) * (m_nNodes + 1);
+}
+
+void
+AttackObservatory::Resize(uint32_t nRows, uint32_t nNodes)
+{
+    NS_LOG_FUNCTION(this << nRows << nNodes);
+    // Move the rows of every bucket to the new layout
+    uint64_t columns = nNodes + 1;
+    std::vector<uint32_t> drops(uint64_t(m_nBuckets) * nRows * columns, 0);
+    for (uint32_t bucket = 0; bucket < m_nBuckets; ++bucket)
+    {
+        for (uint32_t row = 0; row < m_rows.size(); ++row)
+        {
+            auto oldRow = m_drops.begin() + GetOffset(bucket, row);
+            auto newRow = drops.begin() + (uint64_t(bucket) * nRows + row) * columns;
+            std::copy(oldRow, oldRow + m_nNodes, newRow);
+            newRow[nNodes] = oldRow[m_nNodes];
+        }
+    }
+    m_drops.swap(drops);
+    m_nNodes = nNodes;
+}
+
+void
+AttackObservatory::RecordDrop(uint32_t attacker, uint32_t precursor)
+{
+    uint32_t row = GetRow(attacker);
+    bool newPrecursor = precursor != Ipv4NodeIndex::NOT_FOUND && precursor >= m_nNodes;
+    if (row == NO_ROW || newPrecursor)
+    {
+        uint32_t nRows = m_rows.size() + (row == NO_ROW);
+        uint32_t nNodes = std::max(m_nNodes, NodeList::GetNNodes());
+        if (newPrecursor)
+        {
+            nNodes = std::max(nNodes, precursor + 1);
+        }
+        Resize(nRows, nNodes);
+        if (row == NO_ROW)
+        {
+            row = m_rows.size();
+            m_rows.push_back(attacker);
+            if (attacker >= m_rowOf.size())
+            {
+                m_rowOf.resize(attacker + 1, uint32_t(NO_ROW));
+            }
+            m_rowOf[attacker] = row;
+        }
+    }
+    uint64_t bucket = Simulator::Now().GetTimeStep() / m_bucketWidth.GetTimeStep();
+    if (bucket >= m_nBuckets)
+    {
+        NS_ABORT_MSG_IF(bucket >= MAX_BUCKETS,
+                        "Drop at " << Simulator::Now().As(Time::S) << " beyond the "
+                                   << MAX_BUCKETS << " buckets of width "
+                                   << m_bucketWidth.As(Time::S));
+        m_nBuckets = bucket + 1;
+        m_drops.resize(GetOffset(m_nBuckets, 0), 0);
+    }
+    m_drops[GetOffset(bucket, row) + GetColumn(precursor)]++;
+}
+
+Time
+AttackObservatory::GetBucketWidth() const
+{
+    return m_bucketWidth;
+}
+
+uint32_t
+AttackObservatory::GetNBuckets() const
+{
+    return m_nBuckets;
+}
+
+uint32_t
+AttackObservatory::GetNNodes() const
+{
+    return m_nNodes;
+}
+
+uint32_t
+AttackObservatory::GetNAttackers() const
+{
+    return m_rows.size();
+}
+
+uint32_t
+AttackObservatory::GetAttackerNode(uint32_t row) const
+{
+    NS_ASSERT(row < m_rows.size());
+    return m_rows[row];
+}
+
+uint64_t
+AttackObservatory::GetNCells() const
+{
+    return m_drops.size();
+}
+
+uint32_t
+AttackObservatory::GetDrops(uint32_t bucket, uint32_t attacker, uint32_t precursor) const
+{
+    uint32_t row = GetRow(attacker);
+    if (bucket >= m_nBuckets || row == NO_ROW ||
+        (precursor != Ipv4NodeIndex::NOT_FOUND && precursor >= m_nNodes))
+    {
+        return 0;
+    }
+    return m_drops[GetOffset(bucket, row) + GetColumn(precursor)];
+}
+
+void
+AttackObservatory::GetBuckets(Time from, Time to, uint32_t& first, uint32_t& last) const
+{
+    int64_t width = m_bucketWidth.GetTimeStep();
+    first = std::min<int64_t>((std::max<int64_t>(from.GetTimeStep(), 0) + width - 1) / width,
+                              m_nBuckets);
+    last = std::min<int64_t>((std::max<int64_t>(to.GetTimeStep(), 0) + width - 1) / width,
+                             m_nBuckets);
+}
+
+uint32_t
+AttackObservatory::GetAttackerDrops(uint32_t attacker, Time from, Time to) const
+{
+    uint32_t row = GetRow(attacker);
+    if (row == NO_ROW)
+    {
+        return 0;
+    }
+    uint32_t first;
+    uint32_t last;
+    GetBuckets(from, to, first, last);
+    uint32_t drops = 0;
+    for (uint32_t bucket = first; bucket < last; ++bucket)
+    {
+        auto counts = m_drops.begin() + GetOffset(bucket, row);
+        drops = std::accumulate(counts, counts + m_nNodes + 1, drops);
+    }
+    return drops;
+}
+
+uint32_t
+AttackObservatory::GetPrecursorDrops(uint32_t precursor, Time from, Time to) const
+{
+    if (precursor != Ipv4NodeIndex::NOT_FOUND && precursor >= m_nNodes)
+    {
+        return 0;
+    }
+    uint32_t first;
+    uint32_t last;
+    GetBuckets(from, to, first, last);
+    uint32_t column = GetColumn(precursor);
+    uint32_t drops = 0;
+    for (uint64_t offset = GetOffset(first, 0); offset < GetOffset(last, 0);
+         offset += m_nNodes + 1)
+    {
+        drops += m_drops[offset + column];
+    }
+    return drops;
+}
+
+void
+AttackObservatory::Save(const std::string& filename) const
+{
+    NS_LOG_FUNCTION(this << filename);
+    std::ofstream os(filename, std::ios::binary);
+    NS_ABORT_MSG_UNLESS(os, "Cannot open " << filename);
+    // Header, node id of each attacker row, then the counters
+    os.write(MAGIC, sizeof(MAGIC));
+    WriteLe(os, VERSION, 1);
+    WriteLe(os, m_bucketWidth.GetNanoSeconds(), 8);
+    WriteLe(os, m_nNodes, 4);
+    WriteLe(os, m_rows.size(), 4);
+    WriteLe(os, m_nBuckets, 4);
+    WriteLeArray(os, m_rows.data(), m_rows.size());
+    WriteLeArray(os, m_drops.data(), m_drops.size());
+    NS_ABORT_MSG_UNLESS(os, "Cannot write " << filename);
+}
+
+void
+AttackObservatory::EnableSnapshots(Time interval, const std::string& prefix)
+{
+    NS_LOG_FUNCTION(this << interval << prefix);
+    NS_ABORT_MSG_UNLESS(interval.IsStrictlyPositive(), "Snapshots need a positive interval");
+    m_snapshotInterval = interval;
+    m_snapshotPrefix = prefix;
+    m_snapshotEvent.Cancel();
+    m_snapshotEvent = Simulator::Schedule(interval, &AttackObservatory::Snapshot, this);
+}
+
+void
+AttackObservatory::Snapshot()
+{
+    std::ostringstream filename;
+    filename << m_snapshotPrefix << "-" << m_nSnapshots++ << ".bin";
+    Save(filename.str());
+    // Once nothing else is scheduled, the matrix cannot change any more
+    if (Simulator::IsFinished())
+    {
+        NS_LOG_LOGIC("No more events, last snapshot");
+        return;
+    }
+    m_snapshotEvent = Simulator::Schedule(m_snapshotInterval, &AttackObservatory::Snapshot, this);
+}
+
+} // namespace greyattackaodv
+} // namespace ns3
@@ -0,0 +1,199 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_ATTACK_OBSERVATORY_H
+#define greyattack_aodv_ATTACK_OBSERVATORY_H
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+namespace greyattackaodv
+{
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Drops of all the grey hole nodes of a simulation, in one matrix.
+ *
+ * The drops are counted in a single contiguous array indexed by time
+ * bucket, attacker and precursor node id, in that order, so that the drops
+ * of a bucket, and of an attacker within a bucket, are adjacent.  Attackers
+ * get a row on their first drop, so that the matrix grows with the number
+ * of nodes that actually drop packets, not with the number of nodes.  The
+ * last precursor column counts the drops whose precursor is unknown.
+ * Every bucket up to the last drop is held, so that the matrix takes 4
+ * bytes per bucket, attacker and precursor; BucketWidth is at least 1 ms.
+ *
+ * Observation is enabled by calling Get() before the grey hole nodes are
+ * initialized; they then count every drop in the observatory, in addition
+ * to their DropStats.  The observatory is dropped by Simulator::Destroy(),
+ * so reports read it, or save it, before.
+ */
+class AttackObservatory : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    AttackObservatory();
+    ~AttackObservatory() override;
+
+    /**
+     * \returns the observatory of the simulation, created on first use
+     */
+    static Ptr<AttackObservatory> Get();
+    /**
+     * \returns the observatory of the simulation, or null if Get() was not called
+     */
+    static Ptr<AttackObservatory> Find();
+
+    /**
+     * Count a dropped packet in the current time bucket
+     * \param attacker the node id of the node that dropped the packet
+     * \param precursor the node id of its precursor, or Ipv4NodeIndex::NOT_FOUND
+     */
+    void RecordDrop(uint32_t attacker, uint32_t precursor);
+
+    /**
+     * \returns the duration of a time bucket
+     */
+    Time GetBucketWidth() const;
+    /**
+     * \returns the number of time buckets, up to the last drop
+     */
+    uint32_t GetNBuckets() const;
+    /**
+     * \returns the number of known precursor columns of the matrix
+     */
+    uint32_t GetNNodes() const;
+    /**
+     * \returns the number of attacker rows of the matrix
+     */
+    uint32_t GetNAttackers() const;
+    /**
+     * \param row an attacker row, less than GetNAttackers()
+     * \returns the node id of the attacker
+     */
+    uint32_t GetAttackerNode(uint32_t row) const;
+    /**
+     * \returns the number of drop counters held by the matrix
+     */
+    uint64_t GetNCells() const;
+    /**
+     * \param bucket the time bucket
+     * \param attacker the node id of the attacker
+     * \param precursor the node id of the precursor, or Ipv4NodeIndex::NOT_FOUND
+     * \returns the number of packets from the precursor dropped by the attacker during the bucket
+     */
+    uint32_t GetDrops(uint32_t bucket, uint32_t attacker, uint32_t precursor) const;
+    /**
+     * \param attacker the node id of the attacker
+     * \param from the start of the time range
+     * \param to the end of the time range, excluded
+     * \returns the number of packets dropped by the attacker during the
+     * buckets starting in the range
+     */
+    uint32_t GetAttackerDrops(uint32_t attacker, Time from, Time to) const;
+    /**
+     * \param precursor the node id of the precursor, or Ipv4NodeIndex::NOT_FOUND
+     * \param from the start of the time range
+     * \param to the end of the time range, excluded
+     * \returns the number of packets from the precursor dropped by any
+     * attacker during the buckets starting in the range
+     */
+    uint32_t GetPrecursorDrops(uint32_t precursor, Time from, Time to) const;
+
+    /**
+     * Write the matrix to a binary file
+     * \param filename the file name
+     */
+    void Save(const std::string& filename) const;
+    /**
+     * Save the matrix periodically, to files named prefix-N.bin.  A
+     * snapshot taken while no other event is scheduled is the last one, so
+     * that snapshots do not keep a simulation without a stop time running.
+     * \param interval the time between two snapshots
+     * \param prefix the file name prefix
+     */
+    void EnableSnapshots(Time interval, const std::string& prefix);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Row of the nodes that never dropped a packet
+    static const uint32_t NO_ROW = 0xffffffff;
+    /// Number of time buckets a matrix can hold
+    static const uint64_t MAX_BUCKETS = 0xffffffff;
+
+    /**
+     * \param precursor the node id of the precursor, or Ipv4NodeIndex::NOT_FOUND
+     * \returns the column of the precursor
+     */
+    uint32_t GetColumn(uint32_t precursor) const;
+    /**
+     * \param attacker the node id of an attacker
+     * \returns the row of the attacker, or NO_ROW
+     */
+    uint32_t GetRow(uint32_t attacker) const;
+    /**
+     * \param row an attacker row
+     * \param bucket a time bucket
+     * \returns the index of the first counter of the row in the bucket
+     */
+    uint64_t GetOffset(uint32_t bucket, uint32_t row) const;
+    /**
+     * Move the counters to a larger matrix
+     * \param nRows the number of attacker rows
+     * \param nNodes the number of known precursor columns
+     */
+    void Resize(uint32_t nRows, uint32_t nNodes);
+    /**
+     * \param from the start of a time range
+     * \param to the end of the time range, excluded
+     * \param [out] first the first bucket starting in the range
+     * \param [out] last the bucket after the last one starting in the range
+     */
+    void GetBuckets(Time from, Time to, uint32_t& first, uint32_t& last) const;
+    /// Save the matrix and schedule the next snapshot
+    void Snapshot();
+    /// Drop the observatory of the simulation
+    static void Reset();
+
+    Time m_bucketWidth;            ///< duration of a time bucket
+    uint32_t m_nNodes;             ///< known precursor columns per row
+    uint32_t m_nBuckets;           ///< time buckets
+    std::vector<uint32_t> m_rows;  ///< node id of each attacker row
+    std::vector<uint32_t> m_rowOf; ///< attacker row of each node id, or NO_ROW
+    std::vector<uint32_t> m_drops; ///< [bucket][attacker row][precursor] drop counts
+    Time m_snapshotInterval;       ///< time between two snapshots
+    std::string m_snapshotPrefix;  ///< snapshot file name prefix
+    uint32_t m_nSnapshots;         ///< snapshots written
+    EventId m_snapshotEvent;       ///< next snapshot
+};
+
+} // namespace greyattackaodv
+} // namespace ns3
+
+#endif /* greyattack_aodv_ATTACK_OBSERVATORY_H */
@@ -0,0 +1,229 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "greyattackaodv-attack-schedule.h"
+
+#include "greyattackaodv-binary-io.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("greyattackaodvAttackSchedule");
+
+namespace greyattackaodv
+{
+
+namespace
+{
+
+/// First bytes of a schedule file
+const char MAGIC[4] = {'G', 'A', 'A', 'S'};
+/// Version of the file format
+const uint8_t VERSION = 1;
+
+} // namespace
+
+NS_OBJECT_ENSURE_REGISTERED(AttackSchedule);
+
+TypeId
+AttackSchedule::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::greyattackaodv::AttackSchedule")
+            .SetParent<Object>()
+            .SetGroupName("greyattackaodv")
+            .AddConstructor<AttackSchedule>()
+            .AddAttribute("Duration",
+                          "The end of the run, no drop window is generated past it.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&AttackSchedule::m_duration),
+                          MakeTimeChecker());
+    return tid;
+}
+
+AttackSchedule::AttackSchedule()
+{
+}
+
+AttackSchedule::~AttackSchedule()
+{
+}
+
+void
+AttackSchedule::DoDispose()
+{
+    m_transitions.clear();
+    m_selections.clear();
+    Object::DoDispose();
+}
+
+bool
+AttackSchedule::HasWindows(uint32_t nodeId) const
+{
+    return m_transitions.count(nodeId) > 0;
+}
+
+void
+AttackSchedule::GenerateWindows(uint32_t nodeId,
+                                Ptr<UniformRandomVariable> rng,
+                                double dropChance,
+                                Time start,
+                                Time length)
+{
+    NS_LOG_FUNCTION(this << nodeId << dropChance << start << length);
+    NS_ABORT_MSG_IF(m_duration.IsZero(), "AttackSchedule needs a Duration to draw drop windows");
+    NS_ABORT_MSG_UNLESS(length.IsStrictlyPositive(), "Drop windows must not be empty");
+    std::vector<Time>& transitions = m_transitions[nodeId];
+    transitions.clear();
+    bool dropping = false;
+    for (Time t = start; t < m_duration; t += length)
+    {
+        if ((rng->GetValue() < dropChance) != dropping)
+        {
+            dropping = !dropping;
+            transitions.push_back(t);
+        }
+    }
+}
+
+const std::vector<Time>&
+AttackSchedule::GetTransitions(uint32_t nodeId) const
+{
+    auto it = m_transitions.find(nodeId);
+    NS_ASSERT_MSG(it != m_transitions.end(), "No drop windows for node " << nodeId);
+    return it->second;
+}
+
+bool
+AttackSchedule::HasSelection(uint32_t nodeId) const
+{
+    return m_selections.count(nodeId) > 0;
+}
+
+void
+AttackSchedule::GenerateSelection(uint32_t nodeId,
+                                  Ptr<UniformRandomVariable> rng,
+                                  double selectChance,
+                                  uint32_t nNodes)
+{
+    NS_LOG_FUNCTION(this << nodeId << selectChance << nNodes);
+    std::vector<bool>& selected = m_selections[nodeId];
+    selected.clear();
+    for (uint32_t node = 0; node < nNodes; node++)
+    {
+        selected.push_back(rng->GetValue() < selectChance);
+    }
+}
+
+const std::vector<bool>&
+AttackSchedule::GetSelection(uint32_t nodeId) const
+{
+    auto it = m_selections.find(nodeId);
+    NS_ASSERT_MSG(it != m_selections.end(), "No selected nodes for node " << nodeId);
+    return it->second;
+}
+
+void
+AttackSchedule::Save(const std::string& filename) const
+{
+    NS_LOG_FUNCTION(this << filename);
+    std::ofstream os(filename, std::ios::binary);
+    NS_ABORT_MSG_UNLESS(os, "Cannot open " << filename);
+    os.write(MAGIC, sizeof(MAGIC));
+    WriteLe(os, VERSION, 1);
+
+    // Transitions are stored in nanoseconds
+    WriteLe(os, m_transitions.size(), 4);
+    for (const auto& entry : m_transitions)
+    {
+        WriteLe(os, entry.first, 4);
+        WriteLe(os, entry.second.size(), 4);
+        for (const auto& t : entry.second)
+        {
+            WriteLe(os, t.GetNanoSeconds(), 8);
+        }
+    }
+
+    // Selections are stored as bitmaps
+    WriteLe(os, m_selections.size(), 4);
+    for (const auto& entry : m_selections)
+    {
+        WriteLe(os, entry.first, 4);
+        WriteLe(os, entry.second.size(), 4);
+        uint8_t byte = 0;
+        for (uint32_t node = 0; node < entry.second.size(); ++node)
+        {
+            byte |= entry.second[node] << (node % 8);
+            if (node % 8 == 7 || node + 1 == entry.second.size())
+            {
+                os.put(static_cast<char>(byte));
+                byte = 0;
+            }
+        }
+    }
+    NS_ABORT_MSG_UNLESS(os, "Cannot write " << filename);
+}
+
+void
+AttackSchedule::Load(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    std::ifstream is(filename, std::ios::binary);
+    NS_ABORT_MSG_UNLESS(is, "Cannot open " << filename);
+    char magic[sizeof(MAGIC)];
+    is.read(magic, sizeof(magic));
+    NS_ABORT_MSG_UNLESS(is && std::equal(magic, magic + sizeof(magic), MAGIC),
+                        filename << " is not an attack schedule");
+    NS_ABORT_MSG_UNLESS(ReadLe(is, 1) == VERSION, "Unsupported version of " << filename);
+
+    m_transitions.clear();
+    uint32_t nWindows = ReadLe(is, 4);
+    for (uint32_t i = 0; i < nWindows && is; ++i)
+    {
+        std::vector<Time>& transitions = m_transitions[ReadLe(is, 4)];
+        uint32_t count = ReadLe(is, 4);
+        for (uint32_t j = 0; j < count && is; ++j)
+        {
+            transitions.push_back(NanoSeconds(static_cast<int64_t>(ReadLe(is, 8))));
+        }
+    }
+
+    m_selections.clear();
+    uint32_t nSelections = ReadLe(is, 4);
+    for (uint32_t i = 0; i < nSelections && is; ++i)
+    {
+        std::vector<bool>& selected = m_selections[ReadLe(is, 4)];
+        uint32_t nNodes = ReadLe(is, 4);
+        uint8_t byte = 0;
+        for (uint32_t node = 0; node < nNodes && is; ++node)
+        {
+            if (node % 8 == 0)
+            {
+                byte = ReadLe(is, 1);
+            }
+            selected.push_back((byte >> (node % 8)) & 1);
+        }
+    }
+    NS_ABORT_MSG_UNLESS(is, filename << " is truncated");
+}
+
+} // namespace greyattackaodv
+} // namespace ns3
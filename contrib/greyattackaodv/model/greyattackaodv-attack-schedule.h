@@ -0,0 +1,128 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_ATTACK_SCHEDULE_H
+#define greyattack_aodv_ATTACK_SCHEDULE_H
+
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+namespace greyattackaodv
+{
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Drop windows and selected precursors of the attackers of a run.
+ *
+ * The time window strategy of a node is described by the times at which
+ * it switches between forwarding and dropping, starting with forwarding.
+ * The select strategy of a node is described by the selected node ids.
+ * Both are drawn once, for the whole Duration of the run, the first time a
+ * strategy of the node is installed, or loaded from a file written by a
+ * previous run.  Strategies sharing a schedule replay it without drawing
+ * from their random variable, so that the same attack pattern can be run
+ * against several defenses.
+ */
+class AttackSchedule : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    AttackSchedule();
+    ~AttackSchedule() override;
+
+    /**
+     * \param nodeId the node id of an attacker
+     * \returns true if the drop windows of the node are known
+     */
+    bool HasWindows(uint32_t nodeId) const;
+    /**
+     * Draw the drop windows of a node, with one draw per window as
+     * TimeWindowAttackStrategy does, but all at once
+     * \param nodeId the node id of the attacker
+     * \param rng uniform [0, 1) draws, one per window
+     * \param dropChance the probability that a window is a drop window
+     * \param start the start of the first window
+     * \param length the length of a window
+     */
+    void GenerateWindows(uint32_t nodeId,
+                         Ptr<UniformRandomVariable> rng,
+                         double dropChance,
+                         Time start,
+                         Time length);
+    /**
+     * \param nodeId the node id of an attacker
+     * \returns the sorted times the node switches between forwarding and dropping
+     */
+    const std::vector<Time>& GetTransitions(uint32_t nodeId) const;
+
+    /**
+     * \param nodeId the node id of an attacker
+     * \returns true if the selected nodes of the node are known
+     */
+    bool HasSelection(uint32_t nodeId) const;
+    /**
+     * Draw the selected nodes of a node, as SelectAttackStrategy would
+     * \param nodeId the node id of the attacker
+     * \param rng uniform [0, 1) draws, one per node
+     * \param selectChance the probability that a node is selected
+     * \param nNodes the number of nodes
+     */
+    void GenerateSelection(uint32_t nodeId,
+                           Ptr<UniformRandomVariable> rng,
+                           double selectChance,
+                           uint32_t nNodes);
+    /**
+     * \param nodeId the node id of an attacker
+     * \returns the selected nodes, by node id
+     */
+    const std::vector<bool>& GetSelection(uint32_t nodeId) const;
+
+    /**
+     * Write the schedule to a binary file
+     * \param filename the file name
+     */
+    void Save(const std::string& filename) const;
+    /**
+     * Replace the schedule with the content of a file written by Save()
+     * \param filename the file name
+     */
+    void Load(const std::string& filename);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    Time m_duration;                                     ///< end of the generated windows
+    std::map<uint32_t, std::vector<Time>> m_transitions; ///< transitions, by attacker
+    std::map<uint32_t, std::vector<bool>> m_selections;  ///< selected nodes, by attacker
+};
+
+} // namespace greyattackaodv
+} // namespace ns3
+
+#endif /* greyattack_aodv_ATTACK_SCHEDULE_H */
@@ -0,0 +1,526 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "greyattackaodv-attack-strategy.h"
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("greyattackaodvAttackStrategy");
+
+namespace greyattackaodv
+{
+
+NS_OBJECT_ENSURE_REGISTERED(AttackStrategy);
+
+TypeId
+AttackStrategy::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::greyattackaodv::AttackStrategy")
+                            .SetParent<Object>()
+                            .SetGroupName("greyattackaodv")
+                            .AddAttribute("MinPacketSize",
+                                          "Only packets larger than this many bytes are attacked.",
+                                          UintegerValue(400),
+                                          MakeUintegerAccessor(&AttackStrategy::m_minPacketSize),
+                                          MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+AttackStrategy::AttackStrategy()
+    : m_minPacketSize(400),
+      m_installed(false)
+{
+}
+
+AttackStrategy::~AttackStrategy()
+{
+}
+
+void
+AttackStrategy::Install(const AttackEnvironment& env)
+{
+    // A strategy shared by several nodes would mix their timers and draws
+    NS_ABORT_MSG_IF(m_installed,
+                    GetInstanceTypeId().GetName()
+                        << " installed twice; give each node its own strategy, e.g. "
+                           "through the AttackStrategyFactory attribute");
+    m_installed = true;
+    DoInstall(env);
+}
+
+void
+AttackStrategy::DoInstall(const AttackEnvironment& /* env */)
+{
+}
+
+bool
+AttackStrategy::IsSilentDrop() const
+{
+    return false;
+}
+
+NS_OBJECT_ENSURE_REGISTERED(PercentAttackStrategy);
+
+TypeId
+PercentAttackStrategy::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::greyattackaodv::PercentAttackStrategy")
+            .SetParent<AttackStrategy>()
+            .SetGroupName("greyattackaodv")
+            .AddConstructor<PercentAttackStrategy>()
+            .AddAttribute("DropProbability",
+                          "The probability that a packet is dropped.",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&PercentAttackStrategy::m_probability),
+                          MakeDoubleChecker<double>());
+    return tid;
+}
+
+PercentAttackStrategy::PercentAttackStrategy()
+    : m_probability(0.0)
+{
+}
+
+void
+PercentAttackStrategy::DoInstall(const AttackEnvironment& env)
+{
+    m_rng = env.rng;
+}
+
+bool
+PercentAttackStrategy::Decide(AttackContext& ctx)
+{
+    // Draw for every packet, so that the stream does not depend on packet sizes
+    double randomDouble = m_rng->GetValue();
+    return randomDouble < m_probability && IsTargetSize(ctx.packetSize);
+}
+
+AttackStratSelect
+PercentAttackStrategy::GetKind() const
+{
+    return PACKET_DROP_PERC;
+}
+
+bool
+PercentAttackStrategy::IsSilentDrop() const
+{
+    return true;
+}
+
+void
+PercentAttackStrategy::DoDispose()
+{
+    m_rng = nullptr;
+    AttackStrategy::DoDispose();
+}
+
+NS_OBJECT_ENSURE_REGISTERED(ConnectionAttackStrategy);
+
+TypeId
+ConnectionAttackStrategy::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::greyattackaodv::ConnectionAttackStrategy")
+            .SetParent<AttackStrategy>()
+            .SetGroupName("greyattackaodv")
+            .AddConstructor<ConnectionAttackStrategy>()
+            .AddAttribute("Threshold",
+                          "Packets are dropped when the connection strength to the precursor "
+                          "is below this value.",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&ConnectionAttackStrategy::m_threshold),
+                          MakeDoubleChecker<double>());
+    return tid;
+}
+
+ConnectionAttackStrategy::ConnectionAttackStrategy()
+    : m_threshold(0.0)
+{
+}
+
+void
+ConnectionAttackStrategy::DoInstall(const AttackEnvironment& env)
+{
+    m_targetNodes = env.targetNodes;
+}
+
+bool
+ConnectionAttackStrategy::Decide(AttackContext& ctx)
+{
+    const NodeIndexedVector<float>& strength = m_targetNodes->GetConnectionStrength();
+    if (strength.empty())
+    {
+        return false;
+    }
+
+    // The first precursor with a known connection is charged with the drop
+    float precursorStrength = 0.0;
+    for (uint32_t i = 0; i < ctx.route->GetNPrecursors(); ++i)
+    {
+        ctx.precursor = ctx.route->GetPrecursor(i);
+        ctx.precursorNode = ctx.route->GetPrecursorNode(i);
+        if (strength.Get(ctx.precursorNode))
+        {
+            precursorStrength = strength.Get(ctx.precursorNode);
+            break;
+        }
+    }
+
+    if (strength.Get(Ipv4NodeIndex::Lookup(ctx.nextHop)) && precursorStrength < m_threshold &&
+        IsTargetSize(ctx.packetSize))
+    {
+        NS_LOG_LOGIC("Precursor " << ctx.precursorNode << " has connection strength "
+                                  << precursorStrength);
+        return true;
+    }
+    return false;
+}
+
+AttackStratSelect
+ConnectionAttackStrategy::GetKind() const
+{
+    return PACKET_DROP_CONNECTION;
+}
+
+void
+ConnectionAttackStrategy::DoDispose()
+{
+    m_targetNodes = nullptr;
+    AttackStrategy::DoDispose();
+}
+
+NS_OBJECT_ENSURE_REGISTERED(NeighboursAttackStrategy);
+
+TypeId
+NeighboursAttackStrategy::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::greyattackaodv::NeighboursAttackStrategy")
+            .SetParent<AttackStrategy>()
+            .SetGroupName("greyattackaodv")
+            .AddConstructor<NeighboursAttackStrategy>()
+            .AddAttribute("Threshold",
+                          "Packets are dropped when at least this many nodes have a "
+                          "connection strength below StrengthThreshold.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&NeighboursAttackStrategy::m_threshold),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("StrengthThreshold",
+                          "Nodes with a connection strength below this value are poorly connected.",
+                          DoubleValue(1.0),
+                          MakeDoubleAccessor(&NeighboursAttackStrategy::m_strengthThreshold),
+                          MakeDoubleChecker<float>());
+    return tid;
+}
+
+NeighboursAttackStrategy::NeighboursAttackStrategy()
+    : m_threshold(0),
+      m_strengthThreshold(1.0)
+{
+}
+
+void
+NeighboursAttackStrategy::DoInstall(const AttackEnvironment& env)
+{
+    m_targetNodes = env.targetNodes;
+    m_targetNodes->TrackThreshold(m_strengthThreshold);
+}
+
+bool
+NeighboursAttackStrategy::Decide(AttackContext& ctx)
+{
+    if (!IsTargetSize(ctx.packetSize))
+    {
+        return false;
+    }
+    uint32_t badConnections = m_targetNodes->CountBelow(m_strengthThreshold);
+    NS_LOG_LOGIC(badConnections << " nodes are poorly connected");
+    return badConnections >= m_threshold;
+}
+
+AttackStratSelect
+NeighboursAttackStrategy::GetKind() const
+{
+    return PACKET_DROP_NEIGHBOURS;
+}
+
+void
+NeighboursAttackStrategy::DoDispose()
+{
+    m_targetNodes = nullptr;
+    AttackStrategy::DoDispose();
+}
+
+NS_OBJECT_ENSURE_REGISTERED(TimeWindowAttackStrategy);
+
+TypeId
+TimeWindowAttackStrategy::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::greyattackaodv::TimeWindowAttackStrategy")
+            .SetParent<AttackStrategy>()
+            .SetGroupName("greyattackaodv")
+            .AddConstructor<TimeWindowAttackStrategy>()
+            .AddAttribute("DropChance",
+                          "The probability that a window is a drop window.",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&TimeWindowAttackStrategy::m_dropChance),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("WindowLength",
+                          "The length of a drop or forward window.",
+                          TimeValue(Seconds(5)),
+                          MakeTimeAccessor(&TimeWindowAttackStrategy::m_windowLength),
+                          MakeTimeChecker())
+            .AddAttribute("Schedule",
+                          "Drop windows shared with other runs. If not set, each window is "
+                          "drawn when it starts.",
+                          PointerValue(),
+                          MakePointerAccessor(&TimeWindowAttackStrategy::m_schedule),
+                          MakePointerChecker<AttackSchedule>());
+    return tid;
+}
+
+TimeWindowAttackStrategy::TimeWindowAttackStrategy()
+    : m_dropChance(0.0),
+      m_windowTimer(Timer::CANCEL_ON_DESTROY),
+      m_dropping(false),
+      m_nextTransition(0)
+{
+}
+
+void
+TimeWindowAttackStrategy::DoInstall(const AttackEnvironment& env)
+{
+    m_rng = env.rng;
+    m_dropping = false;
+    if (m_schedule)
+    {
+        if (!m_schedule->HasWindows(env.nodeId))
+        {
+            m_schedule->GenerateWindows(env.nodeId,
+                                        m_rng,
+                                        m_dropChance,
+                                        Simulator::Now() + env.startDelay,
+                                        m_windowLength);
+        }
+        m_transitions = m_schedule->GetTransitions(env.nodeId);
+        m_nextTransition = 0;
+        m_windowTimer.SetFunction(&TimeWindowAttackStrategy::Transition, this);
+        ScheduleTransition();
+        return;
+    }
+    m_windowTimer.SetFunction(&TimeWindowAttackStrategy::WindowExpire, this);
+    m_windowTimer.Schedule(env.startDelay);
+}
+
+bool
+TimeWindowAttackStrategy::Decide(AttackContext& ctx)
+{
+    return m_dropping && IsTargetSize(ctx.packetSize);
+}
+
+AttackStratSelect
+TimeWindowAttackStrategy::GetKind() const
+{
+    return PACKET_DROP_IN_TIME;
+}
+
+void
+TimeWindowAttackStrategy::WindowExpire()
+{
+    m_windowTimer.Schedule(m_windowLength);
+    m_dropping = m_rng->GetValue() < m_dropChance;
+    NS_LOG_INFO((m_dropping ? "Dropping" : "Forwarding") << " until "
+                                                         << Simulator::Now() + m_windowLength);
+}
+
+void
+TimeWindowAttackStrategy::Transition()
+{
+    m_dropping = !m_dropping;
+    ++m_nextTransition;
+    NS_LOG_INFO((m_dropping ? "Dropping" : "Forwarding") << " as scheduled");
+    ScheduleTransition();
+}
+
+void
+TimeWindowAttackStrategy::ScheduleTransition()
+{
+    if (m_nextTransition < m_transitions.size())
+    {
+        Time delay = m_transitions[m_nextTransition] - Simulator::Now();
+        m_windowTimer.Schedule(Max(delay, Seconds(0)));
+    }
+}
+
+void
+TimeWindowAttackStrategy::DoDispose()
+{
+    m_windowTimer.Cancel();
+    m_rng = nullptr;
+    m_schedule = nullptr;
+    m_transitions.clear();
+    AttackStrategy::DoDispose();
+}
+
+NS_OBJECT_ENSURE_REGISTERED(SelectAttackStrategy);
+
+TypeId
+SelectAttackStrategy::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::greyattackaodv::SelectAttackStrategy")
+            .SetParent<AttackStrategy>()
+            .SetGroupName("greyattackaodv")
+            .AddConstructor<SelectAttackStrategy>()
+            .AddAttribute("SelectChance",
+                          "The probability that a node is selected to never have its packets "
+                          "forwarded.",
+                          DoubleValue(0.0),
+                          MakeDoubleAccessor(&SelectAttackStrategy::m_selectChance),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("Schedule",
+                          "Selections shared with other runs. If not set, the selection is "
+                          "drawn on installation.",
+                          PointerValue(),
+                          MakePointerAccessor(&SelectAttackStrategy::m_schedule),
+                          MakePointerChecker<AttackSchedule>());
+    return tid;
+}
+
+SelectAttackStrategy::SelectAttackStrategy()
+    : m_selectChance(0.0)
+{
+}
+
+void
+SelectAttackStrategy::DoInstall(const AttackEnvironment& env)
+{
+    if (m_schedule)
+    {
+        if (!m_schedule->HasSelection(env.nodeId))
+        {
+            m_schedule->GenerateSelection(env.nodeId, env.rng, m_selectChance, env.nNodes);
+        }
+        m_selected = m_schedule->GetSelection(env.nodeId);
+        return;
+    }
+    m_selected.clear();
+    for (uint32_t node = 0; node < env.nNodes; node++)
+    {
+        m_selected.push_back(env.rng->GetValue() < m_selectChance);
+    }
+}
+
+bool
+SelectAttackStrategy::Decide(AttackContext& ctx)
+{
+    return ctx.precursorNode < m_selected.size() && m_selected[ctx.precursorNode] &&
+           IsTargetSize(ctx.packetSize);
+}
+
+AttackStratSelect
+SelectAttackStrategy::GetKind() const
+{
+    return PACKET_DROP_SELECT;
+}
+
+void
+SelectAttackStrategy::DoDispose()
+{
+    m_selected.clear();
+    m_schedule = nullptr;
+    AttackStrategy::DoDispose();
+}
+
+NS_OBJECT_ENSURE_REGISTERED(AndAttackStrategy);
+
+TypeId
+AndAttackStrategy::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::greyattackaodv::AndAttackStrategy")
+                            .SetParent<AttackStrategy>()
+                            .SetGroupName("greyattackaodv")
+                            .AddConstructor<AndAttackStrategy>();
+    return tid;
+}
+
+AndAttackStrategy::AndAttackStrategy()
+{
+}
+
+void
+AndAttackStrategy::Add(Ptr<AttackStrategy> strategy)
+{
+    NS_ASSERT(strategy);
+    m_operands.push_back(strategy);
+}
+
+void
+AndAttackStrategy::DoInstall(const AttackEnvironment& env)
+{
+    for (auto& operand : m_operands)
+    {
+        operand->Install(env);
+    }
+}
+
+bool
+AndAttackStrategy::Decide(AttackContext& ctx)
+{
+    for (auto& operand : m_operands)
+    {
+        if (!operand->Decide(ctx))
+        {
+            return false;
+        }
+    }
+    return !m_operands.empty();
+}
+
+AttackStratSelect
+AndAttackStrategy::GetKind() const
+{
+    return m_operands.empty() ? NO_A_OPERATION : m_operands.front()->GetKind();
+}
+
+bool
+AndAttackStrategy::IsSilentDrop() const
+{
+    return !m_operands.empty() && m_operands.front()->IsSilentDrop();
+}
+
+void
+AndAttackStrategy::DoDispose()
+{
+    for (auto& operand : m_operands)
+    {
+        operand->Dispose();
+    }
+    m_operands.clear();
+    AttackStrategy::DoDispose();
+}
+
+} // namespace greyattackaodv
+} // namespace ns3
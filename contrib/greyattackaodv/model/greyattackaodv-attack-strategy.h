@@ -0,0 +1,349 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_ATTACK_STRATEGY_H
+#define greyattack_aodv_ATTACK_STRATEGY_H
+
+#include "greyattackaodv-attack-schedule.h"
+#include "greyattackaodv-rtable.h"
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/shared_vars.h"
+#include "ns3/timer.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+namespace greyattackaodv
+{
+
+/**
+ * \ingroup greyattackaodv
+ * \brief State shared by the attack strategies of one routing protocol instance.
+ */
+struct AttackEnvironment
+{
+    /// Uniform [0, 1) draws, owned by the routing protocol so that AssignStreams() covers them
+    Ptr<UniformRandomVariable> rng;
+    /// Connection strength to the other nodes, may be null
+    Ptr<TargetNodes> targetNodes;
+    /// Number of nodes in the scenario
+    uint32_t nNodes;
+    /// Delay before the first time-driven decision
+    Time startDelay;
+    /// Node id of the attacker
+    uint32_t nodeId;
+};
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Description of a packet about to be forwarded.
+ */
+struct AttackContext
+{
+    /// IP identification of the packet
+    uint16_t packetId;
+    /// Packet size in bytes
+    uint32_t packetSize;
+    /// Next hop of the route
+    Ipv4Address nextHop;
+    /// Route the packet is forwarded on
+    const RoutingTableEntry* route;
+    /// Precursor charged with a drop, strategies may refine it
+    Ipv4Address precursor;
+    /// Node id of precursor, or Ipv4NodeIndex::NOT_FOUND
+    uint32_t precursorNode;
+};
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Grey hole behaviour of a malicious forwarder.
+ *
+ * The routing protocol asks its strategy once per forwarded data packet
+ * whether the packet is to be dropped.  Strategies are plain ns-3 objects
+ * configured through attributes, and can be combined with
+ * AndAttackStrategy.  A strategy holds the state of one node and is
+ * installed only once.
+ */
+class AttackStrategy : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    AttackStrategy();
+    ~AttackStrategy() override;
+
+    /**
+     * Bind the strategy to a routing protocol instance.  Called once
+     * before the first Decide(); aborts if the strategy is already installed.
+     * \param env the shared attack state
+     */
+    void Install(const AttackEnvironment& env);
+    /**
+     * \param ctx the packet about to be forwarded
+     * \returns true if the packet is to be dropped
+     */
+    virtual bool Decide(AttackContext& ctx) = 0;
+    /**
+     * \returns the legacy strategy identifier reported by the AttackDecision trace
+     */
+    virtual AttackStratSelect GetKind() const = 0;
+    /**
+     * \returns true if dropped packets are reported to the IP layer as
+     * forwarded, so that no drop trace is fired for them
+     */
+    virtual bool IsSilentDrop() const;
+
+  protected:
+    /**
+     * Bind the strategy to a routing protocol instance, see Install()
+     * \param env the shared attack state
+     */
+    virtual void DoInstall(const AttackEnvironment& env);
+    /**
+     * \param size the packet size in bytes
+     * \returns true if packets of this size are attacked
+     */
+    bool IsTargetSize(uint32_t size) const
+    {
+        return size > m_minPacketSize;
+    }
+
+    /// Only packets larger than this are attacked
+    uint32_t m_minPacketSize;
+
+  private:
+    /// The strategy is bound to a routing protocol instance
+    bool m_installed;
+};
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Drop each packet with a fixed probability (PACKET_DROP_PERC).
+ */
+class PercentAttackStrategy : public AttackStrategy
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    PercentAttackStrategy();
+
+    bool Decide(AttackContext& ctx) override;
+    AttackStratSelect GetKind() const override;
+    bool IsSilentDrop() const override;
+
+  protected:
+    void DoInstall(const AttackEnvironment& env) override;
+    void DoDispose() override;
+
+  private:
+    Ptr<UniformRandomVariable> m_rng; ///< uniform [0, 1) draws
+    double m_probability;             ///< drop probability
+};
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Drop packets whose precursor is poorly connected while the
+ * next hop is reachable (PACKET_DROP_CONNECTION).
+ */
+class ConnectionAttackStrategy : public AttackStrategy
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    ConnectionAttackStrategy();
+
+    bool Decide(AttackContext& ctx) override;
+    AttackStratSelect GetKind() const override;
+
+  protected:
+    void DoInstall(const AttackEnvironment& env) override;
+    void DoDispose() override;
+
+  private:
+    Ptr<TargetNodes> m_targetNodes; ///< connection strength per node
+    double m_threshold;             ///< precursor connection strength threshold
+};
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Drop packets while enough neighbours have a poor connection
+ * (PACKET_DROP_NEIGHBOURS).
+ *
+ * The number of poorly connected nodes is read from the counts
+ * TargetNodes keeps up to date, it is not recomputed for each packet.
+ */
+class NeighboursAttackStrategy : public AttackStrategy
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    NeighboursAttackStrategy();
+
+    bool Decide(AttackContext& ctx) override;
+    AttackStratSelect GetKind() const override;
+
+  protected:
+    void DoInstall(const AttackEnvironment& env) override;
+    void DoDispose() override;
+
+  private:
+    Ptr<TargetNodes> m_targetNodes; ///< connection strength per node
+    uint32_t m_threshold;           ///< number of poorly connected neighbours
+    float m_strengthThreshold;      ///< connection strength of a poorly connected node
+};
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Split time into windows and drop all packets during the windows
+ * randomly chosen as drop windows (PACKET_DROP_IN_TIME).
+ *
+ * With a Schedule, the windows of the whole run are drawn, or read from
+ * the schedule, on installation, and a timer only runs when the strategy
+ * switches between forwarding and dropping.  The drawn windows are those
+ * drawn without a Schedule only if no other strategy draws from the same
+ * random variable during the run, as a PercentAttackStrategy combined by an
+ * AndAttackStrategy does.
+ */
+class TimeWindowAttackStrategy : public AttackStrategy
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    TimeWindowAttackStrategy();
+
+    bool Decide(AttackContext& ctx) override;
+    AttackStratSelect GetKind() const override;
+
+  protected:
+    void DoInstall(const AttackEnvironment& env) override;
+    void DoDispose() override;
+
+  private:
+    /// Start the next window
+    void WindowExpire();
+    /// Switch between forwarding and dropping, as scheduled
+    void Transition();
+    /// Arm the timer for the next scheduled transition, if any
+    void ScheduleTransition();
+
+    Ptr<UniformRandomVariable> m_rng; ///< uniform [0, 1) draws
+    double m_dropChance;              ///< probability that a window is a drop window
+    Time m_windowLength;              ///< window length
+    Timer m_windowTimer;              ///< window or transition timer
+    bool m_dropping;                  ///< the current window is a drop window
+    Ptr<AttackSchedule> m_schedule;   ///< precomputed windows, may be null
+    std::vector<Time> m_transitions;  ///< scheduled transitions
+    uint32_t m_nextTransition;        ///< index of the next scheduled transition
+};
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Drop all packets from a random selection of precursor nodes
+ * (PACKET_DROP_SELECT).
+ *
+ * With a Schedule, the selection is read from the schedule, and drawn
+ * into it if the schedule has none for this node.
+ */
+class SelectAttackStrategy : public AttackStrategy
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    SelectAttackStrategy();
+
+    bool Decide(AttackContext& ctx) override;
+    AttackStratSelect GetKind() const override;
+
+  protected:
+    void DoInstall(const AttackEnvironment& env) override;
+    void DoDispose() override;
+
+  private:
+    double m_selectChance;          ///< probability that a node is selected
+    std::vector<bool> m_selected;   ///< selected nodes, by node index
+    Ptr<AttackSchedule> m_schedule; ///< precomputed selections, may be null
+};
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Drop a packet only if all the operand strategies drop it.
+ *
+ * Operands are evaluated in order and evaluation stops at the first operand
+ * that forwards the packet.  The kind and the silent drop flag are those of
+ * the first operand.
+ */
+class AndAttackStrategy : public AttackStrategy
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    AndAttackStrategy();
+
+    /**
+     * Append an operand
+     * \param strategy the operand
+     */
+    void Add(Ptr<AttackStrategy> strategy);
+
+    bool Decide(AttackContext& ctx) override;
+    AttackStratSelect GetKind() const override;
+    bool IsSilentDrop() const override;
+
+  protected:
+    void DoInstall(const AttackEnvironment& env) override;
+    void DoDispose() override;
+
+  private:
+    std::vector<Ptr<AttackStrategy>> m_operands; ///< operands
+};
+
+} // namespace greyattackaodv
+} // namespace ns3
+
+#endif /* greyattack_aodv_ATTACK_STRATEGY_H */
@@ -0,0 +1,102 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_BINARY_IO_H
+#define greyattack_aodv_BINARY_IO_H
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdint.h>
+
+/*
+ * Little endian serialization shared by the binary files of the module.
+ * Internal header, not installed.
+ */
+
+namespace ns3
+{
+namespace greyattackaodv
+{
+
+/**
+ * Write an integer in little endian order
+ * \param os the stream
+ * \param value the integer
+ * \param size the number of bytes
+ */
+inline void
+WriteLe(std::ostream& os, uint64_t value, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        os.put(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+/**
+ * Read an integer written by WriteLe()
+ * \param is the stream
+ * \param size the number of bytes
+ * \returns the integer
+ */
+inline uint64_t
+ReadLe(std::istream& is, uint32_t size)
+{
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        value |= uint64_t(static_cast<uint8_t>(is.get())) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * \returns true if the host stores integers in little endian order
+ */
+inline bool
+IsLittleEndianHost()
+{
+    uint16_t probe = 1;
+    uint8_t first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+/**
+ * Write an array of 32 bit integers in little endian order, in a single
+ * write on little endian hosts
+ * \param os the stream
+ * \param values the integers
+ * \param count the number of integers
+ */
+inline void
+WriteLeArray(std::ostream& os, const uint32_t* values, uint64_t count)
+{
+    if (IsLittleEndianHost())
+    {
+        os.write(reinterpret_cast<const char*>(values), count * sizeof(uint32_t));
+        return;
+    }
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        WriteLe(os, values[i], 4);
+    }
+}
+
+} // namespace greyattackaodv
+} // namespace ns3
+
+#endif /* greyattack_aodv_BINARY_IO_H */
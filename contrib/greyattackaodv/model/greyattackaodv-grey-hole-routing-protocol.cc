@@ -0,0 +1,415 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "greyattackaodv-grey-hole-routing-protocol.h"
+
+#include "greyattackaodv-attack-log.h"
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/integer.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("greyattackaodvGreyHoleRoutingProtocol");
+
+namespace greyattackaodv
+{
+
+NS_OBJECT_ENSURE_REGISTERED(GreyHoleRoutingProtocol);
+
+TypeId
+GreyHoleRoutingProtocol::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::greyattackaodv::GreyHoleRoutingProtocol")
+            .SetParent<RoutingProtocol>()
+            .SetGroupName("greyattackaodv")
+            .AddConstructor<GreyHoleRoutingProtocol>()
+            .AddAttribute("AttackRv",
+                          "Access to the UniformRandomVariable in [0, 1) driving attack decisions",
+                          StringValue("ns3::UniformRandomVariable"),
+                          MakePointerAccessor(&GreyHoleRoutingProtocol::m_attackRandomVariable),
+                          MakePointerChecker<UniformRandomVariable>())
+            .AddAttribute("AttackStrategy",
+                          "The grey hole behaviour of this node, an object of its own. If not "
+                          "set, a strategy is created by AttackStrategyFactory, or built from "
+                          "mStrat and the legacy strategy parameters.",
+                          PointerValue(),
+                          MakePointerAccessor(&GreyHoleRoutingProtocol::m_attackStrategy),
+                          MakePointerChecker<AttackStrategy>())
+            .AddAttribute("AttackStrategyFactory",
+                          "Creates the grey hole behaviour of each node, when AttackStrategy "
+                          "is not set. Unlike AttackStrategy, it can be set on a helper "
+                          "installing several nodes.",
+                          ObjectFactoryValue(),
+                          MakeObjectFactoryAccessor(
+                              &GreyHoleRoutingProtocol::m_attackStrategyFactory),
+                          MakeObjectFactoryChecker())
+            .AddAttribute("ShadowLog",
+                          "Record the decisions the strategies of this log would have taken "
+                          "about each forwarded packet, without applying them.",
+                          PointerValue(),
+                          MakePointerAccessor(&GreyHoleRoutingProtocol::m_shadowLog),
+                          MakePointerChecker<ShadowDecisionLog>())
+            .AddAttribute("Schedule",
+                          "Drop windows and selections shared by the time window and select "
+                          "strategies built from mStrat.",
+                          PointerValue(),
+                          MakePointerAccessor(&GreyHoleRoutingProtocol::m_schedule),
+                          MakePointerChecker<AttackSchedule>())
+            .AddAttribute ("mStrat", "The Malicious Node Strategy.",
+                          UintegerValue (0),
+                          MakeUintegerAccessor (&GreyHoleRoutingProtocol::m_strat),
+                          MakeUintegerChecker<uint32_t> ())
+            .AddAttribute ("targetNodes", "A List of nodes that we wish to target, and their signal strength",
+                          PointerValue(),
+                          MakePointerAccessor(&GreyHoleRoutingProtocol::targetNodes),
+                          MakePointerChecker<TargetNodes>())
+            .AddAttribute("MonitorLinkQuality",
+                          "Set the connection strengths of targetNodes to the signal strength, "
+                          "in dBm, of the frames received from each node.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&GreyHoleRoutingProtocol::m_monitorLinkQuality),
+                          MakeBooleanChecker())
+            .AddAttribute ("NeighbourThresh", "The Number of Neighbour threshold nodes.",
+                          UintegerValue (0),
+                          MakeUintegerAccessor (&GreyHoleRoutingProtocol::m_vTNeighbour),
+                          MakeUintegerChecker<uint32_t> ())
+            .AddAttribute("PercentDrop",
+                          "The Number of Packets to drop",
+                          DoubleValue(0.0), MakeDoubleAccessor(&GreyHoleRoutingProtocol::m_vPercentDrop),
+                          MakeDoubleChecker<double> ())
+            .AddAttribute ("ConnectionStrengthThreshold",
+                          "If the connection strength to a node is greater than this value, then the packet will be dropped",
+                          DoubleValue(0.0), MakeDoubleAccessor(&GreyHoleRoutingProtocol::m_vTConnection),
+                          MakeDoubleChecker<double> ())
+            .AddAttribute("DropWindowChance",
+                          "The chance that a specific window is a drop or forward window",
+                          DoubleValue(0.0), MakeDoubleAccessor(&GreyHoleRoutingProtocol::m_DropWindowChance),
+                          MakeDoubleChecker<double> ())
+            .AddAttribute("DropSelectChance",
+                          "The chance that a specific node is selected for the grey hole to never foward their packets",
+                          DoubleValue(0.0), MakeDoubleAccessor(&GreyHoleRoutingProtocol::m_DropSelectChance),
+                          MakeDoubleChecker<double> ())
+            .AddAttribute ("num_defending_nodes", "The Number of Defending Nodes (used to calculate FP / FN at the end).",
+                          UintegerValue (0),
+                          MakeUintegerAccessor (&GreyHoleRoutingProtocol::num_defending_nodes),
+                          MakeUintegerChecker<uint32_t> ())
+            .AddAttribute ("num_malicious_nodes", "The Number of Defending Nodes (used to calculate FP / FN at the end).",
+                          UintegerValue (0),
+                          MakeUintegerAccessor (&GreyHoleRoutingProtocol::num_malicious_nodes),
+                          MakeUintegerChecker<uint32_t> ())
+            .AddAttribute ("DropStats", "The Number of Packets dropped by this node.",
+                           PointerValue(),
+                           MakePointerAccessor(&GreyHoleRoutingProtocol::dropped_stats),
+                           MakePointerChecker<DroppedStats>())
+            .AddTraceSource("AttackDecision",
+                            "An attack strategy decided whether to forward or drop a packet.",
+                            MakeTraceSourceAccessor(&GreyHoleRoutingProtocol::m_attackDecisionTrace),
+                            "ns3::greyattackaodv::GreyHoleRoutingProtocol::AttackDecisionTracedCallback")
+        ;
+    return tid;
+}
+
+GreyHoleRoutingProtocol::GreyHoleRoutingProtocol()
+    : m_strat(0),
+      m_vPercentDrop(0.0),
+      m_vTConnection(0.0),
+      m_vTNeighbour(0),
+      m_DropWindowChance(0.0),
+      m_DropSelectChance(0.0),
+      num_defending_nodes(0),
+      num_malicious_nodes(0),
+      m_monitorLinkQuality(false),
+      m_nodeId(0)
+{
+}
+
+GreyHoleRoutingProtocol::~GreyHoleRoutingProtocol()
+{
+}
+
+void
+GreyHoleRoutingProtocol::DoDispose()
+{
+    if (m_attackStrategy)
+    {
+        m_attackStrategy->Dispose();
+        m_attackStrategy = nullptr;
+    }
+    for (auto& shadow : m_shadowStrategies)
+    {
+        shadow->Dispose();
+    }
+    m_shadowStrategies.clear();
+    m_shadowRandomVariables.clear();
+    m_shadowLog = nullptr;
+    m_schedule = nullptr;
+    m_observatory = nullptr;
+    if (m_linkQualityMonitor)
+    {
+        m_linkQualityMonitor->Dispose();
+        m_linkQualityMonitor = nullptr;
+    }
+    RoutingProtocol::DoDispose();
+}
+
+int64_t
+GreyHoleRoutingProtocol::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    int64_t streams = RoutingProtocol::AssignStreams(stream);
+    m_attackRandomVariable->SetStream(stream + 1);
+    return streams;
+}
+
+Ptr<LinkQualityMonitor>
+GreyHoleRoutingProtocol::GetLinkQualityMonitor() const
+{
+    return m_linkQualityMonitor;
+}
+
+void
+GreyHoleRoutingProtocol::DoInitialize()
+{
+    NS_LOG_FUNCTION(this);
+    RoutingProtocol::DoInitialize();
+    m_nodeId = GetIpv4()->GetObject<Node>()->GetId();
+
+    // keep a record of the number of dropped packets from every node
+    if (dropped_stats)
+    {
+        dropped_stats->drop_count.Resize();
+    }
+
+    if (m_monitorLinkQuality)
+    {
+        if (!targetNodes)
+        {
+            targetNodes = CreateObject<TargetNodes>();
+        }
+        m_linkQualityMonitor = CreateObject<LinkQualityMonitor>();
+        m_linkQualityMonitor->SetTargetNodes(targetNodes);
+        m_linkQualityMonitor->Install(GetIpv4()->GetObject<Node>());
+    }
+
+    uint32_t nNodes = std::max(num_defending_nodes + num_malicious_nodes + 2, NodeList::GetNNodes());
+
+    // Resolve the attack strategy once, so that forwarding pays a single call per packet
+    if (!m_attackStrategy && m_attackStrategyFactory.IsTypeIdSet())
+    {
+        m_attackStrategy = m_attackStrategyFactory.Create<AttackStrategy>();
+    }
+    if (!m_attackStrategy)
+    {
+        m_attackStrategy = CreateLegacyAttackStrategy();
+    }
+    if (m_attackStrategy)
+    {
+        if (!targetNodes)
+        {
+            targetNodes = CreateObject<TargetNodes>();
+        }
+        if (!dropped_stats)
+        {
+            dropped_stats = CreateObject<DroppedStats>();
+        }
+        m_observatory = AttackObservatory::Find();
+
+        NS_LOG_INFO("Attack strategy " << m_attackStrategy->GetInstanceTypeId().GetName()
+                                       << " selected");
+        AttackEnvironment env;
+        env.rng = m_attackRandomVariable;
+        env.targetNodes = targetNodes;
+        env.nNodes = nNodes;
+        env.startDelay = GetStartDelay();
+        env.nodeId = m_nodeId;
+        m_attackStrategy->Install(env);
+    }
+
+    if (m_shadowLog)
+    {
+        if (!targetNodes)
+        {
+            targetNodes = CreateObject<TargetNodes>();
+        }
+        CreateShadowRandomVariables();
+        m_shadowStrategies = m_shadowLog->CreateStrategies();
+        m_shadowDecisions.assign(m_shadowLog->GetNWords(), 0);
+        AttackEnvironment env;
+        env.targetNodes = targetNodes;
+        env.nNodes = nNodes;
+        env.startDelay = GetStartDelay();
+        env.nodeId = m_nodeId;
+        for (uint32_t k = 0; k < m_shadowStrategies.size(); ++k)
+        {
+            env.rng = m_shadowRandomVariables[k];
+            m_shadowStrategies[k]->Install(env);
+        }
+    }
+}
+
+void
+GreyHoleRoutingProtocol::CreateShadowRandomVariables()
+{
+    if (!m_shadowLog)
+    {
+        return;
+    }
+    NS_ABORT_MSG_IF(m_shadowLog->GetNStrategies() > SHADOW_STREAMS_PER_NODE,
+                    "More than " << SHADOW_STREAMS_PER_NODE << " shadow strategies");
+    // Setting the stream on construction leaves the automatic stream numbering alone
+    int64_t first = SHADOW_STREAM_BASE +
+                    GetIpv4()->GetObject<Node>()->GetId() * SHADOW_STREAMS_PER_NODE;
+    while (m_shadowRandomVariables.size() < m_shadowLog->GetNStrategies())
+    {
+        int64_t stream = first + int64_t(m_shadowRandomVariables.size());
+        m_shadowRandomVariables.push_back(
+            CreateObjectWithAttributes<UniformRandomVariable>("Stream", IntegerValue(stream)));
+    }
+}
+
+bool
+GreyHoleRoutingProtocol::DropForwardedPacket(Ptr<const Packet> p,
+                                             const Ipv4Header& header,
+                                             const RoutingTableEntry& toDst,
+                                             bool& silent)
+{
+    if (!m_attackStrategy && m_shadowStrategies.empty())
+    {
+        return false;
+    }
+    // the last precursor is charged with a drop unless the strategy refines it
+    AttackContext ctx;
+    ctx.packetId = header.GetIdentification();
+    ctx.packetSize = p->GetSize();
+    ctx.nextHop = toDst.GetNextHop();
+    ctx.route = &toDst;
+    ctx.precursorNode = Ipv4NodeIndex::NOT_FOUND;
+    uint32_t nPrecursors = toDst.GetNPrecursors();
+    if (nPrecursors)
+    {
+        ctx.precursor = toDst.GetPrecursor(nPrecursors - 1);
+        ctx.precursorNode = toDst.GetPrecursorNode(nPrecursors - 1);
+    }
+
+    // Shadow strategies see the packet as the actual strategy does
+    uint32_t precursorNode = ctx.precursorNode;
+    if (m_shadowLog)
+    {
+        std::fill(m_shadowDecisions.begin(), m_shadowDecisions.end(), 0);
+        for (uint32_t k = 0; k < m_shadowStrategies.size(); ++k)
+        {
+            AttackContext shadowCtx = ctx;
+            if (m_shadowStrategies[k]->Decide(shadowCtx))
+            {
+                m_shadowDecisions[k / 64] |= uint64_t(1) << (k % 64);
+            }
+        }
+    }
+    if (!m_attackStrategy)
+    {
+        RecordShadowDecisions(ctx.packetId, precursorNode, false);
+        return false;
+    }
+
+    bool drop = m_attackStrategy->Decide(ctx);
+    m_attackDecisionTrace(ctx.packetId,
+                          ctx.precursor,
+                          ctx.nextHop,
+                          m_attackStrategy->GetKind(),
+                          drop);
+    if (drop)
+    {
+        GREYATTACKAODV_LOG_ATTACK("[Attack - " << m_attackStrategy->GetInstanceTypeId().GetName()
+                                               << "]: Dropped packet " << ctx.packetId
+                                               << " where the next hop was " << ctx.nextHop
+                                               << " and the precursor was:" << ctx.precursorNode);
+        if (ctx.precursorNode != Ipv4NodeIndex::NOT_FOUND)
+        {
+            dropped_stats->drop_count.At(ctx.precursorNode) += 1;
+        }
+        if (m_observatory)
+        {
+            m_observatory->RecordDrop(m_nodeId, ctx.precursorNode);
+        }
+        silent = m_attackStrategy->IsSilentDrop();
+    }
+    if (m_shadowLog)
+    {
+        RecordShadowDecisions(ctx.packetId, precursorNode, drop);
+    }
+    return drop;
+}
+
+void
+GreyHoleRoutingProtocol::RecordShadowDecisions(uint16_t packetId, uint32_t precursorNode, bool drop)
+{
+    ShadowDecisionLog::Record record;
+    record.time = Simulator::Now();
+    record.attacker = m_nodeId;
+    record.precursorNode = precursorNode;
+    record.packetId = packetId;
+    record.drop = drop;
+    m_shadowLog->Add(record, m_shadowDecisions.data());
+}
+
+Ptr<AttackStrategy>
+GreyHoleRoutingProtocol::CreateLegacyAttackStrategy() const
+{
+    switch (static_cast<AttackStratSelect>(m_strat))
+    {
+    case PACKET_DROP_PERC:
+        return CreateObjectWithAttributes<PercentAttackStrategy>("DropProbability",
+                                                                 DoubleValue(m_vPercentDrop));
+    case PACKET_DROP_CONNECTION:
+        return CreateObjectWithAttributes<ConnectionAttackStrategy>("Threshold",
+                                                                    DoubleValue(m_vTConnection));
+    case PACKET_DROP_NEIGHBOURS:
+        // the neighbour strategy has always attacked packets of any size
+        return CreateObjectWithAttributes<NeighboursAttackStrategy>("Threshold",
+                                                                    UintegerValue(m_vTNeighbour),
+                                                                    "MinPacketSize",
+                                                                    UintegerValue(0));
+    case PACKET_DROP_IN_TIME:
+        return CreateObjectWithAttributes<TimeWindowAttackStrategy>("DropChance",
+                                                                    DoubleValue(m_DropWindowChance),
+                                                                    "Schedule",
+                                                                    PointerValue(m_schedule));
+    case PACKET_DROP_SELECT:
+        return CreateObjectWithAttributes<SelectAttackStrategy>("SelectChance",
+                                                                DoubleValue(m_DropSelectChance),
+                                                                "Schedule",
+                                                                PointerValue(m_schedule));
+    case NO_A_OPERATION:
+        break;
+    }
+    return nullptr;
+}
+
+} // namespace greyattackaodv
+} // namespace ns3
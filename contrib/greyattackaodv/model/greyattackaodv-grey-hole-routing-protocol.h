@@ -0,0 +1,172 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_GREY_HOLE_ROUTING_PROTOCOL_H
+#define greyattack_aodv_GREY_HOLE_ROUTING_PROTOCOL_H
+
+#include "greyattackaodv-attack-observatory.h"
+#include "greyattackaodv-attack-strategy.h"
+#include "greyattackaodv-link-quality-monitor.h"
+#include "greyattackaodv-shadow-decision-log.h"
+#include "greyattackaodv-routing-protocol.h"
+
+#include "ns3/object-factory.h"
+#include "ns3/shared_vars.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3
+{
+namespace greyattackaodv
+{
+
+/**
+ * \ingroup greyattackaodv
+ *
+ * \brief greyattackaodv routing protocol of a grey hole node
+ *
+ * The attack strategy is resolved once when the protocol is initialized
+ * and asked about every data packet the node forwards.  Honest nodes use
+ * RoutingProtocol, which carries none of this state;
+ * greyattackaodvHelper selects this variant as soon as one of its
+ * attributes is set.
+ */
+class GreyHoleRoutingProtocol : public RoutingProtocol
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    /// constructor
+    GreyHoleRoutingProtocol();
+    ~GreyHoleRoutingProtocol() override;
+    void DoDispose() override;
+
+    /// First stream of the shadow random variables, far above the streams of AssignStreams()
+    static const int64_t SHADOW_STREAM_BASE = int64_t(1) << 40;
+    /// Number of streams reserved for the shadow random variables of each node
+    static const int64_t SHADOW_STREAMS_PER_NODE = 1 << 16;
+
+    /**
+     * Assign the streams of the routing protocol and of the attack
+     * strategy.  The random variables of the shadow strategies do not take
+     * streams from this range, so that recording shadow decisions does not
+     * renumber the streams of the nodes assigned next: the variable of
+     * shadow strategy k on node n always uses stream SHADOW_STREAM_BASE +
+     * n * SHADOW_STREAMS_PER_NODE + k.
+     *
+     * \param stream first stream index to use
+     * \return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream) override;
+
+    /**
+     * \returns the monitor feeding the connection strengths, null unless
+     * MonitorLinkQuality is set and the protocol is initialized
+     */
+    Ptr<LinkQualityMonitor> GetLinkQualityMonitor() const;
+
+    /**
+     * TracedCallback signature for attack decisions.
+     *
+     * \param [in] packetId the IP identification of the packet
+     * \param [in] precursor the precursor of the route the packet is forwarded on
+     * \param [in] nextHop the next hop of the packet
+     * \param [in] strategy the active attack strategy
+     * \param [in] drop true if the packet is dropped
+     */
+    typedef void (*AttackDecisionTracedCallback)(uint16_t packetId,
+                                                 Ipv4Address precursor,
+                                                 Ipv4Address nextHop,
+                                                 AttackStratSelect strategy,
+                                                 bool drop);
+
+  protected:
+    void DoInitialize() override;
+    bool DropForwardedPacket(Ptr<const Packet> p,
+                             const Ipv4Header& header,
+                             const RoutingTableEntry& toDst,
+                             bool& silent) override;
+
+  private:
+    /**
+     * Build the attack strategy selected by the mStrat attribute
+     * \returns the strategy, or nullptr for NO_A_OPERATION
+     */
+    Ptr<AttackStrategy> CreateLegacyAttackStrategy() const;
+    /// Give each shadow strategy of m_shadowLog its own random variable, on its own stream
+    void CreateShadowRandomVariables();
+    /**
+     * Append the decisions of the shadow strategies to m_shadowLog
+     * \param packetId the IP identification of the packet
+     * \param precursorNode the node id of the precursor
+     * \param drop the decision of the actual strategy
+     */
+    void RecordShadowDecisions(uint16_t packetId, uint32_t precursorNode, bool drop);
+
+    /// Provides the uniform random draws of the attack strategies
+    Ptr<UniformRandomVariable> m_attackRandomVariable;
+
+    //strategy
+    uint32_t m_strat;
+    /// Attack strategy, null while the node behaves honestly
+    Ptr<AttackStrategy> m_attackStrategy;
+    /// Creates m_attackStrategy, if set
+    ObjectFactory m_attackStrategyFactory;
+    /// Log of the shadow decisions, may be null
+    Ptr<ShadowDecisionLog> m_shadowLog;
+    /// Schedule of the strategy built from m_strat, may be null
+    Ptr<AttackSchedule> m_schedule;
+    /// Shadow strategies of this node, one per strategy of m_shadowLog
+    std::vector<Ptr<AttackStrategy>> m_shadowStrategies;
+    /// Random variables of the shadow strategies
+    std::vector<Ptr<UniformRandomVariable>> m_shadowRandomVariables;
+    /// Shadow decisions about the packet being forwarded
+    std::vector<uint64_t> m_shadowDecisions;
+
+    // My variables for the strategies
+    Ptr<TargetNodes> targetNodes;
+    double m_vPercentDrop;
+    double m_vTConnection;
+    uint32_t m_vTNeighbour;
+    double m_DropWindowChance;
+    double m_DropSelectChance;
+    uint32_t num_defending_nodes;
+    uint32_t num_malicious_nodes;
+
+    /// Measure the connection strengths from the received frames
+    bool m_monitorLinkQuality;
+    /// Monitor feeding targetNodes, if m_monitorLinkQuality
+    Ptr<LinkQualityMonitor> m_linkQualityMonitor;
+
+    /// Node id of this node, known once the protocol is initialized
+    uint32_t m_nodeId;
+
+    // my variables for collecting statistics
+    Ptr<DroppedStats> dropped_stats;
+    /// Network-wide drop counts, if observed
+    Ptr<AttackObservatory> m_observatory;
+
+    /// Trace of the attack decision taken for each forwarded packet
+    TracedCallback<uint16_t, Ipv4Address, Ipv4Address, AttackStratSelect, bool>
+        m_attackDecisionTrace;
+};
+
+} // namespace greyattackaodv
+} // namespace ns3
+
+#endif /* greyattack_aodv_GREY_HOLE_ROUTING_PROTOCOL_H */
@@ -32,26 +32,93 @@ namespace ns3
 {
 namespace greyattackaodv
 {
+/// Number of buckets covering the lifetime of the entries
+static const int64_t ID_CACHE_BUCKETS = 16;
+
+IdCache::IdCache(Time lifetime)
+    : m_lifetime(lifetime)
+{
+    SetSlice(lifetime);
+}
+
+void
+IdCache::SetSlice(Time lifetime)
+{
+    m_slice = std::max<int64_t>(lifetime.GetTimeStep() / ID_CACHE_BUCKETS, 1);
+}
+
+void
+IdCache::SetLifetime(Time lifetime)
+{
+    m_lifetime = lifetime;
+    // Bucket indices depend on the slice, keep it while entries are stored
+    if (m_idCache.empty())
+    {
+        m_buckets.clear();
+        SetSlice(lifetime);
+    }
+}
+
 bool
 IdCache::IsDuplicate(Ipv4Address addr, uint32_t id)
 {
     Purge();
-    for (auto i = m_idCache.begin(); i != m_idCache.end(); ++i)
+    uint64_t key = MakeKey(addr, id);
+    if (!m_idCache.insert(key).second)
     {
-        if (i->m_context == addr && i->m_id == id)
-        {
-            return true;
-        }
+        return true;
+    }
+    UniqueId uniqueId = {key, m_lifetime + Simulator::Now()};
+    Bucket& bucket = m_buckets[BucketIndex(uniqueId.m_expire)];
+    if (!bucket.m_entries.empty() && uniqueId.m_expire < bucket.m_entries.back().m_expire)
+    {
+        bucket.m_ordered = false;
     }
-    UniqueId uniqueId = {addr, id, m_lifetime + Simulator::Now()};
-    m_idCache.push_back(uniqueId);
+    bucket.m_entries.push_back(uniqueId);
     return false;
 }
 
 void
 IdCache::Purge()
 {
-    m_idCache.erase(remove_if(m_idCache.begin(), m_idCache.end(), IsExpired()), m_idCache.end());
+    Time now = Simulator::Now();
+    while (!m_buckets.empty())
+    {
+        auto first = m_buckets.begin();
+        Bucket& bucket = first->second;
+        if ((first->first + 1) * m_slice <= now.GetTimeStep())
+        {
+            // The whole slice is in the past
+            for (uint32_t i = bucket.m_head; i < bucket.m_entries.size(); ++i)
+            {
+                m_idCache.erase(bucket.m_entries[i].m_key);
+            }
+            m_buckets.erase(first);
+            continue;
+        }
+        if (first->first * m_slice >= now.GetTimeStep())
+        {
+            // Nothing expired yet
+            break;
+        }
+        if (!bucket.m_ordered)
+        {
+            std::stable_sort(bucket.m_entries.begin() + bucket.m_head,
+                             bucket.m_entries.end(),
+                             [](const UniqueId& a, const UniqueId& b) {
+                                 return a.m_expire < b.m_expire;
+                             });
+            bucket.m_ordered = true;
+        }
+        while (bucket.m_head < bucket.m_entries.size() &&
+               bucket.m_entries[bucket.m_head].m_expire < now)
+        {
+            m_idCache.erase(bucket.m_entries[bucket.m_head].m_key);
+            ++bucket.m_head;
+        }
+        // Later buckets only hold entries expiring after now
+        break;
+    }
 }
 
 uint32_t
@@ -31,6 +31,9 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/simulator.h"
 
+#include <map>
+#include <stdint.h>
+#include <unordered_set>
 #include <vector>
 
 namespace ns3
@@ -41,6 +44,12 @@ namespace greyattackaodv
  * \ingroup greyattackaodv
  *
  * \brief Unique packets identification cache used for simple duplicate detection.
+ *
+ * Known (address, id) pairs are kept in a hash set.  For expiry, entries are
+ * grouped into buckets, each covering a slice of expiry times of one
+ * sixteenth of the lifetime the cache was created with.  A bucket whose
+ * slice lies entirely in the past is dropped as a whole, so only the bucket
+ * covering the current time is examined entry by entry.
  */
 class IdCache
 {
@@ -49,10 +58,7 @@ class IdCache
      * constructor
      * \param lifetime the lifetime for added entries
      */
-    IdCache(Time lifetime)
-        : m_lifetime(lifetime)
-    {
-    }
+    IdCache(Time lifetime);
 
     /**
      * Check that entry (addr, id) exists in cache. Add entry, if it doesn't exist.
@@ -72,10 +78,7 @@ class IdCache
      * Set lifetime for future added entries.
      * \param lifetime the lifetime for entries
      */
-    void SetLifetime(Time lifetime)
-    {
-        m_lifetime = lifetime;
-    }
+    void SetLifetime(Time lifetime);
 
     /**
      * Return lifetime for existing entries in cache
@@ -90,33 +93,54 @@ class IdCache
     /// Unique packet ID
     struct UniqueId
     {
-        /// ID is supposed to be unique in single address context (e.g. sender address)
-        Ipv4Address m_context;
-        /// The id
-        uint32_t m_id;
+        /// Address and id, packed by MakeKey()
+        uint64_t m_key;
         /// When record will expire
         Time m_expire;
     };
 
+    /// Entries whose expiry time falls in one slice
+    struct Bucket
+    {
+        /// The entries, in insertion order; those before m_head are already removed
+        std::vector<UniqueId> m_entries;
+        /// First entry not yet removed
+        uint32_t m_head{0};
+        /// The entries expire in insertion order
+        bool m_ordered{true};
+    };
+
     /**
-     * \brief IsExpired structure
+     * \param addr the IP address
+     * \param id the ID
+     * \returns the hash set key of (addr, id)
      */
-    struct IsExpired
+    static uint64_t MakeKey(Ipv4Address addr, uint32_t id)
     {
-        /**
-         * \brief Check if the entry is expired
-         *
-         * \param u UniqueId entry
-         * \return true if expired, false otherwise
-         */
-        bool operator()(const UniqueId& u) const
-        {
-            return (u.m_expire < Simulator::Now());
-        }
-    };
+        return (static_cast<uint64_t>(addr.Get()) << 32) | id;
+    }
+
+    /**
+     * \param expire an expiry time
+     * \returns the index of the bucket covering expire
+     */
+    int64_t BucketIndex(Time expire) const
+    {
+        return expire.GetTimeStep() / m_slice;
+    }
+
+    /**
+     * Choose the bucket slice for a lifetime
+     * \param lifetime the lifetime
+     */
+    void SetSlice(Time lifetime);
 
     /// Already seen IDs
-    std::vector<UniqueId> m_idCache;
+    std::unordered_set<uint64_t> m_idCache;
+    /// Entries by bucket index
+    std::map<int64_t, Bucket> m_buckets;
+    /// Bucket slice length, in time steps
+    int64_t m_slice;
     /// Default lifetime for ID records
     Time m_lifetime;
 };
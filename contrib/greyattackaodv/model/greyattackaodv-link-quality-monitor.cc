@@ -0,0 +1,176 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "greyattackaodv-link-quality-monitor.h"
+
+#include "greyattackaodv-node-index.h"
+
+#include "ns3/ampdu-subframe-header.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-net-device.h"
+
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("greyattackaodvLinkQualityMonitor");
+
+namespace greyattackaodv
+{
+
+NS_OBJECT_ENSURE_REGISTERED(LinkQualityMonitor);
+
+TypeId
+LinkQualityMonitor::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::greyattackaodv::LinkQualityMonitor")
+            .SetParent<Object>()
+            .SetGroupName("greyattackaodv")
+            .AddConstructor<LinkQualityMonitor>()
+            .AddAttribute("Alpha",
+                          "Weight of a new sample in the moving averages.",
+                          DoubleValue(0.125),
+                          MakeDoubleAccessor(&LinkQualityMonitor::m_alpha),
+                          MakeDoubleChecker<double>(0, 1))
+            .AddAttribute("MinChange",
+                          "Change of the average signal strength, in dB, that is pushed "
+                          "into TargetNodes.",
+                          DoubleValue(0.5),
+                          MakeDoubleAccessor(&LinkQualityMonitor::m_minChange),
+                          MakeDoubleChecker<double>(0));
+    return tid;
+}
+
+LinkQualityMonitor::LinkQualityMonitor()
+    : m_alpha(0.125),
+      m_minChange(0.5)
+{
+}
+
+LinkQualityMonitor::~LinkQualityMonitor()
+{
+}
+
+void
+LinkQualityMonitor::DoDispose()
+{
+    m_targetNodes = nullptr;
+    m_links.clear();
+    Object::DoDispose();
+}
+
+void
+LinkQualityMonitor::Install(Ptr<Node> node)
+{
+    NS_LOG_FUNCTION(this << node->GetId());
+    for (uint32_t i = 0; i < node->GetNDevices(); ++i)
+    {
+        Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(node->GetDevice(i));
+        if (device)
+        {
+            device->GetPhy()->TraceConnectWithoutContext(
+                "MonitorSnifferRx",
+                MakeCallback(&LinkQualityMonitor::SnifferRx, this));
+        }
+    }
+}
+
+void
+LinkQualityMonitor::SetTargetNodes(Ptr<TargetNodes> targetNodes)
+{
+    m_targetNodes = targetNodes;
+}
+
+double
+LinkQualityMonitor::GetRssi(uint32_t nodeId) const
+{
+    return m_links.Get(nodeId).rssi;
+}
+
+double
+LinkQualityMonitor::GetRssiDerivative(uint32_t nodeId) const
+{
+    return m_links.Get(nodeId).derivative;
+}
+
+void
+LinkQualityMonitor::SnifferRx(Ptr<const Packet> packet,
+                              uint16_t channelFreqMhz,
+                              WifiTxVector txVector,
+                              MpduInfo aMpdu,
+                              SignalNoiseDbm signalNoise,
+                              uint16_t staId)
+{
+    WifiMacHeader header;
+    if (aMpdu.type == NORMAL_MPDU)
+    {
+        packet->PeekHeader(header);
+    }
+    else
+    {
+        Ptr<Packet> mpdu = packet->Copy();
+        AmpduSubframeHeader subframe;
+        mpdu->RemoveHeader(subframe);
+        mpdu->PeekHeader(header);
+    }
+    // Control frames such as ACK and CTS do not carry their transmitter
+    if (header.IsCtl())
+    {
+        return;
+    }
+    uint32_t nodeId = Mac48NodeIndex::Lookup(header.GetAddr2());
+    if (nodeId == Mac48NodeIndex::NOT_FOUND)
+    {
+        return;
+    }
+
+    LinkQuality& link = m_links.At(nodeId);
+    Time now = Simulator::Now();
+    if (!link.known)
+    {
+        link.rssi = signalNoise.signal;
+        link.known = true;
+    }
+    else
+    {
+        double rssi = (1 - m_alpha) * link.rssi + m_alpha * signalNoise.signal;
+        Time elapsed = now - link.lastSample;
+        if (elapsed.IsStrictlyPositive())
+        {
+            double slope = (rssi - link.rssi) / elapsed.GetSeconds();
+            link.derivative = (1 - m_alpha) * link.derivative + m_alpha * slope;
+        }
+        link.rssi = rssi;
+    }
+    link.lastSample = now;
+
+    if (m_targetNodes && (!link.isPushed || std::abs(link.rssi - link.pushed) >= m_minChange))
+    {
+        NS_LOG_LOGIC("Node " << nodeId << " received at " << link.rssi << " dBm, "
+                             << link.derivative << " dB/s");
+        link.pushed = link.rssi;
+        link.isPushed = true;
+        m_targetNodes->SetConnectionStrength(nodeId, link.rssi);
+        m_targetNodes->d_connection_strength.At(nodeId) = link.derivative;
+    }
+}
+
+} // namespace greyattackaodv
+} // namespace ns3
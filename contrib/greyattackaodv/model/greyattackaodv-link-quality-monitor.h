@@ -0,0 +1,116 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_LINK_QUALITY_MONITOR_H
+#define greyattack_aodv_LINK_QUALITY_MONITOR_H
+
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/shared_vars.h"
+#include "ns3/wifi-phy.h"
+
+#include <stdint.h>
+
+namespace ns3
+{
+namespace greyattackaodv
+{
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Per-transmitter received signal strength, measured by a node's WiFi PHYs.
+ *
+ * Every frame sniffed by the PHYs of the node updates an exponentially
+ * weighted moving average of the signal strength received from its
+ * transmitter, in dBm, and of the rate of change of that average, in dB/s.
+ * Both are kept in arrays indexed by node id.  The average is pushed into
+ * TargetNodes::SetConnectionStrength(), and the rate into
+ * TargetNodes::d_connection_strength, only when the average moved by at
+ * least MinChange since it was last pushed.
+ */
+class LinkQualityMonitor : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    LinkQualityMonitor();
+    ~LinkQualityMonitor() override;
+
+    /**
+     * Listen to the frames received by all the WiFi devices of a node
+     * \param node the node
+     */
+    void Install(Ptr<Node> node);
+    /**
+     * \param targetNodes the connection strengths to keep up to date, may be null
+     */
+    void SetTargetNodes(Ptr<TargetNodes> targetNodes);
+    /**
+     * \param nodeId the node id of a transmitter
+     * \returns the average signal strength received from the node in dBm, 0 if none
+     */
+    double GetRssi(uint32_t nodeId) const;
+    /**
+     * \param nodeId the node id of a transmitter
+     * \returns the rate of change of GetRssi() in dB/s
+     */
+    double GetRssiDerivative(uint32_t nodeId) const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// Link quality measured from one transmitter
+    struct LinkQuality
+    {
+        float rssi{0};        ///< average signal strength, dBm
+        float derivative{0};  ///< rate of change of rssi, dB/s
+        float pushed{0};      ///< rssi last pushed into TargetNodes
+        Time lastSample;      ///< time of the last sample
+        bool known{false};    ///< a frame was received from the transmitter
+        bool isPushed{false}; ///< rssi was pushed into TargetNodes
+    };
+
+    /**
+     * Account for a sniffed frame
+     * \param packet the frame
+     * \param channelFreqMhz the channel frequency
+     * \param txVector the TXVECTOR of the frame
+     * \param aMpdu the A-MPDU information of the frame
+     * \param signalNoise the signal and noise power, in dBm
+     * \param staId the station ID
+     */
+    void SnifferRx(Ptr<const Packet> packet,
+                   uint16_t channelFreqMhz,
+                   WifiTxVector txVector,
+                   MpduInfo aMpdu,
+                   SignalNoiseDbm signalNoise,
+                   uint16_t staId);
+
+    double m_alpha;                         ///< weight of a new sample
+    double m_minChange;                     ///< change of rssi pushed into TargetNodes, dB
+    Ptr<TargetNodes> m_targetNodes;         ///< connection strengths to keep up to date
+    NodeIndexedVector<LinkQuality> m_links; ///< link quality per transmitter
+};
+
+} // namespace greyattackaodv
+} // namespace ns3
+
+#endif /* greyattack_aodv_LINK_QUALITY_MONITOR_H */
@@ -40,37 +40,37 @@ NS_LOG_COMPONENT_DEFINE("greyattackaodvNeighbors");
 namespace greyattackaodv
 {
 Neighbors::Neighbors(Time delay)
-    : m_ntimer(Timer::CANCEL_ON_DESTROY)
+    : m_nClosed(0)
 {
     m_ntimer.SetDelay(delay);
-    m_ntimer.SetFunction(&Neighbors::Purge, this);
+    m_ntimer.SetFunction(&Neighbors::TimerExpire, this);
     m_txErrorCallback = MakeCallback(&Neighbors::ProcessTxError, this);
 }
 
+Neighbors::Neighbor
+Neighbors::GetNeighbor(uint32_t i) const
+{
+    NS_ASSERT(i < m_neighborAddresses.size());
+    Neighbor neighbor(m_neighborAddresses[i], m_hardwareAddresses[i], m_expireTimes[i]);
+    neighbor.close = m_close[i];
+    return neighbor;
+}
+
 bool
 Neighbors::IsNeighbor(Ipv4Address addr)
 {
     Purge();
-    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
-    {
-        if (i->m_neighborAddress == addr)
-        {
-            return true;
-        }
-    }
-    return false;
+    return m_addressIndex.Find(addr) != nullptr;
 }
 
 Time
 Neighbors::GetExpireTime(Ipv4Address addr)
 {
     Purge();
-    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    const uint32_t* i = m_addressIndex.Find(addr);
+    if (i != nullptr)
     {
-        if (i->m_neighborAddress == addr)
-        {
-            return (i->m_expireTime - Simulator::Now());
-        }
+        return (m_expireTimes[*i] - Simulator::Now());
     }
     return Seconds(0);
 }
@@ -78,72 +78,137 @@ Neighbors::GetExpireTime(Ipv4Address addr)
 void
 Neighbors::Update(Ipv4Address addr, Time expire)
 {
-    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    const uint32_t* i = m_addressIndex.Find(addr);
+    if (i != nullptr)
     {
-        if (i->m_neighborAddress == addr)
+        m_expireTimes[*i] = std::max(expire + Simulator::Now(), m_expireTimes[*i]);
+        if (m_hardwareAddresses[*i] == Mac48Address())
         {
-            i->m_expireTime = std::max(expire + Simulator::Now(), i->m_expireTime);
-            if (i->m_hardwareAddress == Mac48Address())
+            Mac48Address hwaddr = LookupMacAddress(addr);
+            if (hwaddr != m_hardwareAddresses[*i])
             {
-                i->m_hardwareAddress = LookupMacAddress(i->m_neighborAddress);
+                EraseHardwareIndex(m_hardwareAddresses[*i], *i);
+                m_hardwareAddresses[*i] = hwaddr;
+                m_hardwareIndex.emplace(HardwareKey(hwaddr), *i);
             }
-            return;
         }
+        return;
     }
 
     NS_LOG_LOGIC("Open link to " << addr);
-    Neighbor neighbor(addr, LookupMacAddress(addr), expire + Simulator::Now());
-    m_nb.push_back(neighbor);
-    Purge();
-}
-
-/**
- * \brief CloseNeighbor structure
- */
-struct CloseNeighbor
-{
-    /**
-     * Check if the entry is expired
-     *
-     * \param nb Neighbors::Neighbor entry
-     * \return true if expired, false otherwise
-     */
-    bool operator()(const Neighbors::Neighbor& nb) const
+    uint32_t n = m_neighborAddresses.size();
+    Mac48Address hwaddr = LookupMacAddress(addr);
+    Time expireTime = expire + Simulator::Now();
+    if (n == 0 || expireTime < m_minExpireTime)
     {
-        return ((nb.m_expireTime < Simulator::Now()) || nb.close);
+        m_minExpireTime = expireTime;
     }
-};
+    m_neighborAddresses.push_back(addr);
+    m_hardwareAddresses.push_back(hwaddr);
+    m_expireTimes.push_back(expireTime);
+    m_close.push_back(false);
+    m_addressIndex.Insert(addr, n);
+    m_hardwareIndex.emplace(HardwareKey(hwaddr), n);
+    Purge();
+}
 
 void
 Neighbors::Purge()
 {
-    if (m_nb.empty())
+    if (m_neighborAddresses.empty())
     {
         return;
     }
 
-    CloseNeighbor pred;
-    if (!m_handleLinkFailure.IsNull())
+    Time now = Simulator::Now();
+    if (m_nClosed > 0 || m_minExpireTime < now)
     {
-        for (auto j = m_nb.begin(); j != m_nb.end(); ++j)
+        if (!m_handleLinkFailure.IsNull())
         {
-            if (pred(*j))
+            for (uint32_t i = 0; i < m_neighborAddresses.size(); ++i)
             {
-                NS_LOG_LOGIC("Close link to " << j->m_neighborAddress);
-                m_handleLinkFailure(j->m_neighborAddress);
+                if (IsClosed(i, now))
+                {
+                    NS_LOG_LOGIC("Close link to " << m_neighborAddresses[i]);
+                    m_handleLinkFailure(m_neighborAddresses[i]);
+                }
             }
         }
+        Compact(now);
     }
-    m_nb.erase(std::remove_if(m_nb.begin(), m_nb.end(), pred), m_nb.end());
-    m_ntimer.Cancel();
-    m_ntimer.Schedule();
+    ScheduleTimer();
+}
+
+void
+Neighbors::Compact(Time now)
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < m_neighborAddresses.size(); ++i)
+    {
+        if (IsClosed(i, now))
+        {
+            continue;
+        }
+        if (n == 0 || m_expireTimes[i] < m_minExpireTime)
+        {
+            m_minExpireTime = m_expireTimes[i];
+        }
+        m_neighborAddresses[n] = m_neighborAddresses[i];
+        m_hardwareAddresses[n] = m_hardwareAddresses[i];
+        m_expireTimes[n] = m_expireTimes[i];
+        m_close[n] = false;
+        ++n;
+    }
+    m_nClosed = 0;
+    if (n == m_neighborAddresses.size())
+    {
+        return;
+    }
+    m_neighborAddresses.resize(n);
+    m_hardwareAddresses.resize(n);
+    m_expireTimes.resize(n);
+    m_close.resize(n);
+    m_addressIndex.Clear();
+    m_hardwareIndex.clear();
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        m_addressIndex.Insert(m_neighborAddresses[i], i);
+        m_hardwareIndex.emplace(HardwareKey(m_hardwareAddresses[i]), i);
+    }
+}
+
+void
+Neighbors::Clear()
+{
+    m_neighborAddresses.clear();
+    m_hardwareAddresses.clear();
+    m_expireTimes.clear();
+    m_close.clear();
+    m_addressIndex.Clear();
+    m_hardwareIndex.clear();
+    m_nClosed = 0;
 }
 
 void
 Neighbors::ScheduleTimer()
 {
-    m_ntimer.Cancel();
-    m_ntimer.Schedule();
+    m_nextPurge = Simulator::Now() + m_ntimer.GetDelay();
+    if (!m_ntimer.IsRunning())
+    {
+        m_ntimer.Schedule();
+    }
+}
+
+void
+Neighbors::TimerExpire()
+{
+    Time now = Simulator::Now();
+    if (now < m_nextPurge)
+    {
+        m_ntimer.Schedule(m_nextPurge - now);
+        return;
+    }
+    Purge();
 }
 
 void
@@ -177,17 +242,44 @@ Neighbors::LookupMacAddress(Ipv4Address addr)
 void
 Neighbors::ProcessTxError(const WifiMacHeader& hdr)
 {
-    Mac48Address addr = hdr.GetAddr1();
-
-    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    auto range = m_hardwareIndex.equal_range(HardwareKey(hdr.GetAddr1()));
+    for (auto i = range.first; i != range.second; ++i)
     {
-        if (i->m_hardwareAddress == addr)
+        if (!m_close[i->second])
         {
-            i->close = true;
+            m_close[i->second] = true;
+            ++m_nClosed;
         }
     }
     Purge();
 }
 
+uint64_t
+Neighbors::HardwareKey(Mac48Address addr)
+{
+    uint8_t buffer[6];
+    addr.CopyTo(buffer);
+    uint64_t key = 0;
+    for (uint8_t byte : buffer)
+    {
+        key = (key << 8) | byte;
+    }
+    return key;
+}
+
+void
+Neighbors::EraseHardwareIndex(Mac48Address addr, uint32_t i)
+{
+    auto range = m_hardwareIndex.equal_range(HardwareKey(addr));
+    for (auto j = range.first; j != range.second; ++j)
+    {
+        if (j->second == i)
+        {
+            m_hardwareIndex.erase(j);
+            return;
+        }
+    }
+}
+
 } // namespace greyattackaodv
 } // namespace ns3
@@ -28,12 +28,17 @@
 #ifndef greyattack_aodvNEIGHBOR_H
 #define greyattack_aodvNEIGHBOR_H
 
+#include "greyattackaodv-address-table.h"
+#include "greyattackaodv-timer-wheel.h"
+
 #include "ns3/arp-cache.h"
 #include "ns3/callback.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/simulator.h"
 #include "ns3/timer.h"
 
+#include <stdint.h>
+#include <unordered_map>
 #include <vector>
 
 namespace ns3
@@ -49,6 +54,12 @@ class RoutingProtocol;
 /**
  * \ingroup greyattackaodv
  * \brief maintain list of active neighbors
+ *
+ * Neighbors are stored as parallel arrays, indexed by IPv4 address and by
+ * MAC address.  Purge() only scans the table when a neighbor may have
+ * expired or was closed by a TX error.  The purge timer is not rescheduled
+ * on each Purge(): when it fires before the purge is due, it rearms itself
+ * for the remaining time.
  */
 class Neighbors
 {
@@ -59,7 +70,7 @@ class Neighbors
      */
     Neighbors(Time delay);
 
-    /// Neighbor description
+    /// Neighbor description, as returned by GetNeighbor()
     struct Neighbor
     {
         /// Neighbor IPv4 address
@@ -87,6 +98,19 @@ class Neighbors
         }
     };
 
+    /**
+     * \returns the number of neighbors, including the expired ones not purged yet
+     */
+    uint32_t GetNNeighbors() const
+    {
+        return m_neighborAddresses.size();
+    }
+    /**
+     * \param i position of a neighbor, less than GetNNeighbors()
+     * \returns a copy of the neighbor
+     */
+    Neighbor GetNeighbor(uint32_t i) const;
+
     /**
      * Return expire time for neighbor node with address addr, if exists, else return 0.
      * \param addr the IP address of the neighbor node
@@ -109,13 +133,18 @@ class Neighbors
     void Purge();
     /// Schedule m_ntimer.
     void ScheduleTimer();
-
-    /// Remove all entries
-    void Clear()
+    /**
+     * Run the purge timer on a wheel, before it is first scheduled
+     * \param wheel the wheel
+     */
+    void SetTimerWheel(Ptr<TimerWheel> wheel)
     {
-        m_nb.clear();
+        m_ntimer.SetWheel(wheel);
     }
 
+    /// Remove all entries
+    void Clear();
+
     /**
      * Add ARP cache to be used to allow layer 2 notifications processing
      * \param a pointer to the ARP cache to add
@@ -160,9 +189,25 @@ class Neighbors
     /// TX error callback
     Callback<void, const WifiMacHeader&> m_txErrorCallback;
     /// Timer for neighbor's list. Schedule Purge().
-    Timer m_ntimer;
-    /// vector of entries
-    std::vector<Neighbor> m_nb;
+    WheelTimer m_ntimer;
+    /// Time at which m_ntimer is due to call Purge()
+    Time m_nextPurge;
+    /// Neighbor IPv4 addresses
+    std::vector<Ipv4Address> m_neighborAddresses;
+    /// Neighbor MAC addresses, the default address if not resolved yet
+    std::vector<Mac48Address> m_hardwareAddresses;
+    /// Neighbor expire times
+    std::vector<Time> m_expireTimes;
+    /// Neighbor close indicators
+    std::vector<bool> m_close;
+    /// Position of the neighbor by IPv4 address
+    Ipv4AddressTable<uint32_t> m_addressIndex;
+    /// Positions of the neighbors by MAC address, see HardwareKey()
+    std::unordered_multimap<uint64_t, uint32_t> m_hardwareIndex;
+    /// No neighbor expires before this time
+    Time m_minExpireTime;
+    /// Number of neighbors closed since the last purge
+    uint32_t m_nClosed;
     /// list of ARP cached to be used for layer 2 notifications processing
     std::vector<Ptr<ArpCache>> m_arp;
 
@@ -178,6 +223,34 @@ class Neighbors
      * \param hdr header of the packet
      */
     void ProcessTxError(const WifiMacHeader& hdr);
+    /// Purge the list when due, else rearm m_ntimer
+    void TimerExpire();
+    /**
+     * Remove the expired and closed neighbors, keeping the order of the others
+     * \param now the current time
+     */
+    void Compact(Time now);
+    /**
+     * \param i position of a neighbor
+     * \param now the current time
+     * \returns true if the neighbor is to be removed
+     */
+    bool IsClosed(uint32_t i, Time now) const
+    {
+        return (m_expireTimes[i] < now) || m_close[i];
+    }
+
+    /**
+     * \param addr a MAC address
+     * \returns the key of addr in m_hardwareIndex
+     */
+    static uint64_t HardwareKey(Mac48Address addr);
+    /**
+     * Remove an entry of m_hardwareIndex
+     * \param addr the MAC address
+     * \param i the position of the neighbor
+     */
+    void EraseHardwareIndex(Mac48Address addr, uint32_t i);
 };
 
 } // namespace greyattackaodv
@@ -0,0 +1,271 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "greyattackaodv-node-index.h"
+
+#include "greyattackaodv-address-table.h"
+
+#include "ns3/ipv4.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+
+#include <unordered_map>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("greyattackaodvNodeIndex");
+
+namespace greyattackaodv
+{
+
+namespace
+{
+
+/**
+ * \brief Address to node id map, built from the NodeList on first use.
+ *
+ * A lookup that misses rebuilds the map only when nodes were added to the
+ * NodeList, or Invalidate() was called, since the last build; other misses
+ * are answered from the map.  The map is cleared by Simulator::Destroy().
+ *
+ * \tparam Indexing provides the Key address type, the Table type holding the
+ * node ids, and AddNode(), which inserts the addresses of a node into the
+ * table
+ */
+template <typename Indexing>
+class LazyNodeIndex
+{
+  public:
+    /**
+     * \param address the address
+     * \returns the id of the node owning address, or NOT_FOUND
+     */
+    static uint32_t Lookup(typename Indexing::Key address)
+    {
+        LazyNodeIndex& index = Get();
+        if (!index.m_built)
+        {
+            index.Build();
+        }
+        const uint32_t* id = index.m_table.Find(address);
+        if (!id && (index.m_stale || NodeList::GetNNodes() != index.m_nNodes))
+        {
+            index.Build();
+            id = index.m_table.Find(address);
+        }
+        return id ? *id : Ipv4NodeIndex::NOT_FOUND;
+    }
+
+    /// Make the next lookup of an address not in the map rebuild it
+    static void Invalidate()
+    {
+        Get().m_stale = true;
+    }
+
+  private:
+    LazyNodeIndex()
+        : m_built(false),
+          m_stale(false),
+          m_destroyScheduled(false),
+          m_nNodes(0)
+    {
+    }
+
+    /**
+     * \returns the map of this address type
+     */
+    static LazyNodeIndex& Get()
+    {
+        static LazyNodeIndex index;
+        return index;
+    }
+
+    /// Rebuild the map from the NodeList
+    void Build()
+    {
+        NS_LOG_FUNCTION(this);
+        m_table.Clear();
+        for (uint32_t n = 0; n < NodeList::GetNNodes(); ++n)
+        {
+            Indexing::AddNode(NodeList::GetNode(n), m_table);
+        }
+        m_nNodes = NodeList::GetNNodes();
+        m_built = true;
+        m_stale = false;
+        if (!m_destroyScheduled)
+        {
+            Simulator::ScheduleDestroy(&LazyNodeIndex::Clear);
+            m_destroyScheduled = true;
+        }
+    }
+
+    /// Forget the map
+    static void Clear()
+    {
+        NS_LOG_FUNCTION_NOARGS();
+        LazyNodeIndex& index = Get();
+        index.m_table.Clear();
+        index.m_built = false;
+        index.m_stale = false;
+        index.m_destroyScheduled = false;
+    }
+
+    typename Indexing::Table m_table; //!< address to node id
+    bool m_built;                     //!< the map reflects the NodeList
+    bool m_stale;                     //!< an address changed since the last build
+    bool m_destroyScheduled;          //!< Clear() is scheduled on Simulator::Destroy()
+    uint32_t m_nNodes;                //!< number of nodes at the last build
+};
+
+/// Indexing of the IPv4 addresses of the interfaces, loopback excluded
+struct Ipv4Indexing
+{
+    /// Address type
+    typedef Ipv4Address Key;
+    /// Address to node id table
+    typedef Ipv4AddressTable<uint32_t> Table;
+
+    /**
+     * Insert the addresses of a node
+     * \param node the node
+     * \param table the table
+     */
+    static void AddNode(Ptr<Node> node, Table& table)
+    {
+        Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+        if (!ipv4)
+        {
+            return;
+        }
+        for (uint32_t i = 0; i < ipv4->GetNInterfaces(); ++i)
+        {
+            for (uint32_t j = 0; j < ipv4->GetNAddresses(i); ++j)
+            {
+                Ipv4Address local = ipv4->GetAddress(i, j).GetLocal();
+                if (!local.IsLocalhost())
+                {
+                    table.Insert(local, node->GetId());
+                }
+            }
+        }
+    }
+};
+
+/// Indexing of the Mac48Address of the devices
+struct Mac48Indexing
+{
+    /// Address type
+    typedef Mac48Address Key;
+
+    /// Address to node id table, with the interface of Ipv4AddressTable
+    class Table
+    {
+      public:
+        /**
+         * \param address the address
+         * \returns a pointer to the node id, or nullptr if not present
+         */
+        const uint32_t* Find(Mac48Address address) const
+        {
+            auto it = m_index.find(Pack(address));
+            return it != m_index.end() ? &it->second : nullptr;
+        }
+
+        /**
+         * Insert a node id if the address is not yet present
+         * \param address the address
+         * \param id the node id
+         */
+        void Insert(Mac48Address address, uint32_t id)
+        {
+            m_index.emplace(Pack(address), id);
+        }
+
+        /// Remove all the entries
+        void Clear()
+        {
+            m_index.clear();
+        }
+
+      private:
+        /**
+         * \param address the address
+         * \returns the address packed in the low 48 bits of an integer
+         */
+        static uint64_t Pack(Mac48Address address)
+        {
+            uint8_t buffer[6];
+            address.CopyTo(buffer);
+            uint64_t key = 0;
+            for (auto byte : buffer)
+            {
+                key = (key << 8) | byte;
+            }
+            return key;
+        }
+
+        std::unordered_map<uint64_t, uint32_t> m_index; //!< packed address to node id
+    };
+
+    /**
+     * Insert the addresses of a node
+     * \param node the node
+     * \param table the table
+     */
+    static void AddNode(Ptr<Node> node, Table& table)
+    {
+        for (uint32_t i = 0; i < node->GetNDevices(); ++i)
+        {
+            Address address = node->GetDevice(i)->GetAddress();
+            if (Mac48Address::IsMatchingType(address))
+            {
+                table.Insert(Mac48Address::ConvertFrom(address), node->GetId());
+            }
+        }
+    }
+};
+
+} // namespace
+
+uint32_t
+Ipv4NodeIndex::Lookup(Ipv4Address address)
+{
+    return LazyNodeIndex<Ipv4Indexing>::Lookup(address);
+}
+
+void
+Ipv4NodeIndex::Invalidate()
+{
+    LazyNodeIndex<Ipv4Indexing>::Invalidate();
+}
+
+uint32_t
+Mac48NodeIndex::Lookup(Mac48Address address)
+{
+    return LazyNodeIndex<Mac48Indexing>::Lookup(address);
+}
+
+void
+Mac48NodeIndex::Invalidate()
+{
+    LazyNodeIndex<Mac48Indexing>::Invalidate();
+}
+
+} // namespace greyattackaodv
+} // namespace ns3
@@ -0,0 +1,85 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_NODE_INDEX_H
+#define greyattack_aodv_NODE_INDEX_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/mac48-address.h"
+
+#include <stdint.h>
+
+namespace ns3
+{
+namespace greyattackaodv
+{
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Map IPv4 addresses onto the id of the node owning them.
+ *
+ * The map covers the addresses of all the interfaces of the nodes in the
+ * NodeList, loopback excluded.  It is built on first use and rebuilt when
+ * an address is not found and nodes were added, or Invalidate() was called,
+ * since the last build.  The greyattackaodv routing protocol invalidates
+ * the map whenever an address is added to or removed from its node, so
+ * that addresses assigned later are picked up, while lookups of foreign
+ * addresses do not walk the NodeList again.  The map is cleared by
+ * Simulator::Destroy().
+ */
+class Ipv4NodeIndex
+{
+  public:
+    /// Node id returned for addresses not owned by any node
+    static const uint32_t NOT_FOUND = 0xffffffff;
+
+    /**
+     * \param address the address
+     * \returns the id of the node owning address, or NOT_FOUND
+     */
+    static uint32_t Lookup(Ipv4Address address);
+    /// Make the next lookup of an address not in the map rebuild it
+    static void Invalidate();
+};
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Map MAC addresses onto the id of the node owning them.
+ *
+ * The map covers the Mac48Address of all the devices of the nodes in the
+ * NodeList, and is built, rebuilt and cleared as the Ipv4NodeIndex map is.
+ * The greyattackaodv routing protocol invalidates it when an address is
+ * added to its node, which is when the device of a new interface is
+ * usually installed.
+ */
+class Mac48NodeIndex
+{
+  public:
+    /// Node id returned for addresses not owned by any node
+    static const uint32_t NOT_FOUND = 0xffffffff;
+
+    /**
+     * \param address the address
+     * \returns the id of the node owning address, or NOT_FOUND
+     */
+    static uint32_t Lookup(Mac48Address address);
+    /// Make the next lookup of an address not in the map rebuild it
+    static void Invalidate();
+};
+
+} // namespace greyattackaodv
+} // namespace ns3
+
+#endif /* greyattack_aodv_NODE_INDEX_H */
@@ -0,0 +1,115 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_RATE_LIMITER_H
+#define greyattack_aodv_RATE_LIMITER_H
+
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+#include <stdint.h>
+
+namespace ns3
+{
+namespace greyattackaodv
+{
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Token bucket refilled at the start of each period.
+ *
+ * Periods are aligned on the time Start() was called, so that at most
+ * \p limit tokens are taken in any of the periods [start + k * period,
+ * start + (k + 1) * period), as RREQ_RATELIMIT and RERR_RATELIMIT require.
+ * The bucket is refilled lazily when a token is asked for and schedules
+ * no event of its own.
+ */
+class RateLimiter
+{
+  public:
+    /**
+     * constructor
+     * \param period the refill period
+     */
+    RateLimiter(Time period = Seconds(1))
+        : m_period(period),
+          m_taken(0)
+    {
+    }
+
+    /// Start the first period now
+    void Start()
+    {
+        m_periodEnd = Simulator::Now() + m_period;
+        m_taken = 0;
+    }
+
+    /**
+     * Take a token
+     * \param limit the number of tokens per period
+     * \returns true if a token was available
+     */
+    bool TryAcquire(uint16_t limit)
+    {
+        if (!IsAvailable(limit))
+        {
+            return false;
+        }
+        ++m_taken;
+        return true;
+    }
+
+    /**
+     * \param limit the number of tokens per period
+     * \returns true if a token is available
+     */
+    bool IsAvailable(uint16_t limit)
+    {
+        Refill();
+        return m_taken < limit;
+    }
+
+    /**
+     * \returns the time left before the bucket is refilled
+     */
+    Time GetDelayLeft()
+    {
+        Refill();
+        return m_periodEnd - Simulator::Now();
+    }
+
+  private:
+    /// Move to the current period, emptying the count of taken tokens
+    void Refill()
+    {
+        Time now = Simulator::Now();
+        if (now < m_periodEnd)
+        {
+            return;
+        }
+        int64_t elapsed = (now - m_periodEnd).GetTimeStep() / m_period.GetTimeStep();
+        m_periodEnd += TimeStep(m_period.GetTimeStep() * (elapsed + 1));
+        m_taken = 0;
+    }
+
+    Time m_period;    ///< refill period
+    Time m_periodEnd; ///< end of the current period
+    uint16_t m_taken; ///< tokens taken in the current period
+};
+
+} // namespace greyattackaodv
+} // namespace ns3
+
+#endif /* greyattack_aodv_RATE_LIMITER_H */
@@ -31,20 +31,23 @@
     }
 
 #include "greyattackaodv-routing-protocol.h"
+
+#include "greyattackaodv-attack-log.h"
+
 #include "ns3/adhoc-wifi-mac.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/string.h"
-#include "ns3/trace-source-accessor.h"
 #include "ns3/udp-header.h"
 #include "ns3/udp-l4-protocol.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
 #include "ns3/wifi-mpdu.h"
 #include "ns3/wifi-net-device.h"
-#include "ns3/double.h"
 
 #include <algorithm>
 #include <limits>
@@ -166,6 +169,8 @@ RoutingProtocol::RoutingProtocol()
       m_destinationOnly(false),
       m_gratuitousReply(true),
       m_enableHello(false),
+      m_deferredRouteFastPath(false),
+      m_rerrCoalescingWindow(Seconds(0)),
       m_routingTable(m_deletePeriod),
       m_queue(m_maxQueueLen, m_maxQueueTime),
       m_requestId(0),
@@ -173,31 +178,12 @@ RoutingProtocol::RoutingProtocol()
       m_rreqIdCache(m_pathDiscoveryTime),
       m_dpd(m_pathDiscoveryTime),
       m_nb(m_helloInterval),
-      m_rreqCount(0),
-      m_rerrCount(0),
-      m_DropWindowTimer(Timer::CANCEL_ON_DESTROY),
-      m_htimer(Timer::CANCEL_ON_DESTROY),
-      m_rreqRateLimitTimer(Timer::CANCEL_ON_DESTROY),
-      m_rerrRateLimitTimer(Timer::CANCEL_ON_DESTROY),
-      m_lastBcastTime(Seconds(0)),
-      m_strat(0),
-      m_vPercentDrop(0.0),
-      m_vTConnection(0.0),
-      m_vTNeighbour(0),
-      m_DropWindowChance(0.0),
-      m_DropSelectChance(0.0)
+      m_rreqPendingTimer(Timer::CANCEL_ON_DESTROY),
+      m_pendingRerrBroadcast(false),
+      m_rerrCoalescingTimer(Timer::CANCEL_ON_DESTROY),
+      m_lastBcastTime(Seconds(0))
 {
     m_nb.SetCallback(MakeCallback(&RoutingProtocol::SendRerrWhenBreaksLinkToNextHop, this));
-
-    // Define the targetNodes Variable
-    targetNodes = CreateObject<TargetNodes> ();
-    dropped_stats = CreateObject<DroppedStats> ();
-
-    for(uint32_t tn = 0; tn < num_defending_nodes + num_malicious_nodes + 2; tn++)
-    {
-        targetNodes->connection_strength.push_back(-90.0);
-        targetNodes->d_connection_strength.push_back(0.0);
-    }
 }
 
 TypeId
@@ -349,51 +335,32 @@ RoutingProtocol::GetTypeId()
                           MakeBooleanAccessor(&RoutingProtocol::SetBroadcastEnable,
                                               &RoutingProtocol::GetBroadcastEnable),
                           MakeBooleanChecker())
+            .AddAttribute("DeferredRouteFastPath",
+                          "Indicates whether packets looped back while a route is searched are "
+                          "recognized by their source address rather than by a packet tag. "
+                          "Packets sent on a given output interface are tagged in any case.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_deferredRouteFastPath),
+                          MakeBooleanChecker())
+            .AddAttribute("RerrCoalescingWindow",
+                          "RERRs originated or forwarded within this time of the first one are "
+                          "merged into one message, sent when the window ends. Zero sends every "
+                          "RERR immediately.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RoutingProtocol::m_rerrCoalescingWindow),
+                          MakeTimeChecker(Seconds(0), Seconds(1)))
+            .AddAttribute("RoutingTableBackend",
+                          "Storage used by the routing table. Both backends give the same "
+                          "routing decisions; HashTable avoids full-table scans on lookup.",
+                          EnumValue(ORDERED_MAP),
+                          MakeEnumAccessor(&RoutingProtocol::SetRoutingTableBackend,
+                                           &RoutingProtocol::GetRoutingTableBackend),
+                          MakeEnumChecker(ORDERED_MAP, "OrderedMap", HASH_TABLE, "HashTable"))
             .AddAttribute("UniformRv",
                           "Access to the underlying UniformRandomVariable",
                           StringValue("ns3::UniformRandomVariable"),
                           MakePointerAccessor(&RoutingProtocol::m_uniformRandomVariable),
                           MakePointerChecker<UniformRandomVariable>())
-            .AddAttribute ("mStrat", "The Malicious Node Strategy.",
-                          UintegerValue (0),
-                          MakeUintegerAccessor (&RoutingProtocol::m_strat),
-                          MakeUintegerChecker<uint32_t> ())
-            .AddAttribute ("targetNodes", "A List of nodes that we wish to target, and their signal strength",
-                          PointerValue(),
-                          MakePointerAccessor(&RoutingProtocol::targetNodes),
-                          MakePointerChecker<TargetNodes>())
-            .AddAttribute ("NeighbourThresh", "The Number of Neighbour threshold nodes.",
-                          UintegerValue (0),
-                          MakeUintegerAccessor (&RoutingProtocol::m_vTNeighbour),
-                          MakeUintegerChecker<uint32_t> ())
-            .AddAttribute("PercentDrop",
-                          "The Number of Packets to drop",
-                          DoubleValue(0.0), MakeDoubleAccessor(&RoutingProtocol::m_vPercentDrop),
-                          MakeDoubleChecker<double> ())
-            .AddAttribute ("ConnectionStrengthThreshold",
-                          "If the connection strength to a node is greater than this value, then the packet will be dropped",
-                          DoubleValue(0.0), MakeDoubleAccessor(&RoutingProtocol::m_vTConnection),
-                          MakeDoubleChecker<double> ())
-            .AddAttribute("DropWindowChance",
-                          "The chance that a specific window is a drop or forward window",
-                          DoubleValue(0.0), MakeDoubleAccessor(&RoutingProtocol::m_DropWindowChance),
-                          MakeDoubleChecker<double> ())
-            .AddAttribute("DropSelectChance",
-                          "The chance that a specific node is selected for the grey hole to never foward their packets",
-                          DoubleValue(0.0), MakeDoubleAccessor(&RoutingProtocol::m_DropSelectChance),
-                          MakeDoubleChecker<double> ())
-            .AddAttribute ("num_defending_nodes", "The Number of Defending Nodes (used to calculate FP / FN at the end).",
-                          UintegerValue (0),
-                          MakeUintegerAccessor (&RoutingProtocol::num_defending_nodes),
-                          MakeUintegerChecker<uint32_t> ())
-            .AddAttribute ("num_malicious_nodes", "The Number of Defending Nodes (used to calculate FP / FN at the end).",
-                          UintegerValue (0),
-                          MakeUintegerAccessor (&RoutingProtocol::num_malicious_nodes),
-                          MakeUintegerChecker<uint32_t> ())
-            .AddAttribute ("DropStats", "The Number of Packets dropped by this node.",
-                           PointerValue(),
-                           MakePointerAccessor(&RoutingProtocol::dropped_stats),
-                           MakePointerChecker<DroppedStats>())
         ;
     return tid;
 }
@@ -420,18 +387,15 @@ void
 RoutingProtocol::DoDispose()
 {
     m_ipv4 = nullptr;
-    for (auto iter = m_socketAddresses.begin(); iter != m_socketAddresses.end(); iter++)
-    {
-        iter->first->Close();
-    }
-    m_socketAddresses.clear();
-    for (auto iter = m_socketSubnetBroadcastAddresses.begin();
-         iter != m_socketSubnetBroadcastAddresses.end();
-         iter++)
+    for (auto interface : m_interfaces)
     {
-        iter->first->Close();
+        m_interfaceSockets[interface].socket->Close();
+        m_interfaceSockets[interface].broadcastSocket->Close();
     }
-    m_socketSubnetBroadcastAddresses.clear();
+    m_interfaceSockets.clear();
+    m_interfaces.clear();
+    m_htimer.Cancel();
+    m_timerWheel = nullptr;
     Ipv4RoutingProtocol::DoDispose();
 }
 
@@ -452,23 +416,32 @@ RoutingProtocol::AssignStreams(int64_t stream)
 {
     NS_LOG_FUNCTION(this << stream);
     m_uniformRandomVariable->SetStream(stream);
-    return 1;
+    // stream + 1 drives the attack decisions of GreyHoleRoutingProtocol, it is
+    // counted here so that both variants number the streams of a node alike
+    return 2;
+}
+
+void
+RoutingProtocol::SetTimerWheel(Ptr<TimerWheel> wheel)
+{
+    NS_LOG_FUNCTION(this);
+    m_timerWheel = wheel;
+    m_htimer.SetWheel(wheel);
+    m_nb.SetTimerWheel(wheel);
 }
 
 void
 RoutingProtocol::Start()
 {
     NS_LOG_FUNCTION(this);
-    strat = static_cast<AttackStratSelect>(m_strat);
     if (m_enableHello)
     {
         m_nb.ScheduleTimer();
     }
-    m_rreqRateLimitTimer.SetFunction(&RoutingProtocol::RreqRateLimitTimerExpire, this);
-    m_rreqRateLimitTimer.Schedule(Seconds(1));
-
-    m_rerrRateLimitTimer.SetFunction(&RoutingProtocol::RerrRateLimitTimerExpire, this);
-    m_rerrRateLimitTimer.Schedule(Seconds(1));
+    m_rreqLimiter.Start();
+    m_rerrLimiter.Start();
+    m_rreqPendingTimer.SetFunction(&RoutingProtocol::SendPendingRequests, this);
+    m_rerrCoalescingTimer.SetFunction(&RoutingProtocol::FlushRerr, this);
 }
 
 Ptr<Ipv4Route>
@@ -483,7 +456,7 @@ RoutingProtocol::RouteOutput(Ptr<Packet> p,
         NS_LOG_DEBUG("Packet is == 0");
         return LoopbackRoute(header, oif); // later
     }
-    if (m_socketAddresses.empty())
+    if (m_interfaces.empty())
     {
         sockerr = Socket::ERROR_NOROUTETOHOST;
         NS_LOG_LOGIC("No greyattackaodv interfaces");
@@ -514,12 +487,15 @@ RoutingProtocol::RouteOutput(Ptr<Packet> p,
     // Valid route not found, in this case we return loopback.
     // Actual route request will be deferred until packet will be fully formed,
     // routed to loopback, received from loopback and passed to RouteInput (see below)
-    uint32_t iif = (oif ? m_ipv4->GetInterfaceForDevice(oif) : -1);
-    DeferredRouteOutputTag tag(iif);
     NS_LOG_DEBUG("Valid Route not found");
-    if (!p->PeekPacketTag(tag))
+    if (!m_deferredRouteFastPath || oif)
     {
-        p->AddPacketTag(tag);
+        uint32_t iif = (oif ? m_ipv4->GetInterfaceForDevice(oif) : -1);
+        DeferredRouteOutputTag tag(iif);
+        if (!p->PeekPacketTag(tag))
+        {
+            p->AddPacketTag(tag);
+        }
     }
     return LoopbackRoute(header, oif);
 }
@@ -539,9 +515,8 @@ RoutingProtocol::DeferredRouteOutput(Ptr<const Packet> p,
     {
         NS_LOG_LOGIC("Add packet " << p->GetUid() << " to queue. Protocol "
                                    << (uint16_t)header.GetProtocol());
-        RoutingTableEntry rt;
-        bool result = m_routingTable.LookupRoute(header.GetDestination(), rt);
-        if (!result || ((rt.GetFlag() != IN_SEARCH) && result))
+        const RoutingTableEntry* rt = m_routingTable.FindEntry(header.GetDestination());
+        if (!rt || rt->GetFlag() != IN_SEARCH)
         {
             NS_LOG_LOGIC("Send new RREQ for outbound packet to " << header.GetDestination());
             SendRequest(header.GetDestination());
@@ -559,7 +534,7 @@ RoutingProtocol::RouteInput(Ptr<const Packet> p,
                             const ErrorCallback& ecb)
 {
     NS_LOG_FUNCTION(this << p->GetUid() << header.GetDestination() << idev->GetAddress());
-    if (m_socketAddresses.empty())
+    if (m_interfaces.empty())
     {
         NS_LOG_LOGIC("No greyattackaodv interfaces");
         return false;
@@ -573,11 +548,12 @@ RoutingProtocol::RouteInput(Ptr<const Packet> p,
     Ipv4Address dst = header.GetDestination();
     Ipv4Address origin = header.GetSource();
 
-    // Deferred route request
+    // Deferred route request.  On the fast path only packets with an output
+    // interface constraint are tagged, the others are our own packets.
     if (idev == m_lo)
     {
         DeferredRouteOutputTag tag;
-        if (p->PeekPacketTag(tag))
+        if ((m_deferredRouteFastPath && IsMyOwnAddress(origin)) || p->PeekPacketTag(tag))
         {
             DeferredRouteOutput(p, header, ucb, ecb);
             return true;
@@ -597,67 +573,64 @@ RoutingProtocol::RouteInput(Ptr<const Packet> p,
     }
 
     // Broadcast local delivery/forwarding
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+    if (static_cast<uint32_t>(iif) < m_interfaceSockets.size() && m_interfaceSockets[iif].socket)
     {
-        Ipv4InterfaceAddress iface = j->second;
-        if (m_ipv4->GetInterfaceForAddress(iface.GetLocal()) == iif)
+        Ipv4InterfaceAddress iface = m_interfaceSockets[iif].address;
+        if (dst == iface.GetBroadcast() || dst.IsBroadcast())
         {
-            if (dst == iface.GetBroadcast() || dst.IsBroadcast())
+            if (m_dpd.IsDuplicate(p, header))
             {
-                if (m_dpd.IsDuplicate(p, header))
-                {
-                    NS_LOG_DEBUG("Duplicated packet " << p->GetUid() << " from " << origin
-                                                      << ". Drop.");
-                    return true;
-                }
-                UpdateRouteLifeTime(origin, m_activeRouteTimeout);
-                Ptr<Packet> packet = p->Copy();
-                if (!lcb.IsNull())
-                {
-                    NS_LOG_LOGIC("Broadcast local delivery to " << iface.GetLocal());
-                    lcb(p, header, iif);
-                    // Fall through to additional processing
-                }
-                else
-                {
-                    NS_LOG_ERROR("Unable to deliver packet locally due to null callback "
-                                 << p->GetUid() << " from " << origin);
-                    ecb(p, header, Socket::ERROR_NOROUTETOHOST);
-                }
-                if (!m_enableBroadcast)
+                NS_LOG_DEBUG("Duplicated packet " << p->GetUid() << " from " << origin
+                                                  << ". Drop.");
+                return true;
+            }
+            UpdateRouteLifeTime(origin, m_activeRouteTimeout);
+            Ptr<Packet> packet = p->Copy();
+            if (!lcb.IsNull())
+            {
+                NS_LOG_LOGIC("Broadcast local delivery to " << iface.GetLocal());
+                lcb(p, header, iif);
+                // Fall through to additional processing
+            }
+            else
+            {
+                NS_LOG_ERROR("Unable to deliver packet locally due to null callback "
+                             << p->GetUid() << " from " << origin);
+                ecb(p, header, Socket::ERROR_NOROUTETOHOST);
+            }
+            if (!m_enableBroadcast)
+            {
+                return true;
+            }
+            if (header.GetProtocol() == UdpL4Protocol::PROT_NUMBER)
+            {
+                UdpHeader udpHeader;
+                p->PeekHeader(udpHeader);
+                if (udpHeader.GetDestinationPort() == greyattack_aodv_PORT)
                 {
+                    // greyattackaodv packets sent in broadcast are already managed
                     return true;
                 }
-                if (header.GetProtocol() == UdpL4Protocol::PROT_NUMBER)
-                {
-                    UdpHeader udpHeader;
-                    p->PeekHeader(udpHeader);
-                    if (udpHeader.GetDestinationPort() == greyattack_aodv_PORT)
-                    {
-                        // greyattackaodv packets sent in broadcast are already managed
-                        return true;
-                    }
-                }
-                if (header.GetTtl() > 1)
+            }
+            if (header.GetTtl() > 1)
+            {
+                NS_LOG_LOGIC("Forward broadcast. TTL " << (uint16_t)header.GetTtl());
+                RoutingTableEntry toBroadcast;
+                if (m_routingTable.LookupRoute(dst, toBroadcast))
                 {
-                    NS_LOG_LOGIC("Forward broadcast. TTL " << (uint16_t)header.GetTtl());
-                    RoutingTableEntry toBroadcast;
-                    if (m_routingTable.LookupRoute(dst, toBroadcast))
-                    {
-                        Ptr<Ipv4Route> route = toBroadcast.GetRoute();
-                        ucb(route, packet, header);
-                    }
-                    else
-                    {
-                        NS_LOG_DEBUG("No route to forward broadcast. Drop packet " << p->GetUid());
-                    }
+                    Ptr<Ipv4Route> route = toBroadcast.GetRoute();
+                    ucb(route, packet, header);
                 }
                 else
                 {
-                    NS_LOG_DEBUG("TTL exceeded. Drop packet " << p->GetUid());
+                    NS_LOG_DEBUG("No route to forward broadcast. Drop packet " << p->GetUid());
                 }
-                return true;
             }
+            else
+            {
+                NS_LOG_DEBUG("TTL exceeded. Drop packet " << p->GetUid());
+            }
+            return true;
         }
     }
 
@@ -706,32 +679,12 @@ RoutingProtocol::Forwarding(Ptr<const Packet> p,
     NS_LOG_FUNCTION(this);
     Ipv4Address dst = header.GetDestination();
     Ipv4Address origin = header.GetSource();
-    uint16_t packetID = header.GetIdentification();
-    m_routingTable.Purge();
-    RoutingTableEntry toDst;
-    if (m_routingTable.LookupRoute(dst, toDst))
+    const RoutingTableEntry* toDst = m_routingTable.FindEntry(dst);
+    if (toDst)
     {
-        if (toDst.GetFlag() == VALID)
+        if (toDst->GetFlag() == VALID)
         {
-            // get the precursor nodes (used later on)
-            std::vector<Ipv4Address> precursors;
-            uint32_t precur_node = 999;
-
-            uint32_t num_precursors = 0;
-            toDst.GetPrecursors (precursors);
-            for(auto i : precursors)
-            {
-                uint8_t precur_buf[4];
-                i.Serialize(precur_buf);
-                precur_node = unsigned(precur_buf[3]) - 1;
-                //NS_LOG_UNCOND("Found a Precursor Node: " << precur_node);
-                num_precursors += 1;
-            }
-
-            //if(num_precursors > 1)
-                //NS_LOG_UNCOND("Total Precurors: " << num_precursors);
-
-            Ptr<Ipv4Route> route = toDst.GetRoute();
+            Ptr<Ipv4Route> route = toDst->GetRoute();
             NS_LOG_LOGIC(route->GetSource() << " forwarding to " << dst << " from " << origin
                                             << " packet " << p->GetUid());
 
@@ -740,155 +693,36 @@ RoutingProtocol::Forwarding(Ptr<const Packet> p,
              *  Lifetime field of the source, destination and the next hop on the
              *  path to the destination is updated to be no less than the current
              *  time plus ActiveRouteTimeout.
-             */
-            UpdateRouteLifeTime(origin, m_activeRouteTimeout);
-            UpdateRouteLifeTime(dst, m_activeRouteTimeout);
-            UpdateRouteLifeTime(route->GetGateway(), m_activeRouteTimeout);
-            /*
+             *
              *  Since the route between each originator and destination pair is expected to be
              * symmetric, the Active Route Lifetime for the previous hop, along the reverse path
              * back to the IP source, is also updated to be no less than the current time plus
              * ActiveRouteTimeout
              */
-            RoutingTableEntry toOrigin;
-            m_routingTable.LookupRoute(origin, toOrigin);
-            UpdateRouteLifeTime(toOrigin.GetNextHop(), m_activeRouteTimeout);
+            Ipv4Address toOriginNextHop =
+                m_routingTable.RefreshActivePath(origin, dst, m_activeRouteTimeout);
 
             m_nb.Update(route->GetGateway(), m_activeRouteTimeout);
-            m_nb.Update(toOrigin.GetNextHop(), m_activeRouteTimeout);
+            m_nb.Update(toOriginNextHop, m_activeRouteTimeout);
 
-            switch(strat)
+            bool silent = false;
+            if (DropForwardedPacket(p, header, *toDst, silent))
             {
-            case PACKET_DROP_PERC:{
-                NS_LOG_ERROR("Strategy PACKET_DROP_PERC selected");
-
-                Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
-                rng->SetAttribute ("Min", DoubleValue (0));
-                rng->SetAttribute ("Max", DoubleValue (1));
-
-                double randomDouble = rng->GetValue();
-                if (randomDouble < m_vPercentDrop && p->GetSize() > 400) {
-                    NS_LOG_ERROR("[Attack - PACKET_DROP_PERC]: Dropped packet " << packetID << " where the next hop was "
-                                                                                << toDst.GetNextHop());
-                    dropped_stats->drop_count[precur_node] += 1;
-                    return true;
-                }
-                break;
-            }
-            case PACKET_DROP_CONNECTION:{
-                //// drops packets when the connection to the next hop node is at or above a pre-set threshold value
-                NS_LOG_ERROR("Strategy PACKET_DROP_CONNECTION selected");
-
-                // Get the node number from destination address and the precursor nodes
-                uint8_t buf[4];
-                float precur_connection_strength = 0.0;
-
-                toDst.GetNextHop().Serialize(buf);
-
-                // get the node number of the target node
-                uint32_t index = unsigned(buf[3]) - 1;
-
-                // check if we have updated the connection_strength vector...
-                if (!targetNodes->connection_strength.size())
-                    break;
-
-                // get the node number of the precursor.
-                for(auto i : precursors)
-                {
-                    uint8_t precur_buf[4];
-                    i.Serialize(precur_buf);
-                    precur_node = unsigned(precur_buf[3]) - 1;
-
-                    // check if the precursor node is valid
-                    if (precur_node >= targetNodes->connection_strength.size())
-                        continue;
-
-                    if(targetNodes->connection_strength[precur_node])
-                    {
-                        precur_connection_strength = targetNodes->connection_strength[precur_node];
-                        break;
-                    }
-                }
-
-                if (targetNodes->connection_strength[index]
-                    && precur_connection_strength < m_vTConnection
-                    && p->GetSize() > 400) {
-                    //i.e. if we have a less than m_vTConnection connectivity to
-                    // our precursor... drop the packet.
-
-
-                    NS_LOG_ERROR("[Attack - PACKET_DROP_CONNECTION]: Dropped packet " << packetID
-                                                                                      << " where the next hop was "
-                                                                                      << toDst.GetNextHop()
-                                                                                      << " and the precursor was:"
-                                                                                      << precur_node
-                                                                                      << " with connection strength:"
-                                                                                      << precur_connection_strength);
-                    dropped_stats->drop_count[precur_node] += 1;
-                    return false;
-                }
-                break;
-            }
-            case PACKET_DROP_NEIGHBOURS:{
-                uint32_t neighbour_bad_con_count = 0;
-                NS_LOG_ERROR("[Attack - PACKET_DROP_NEIGHBOUR] Selected");
-                for (auto i: targetNodes->connection_strength)
-                {
-                    if(i < 1.0) {
-                        neighbour_bad_con_count++;
-                    }
-                }
-                if (neighbour_bad_con_count >= m_vTNeighbour)
-                {
-                    NS_LOG_ERROR("[Attack - PACKET_DROP_NEIGHBOUR] neighbour_bad_con_count is: " << neighbour_bad_con_count);
-                    dropped_stats->drop_count[precur_node] += 1;
-                    return false;
-                }
-                else
-                    break;
-            }
-            case PACKET_DROP_IN_TIME:{
-                if (DropWindowDropping && p->GetSize() > 400) {
-                    NS_LOG_ERROR("[Attack - PACKET_DROP_IN_TIME]: Dropped packet " << packetID << " where the next hop was "
-                                                                                   << toDst.GetNextHop());
-                    dropped_stats->drop_count[precur_node] += 1;
-                    return false;
-                }
-                break;
-            }
-            case PACKET_DROP_SELECT:{
-                ////randomly drop packets a certain percent of the time - but otherwise act normally.
-                NS_LOG_ERROR("Strategy PACKET_DROP_SELECT selected");
-                if (dropPacketsFromNodes[precur_node] && p->GetSize() > 400) {
-                    NS_LOG_ERROR("[Attack - PACKET_DROP_SELECT]: Dropped packet " << packetID
-                                                                                  << " where the next hop was "
-                                                                                  << toDst.GetNextHop()
-                                                                                  << " and the precursor was:"
-                                                                                  << precur_node);
-                    dropped_stats->drop_count[precur_node] += 1;
-                    return false;
-                }
-                break;
-            }
-            case NO_A_OPERATION:{
-                // Do Nothing
-                NS_LOG_INFO("Strategy NO-OP selected");
-                break;
-            }
+                return silent;
             }
 
             if(p->GetSize() > 400)
-                NS_LOG_ERROR ("forwarding packet ID: " << packetID << " ttl: " << unsigned(header.GetTtl()) << " to " << dst
-                                                      << " from " << origin << " via " << toDst.GetNextHop());
+                GREYATTACKAODV_LOG_ATTACK("forwarding packet ID: " << header.GetIdentification() << " ttl: " << unsigned(header.GetTtl()) << " to " << dst
+                                                                   << " from " << origin << " via " << toDst->GetNextHop());
 
             ucb(route, p, header);
             return true;
         }
         else
         {
-            if (toDst.GetValidSeqNo())
+            if (toDst->GetValidSeqNo())
             {
-                SendRerrWhenNoRouteToForward(dst, toDst.GetSeqNo(), origin);
+                SendRerrWhenNoRouteToForward(dst, toDst->GetSeqNo(), origin);
                 NS_LOG_DEBUG("Drop packet " << p->GetUid() << " because no route to forward it.");
                 return false;
             }
@@ -946,22 +780,22 @@ RoutingProtocol::NotifyInterfaceUp(uint32_t i)
     // Create a socket to listen only on this interface
     Ptr<Socket> socket = Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
     NS_ASSERT(socket);
-    socket->SetRecvCallback(MakeCallback(&RoutingProtocol::Recvgreyattack_aodv, this));
+    socket->SetRecvCallback(MakeCallback(&RoutingProtocol::Recvgreyattack_aodv, this).Bind(i));
     socket->BindToNetDevice(l3->GetNetDevice(i));
     socket->Bind(InetSocketAddress(iface.GetLocal(), greyattack_aodv_PORT));
     socket->SetAllowBroadcast(true);
     socket->SetIpRecvTtl(true);
-    m_socketAddresses.insert(std::make_pair(socket, iface));
+    Ptr<Socket> unicastSocket = socket;
 
     // create also a subnet broadcast socket
     socket = Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
     NS_ASSERT(socket);
-    socket->SetRecvCallback(MakeCallback(&RoutingProtocol::Recvgreyattack_aodv, this));
+    socket->SetRecvCallback(MakeCallback(&RoutingProtocol::Recvgreyattack_aodv, this).Bind(i));
     socket->BindToNetDevice(l3->GetNetDevice(i));
     socket->Bind(InetSocketAddress(iface.GetBroadcast(), greyattack_aodv_PORT));
     socket->SetAllowBroadcast(true);
     socket->SetIpRecvTtl(true);
-    m_socketSubnetBroadcastAddresses.insert(std::make_pair(socket, iface));
+    SetInterfaceSockets(i, unicastSocket, socket, iface);
 
     // Add local broadcast record to the routing table
     Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(iface.GetLocal()));
@@ -1022,19 +856,13 @@ RoutingProtocol::NotifyInterfaceDown(uint32_t i)
         }
     }
 
-    // Close socket
-    Ptr<Socket> socket = FindSocketWithInterfaceAddress(m_ipv4->GetAddress(i, 0));
-    NS_ASSERT(socket);
-    socket->Close();
-    m_socketAddresses.erase(socket);
-
-    // Close socket
-    socket = FindSubnetBroadcastSocketWithInterfaceAddress(m_ipv4->GetAddress(i, 0));
-    NS_ASSERT(socket);
-    socket->Close();
-    m_socketSubnetBroadcastAddresses.erase(socket);
+    // Close sockets
+    NS_ASSERT(i < m_interfaceSockets.size() && m_interfaceSockets[i].socket);
+    m_interfaceSockets[i].socket->Close();
+    m_interfaceSockets[i].broadcastSocket->Close();
+    SetInterfaceSockets(i, nullptr, nullptr, Ipv4InterfaceAddress());
 
-    if (m_socketAddresses.empty())
+    if (m_interfaces.empty())
     {
         NS_LOG_LOGIC("No greyattackaodv interfaces");
         m_htimer.Cancel();
@@ -1049,6 +877,8 @@ void
 RoutingProtocol::NotifyAddAddress(uint32_t i, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this << " interface " << i << " address " << address);
+    Ipv4NodeIndex::Invalidate();
+    Mac48NodeIndex::Invalidate();
     Ptr<Ipv4L3Protocol> l3 = m_ipv4->GetObject<Ipv4L3Protocol>();
     if (!l3->IsUp(i))
     {
@@ -1068,21 +898,23 @@ RoutingProtocol::NotifyAddAddress(uint32_t i, Ipv4InterfaceAddress address)
             Ptr<Socket> socket =
                 Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
             NS_ASSERT(socket);
-            socket->SetRecvCallback(MakeCallback(&RoutingProtocol::Recvgreyattack_aodv, this));
+            socket->SetRecvCallback(
+                MakeCallback(&RoutingProtocol::Recvgreyattack_aodv, this).Bind(i));
             socket->BindToNetDevice(l3->GetNetDevice(i));
             socket->Bind(InetSocketAddress(iface.GetLocal(), greyattack_aodv_PORT));
             socket->SetAllowBroadcast(true);
-            m_socketAddresses.insert(std::make_pair(socket, iface));
+            Ptr<Socket> unicastSocket = socket;
 
             // create also a subnet directed broadcast socket
             socket = Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
             NS_ASSERT(socket);
-            socket->SetRecvCallback(MakeCallback(&RoutingProtocol::Recvgreyattack_aodv, this));
+            socket->SetRecvCallback(
+                MakeCallback(&RoutingProtocol::Recvgreyattack_aodv, this).Bind(i));
             socket->BindToNetDevice(l3->GetNetDevice(i));
             socket->Bind(InetSocketAddress(iface.GetBroadcast(), greyattack_aodv_PORT));
             socket->SetAllowBroadcast(true);
             socket->SetIpRecvTtl(true);
-            m_socketSubnetBroadcastAddresses.insert(std::make_pair(socket, iface));
+            SetInterfaceSockets(i, unicastSocket, socket, iface);
 
             // Add local broadcast record to the routing table
             Ptr<NetDevice> dev =
@@ -1109,19 +941,14 @@ void
 RoutingProtocol::NotifyRemoveAddress(uint32_t i, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this);
+    Ipv4NodeIndex::Invalidate();
     Ptr<Socket> socket = FindSocketWithInterfaceAddress(address);
     if (socket)
     {
         m_routingTable.DeleteAllRoutesFromInterface(address);
         socket->Close();
-        m_socketAddresses.erase(socket);
-
-        Ptr<Socket> unicastSocket = FindSubnetBroadcastSocketWithInterfaceAddress(address);
-        if (unicastSocket)
-        {
-            unicastSocket->Close();
-            m_socketAddresses.erase(unicastSocket);
-        }
+        m_interfaceSockets[i].broadcastSocket->Close();
+        SetInterfaceSockets(i, nullptr, nullptr, Ipv4InterfaceAddress());
 
         Ptr<Ipv4L3Protocol> l3 = m_ipv4->GetObject<Ipv4L3Protocol>();
         if (l3->GetNAddresses(i))
@@ -1131,23 +958,25 @@ RoutingProtocol::NotifyRemoveAddress(uint32_t i, Ipv4InterfaceAddress address)
             Ptr<Socket> socket =
                 Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
             NS_ASSERT(socket);
-            socket->SetRecvCallback(MakeCallback(&RoutingProtocol::Recvgreyattack_aodv, this));
+            socket->SetRecvCallback(
+                MakeCallback(&RoutingProtocol::Recvgreyattack_aodv, this).Bind(i));
             // Bind to any IP address so that broadcasts can be received
             socket->BindToNetDevice(l3->GetNetDevice(i));
             socket->Bind(InetSocketAddress(iface.GetLocal(), greyattack_aodv_PORT));
             socket->SetAllowBroadcast(true);
             socket->SetIpRecvTtl(true);
-            m_socketAddresses.insert(std::make_pair(socket, iface));
+            Ptr<Socket> unicastSocket = socket;
 
             // create also a unicast socket
             socket = Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
             NS_ASSERT(socket);
-            socket->SetRecvCallback(MakeCallback(&RoutingProtocol::Recvgreyattack_aodv, this));
+            socket->SetRecvCallback(
+                MakeCallback(&RoutingProtocol::Recvgreyattack_aodv, this).Bind(i));
             socket->BindToNetDevice(l3->GetNetDevice(i));
             socket->Bind(InetSocketAddress(iface.GetBroadcast(), greyattack_aodv_PORT));
             socket->SetAllowBroadcast(true);
             socket->SetIpRecvTtl(true);
-            m_socketSubnetBroadcastAddresses.insert(std::make_pair(socket, iface));
+            SetInterfaceSockets(i, unicastSocket, socket, iface);
 
             // Add local broadcast record to the routing table
             Ptr<NetDevice> dev =
@@ -1162,7 +991,7 @@ RoutingProtocol::NotifyRemoveAddress(uint32_t i, Ipv4InterfaceAddress address)
                                  /*lifetime=*/Simulator::GetMaximumSimulationTime());
             m_routingTable.AddRoute(rt);
         }
-        if (m_socketAddresses.empty())
+        if (m_interfaces.empty())
         {
             NS_LOG_LOGIC("No greyattackaodv interfaces");
             m_htimer.Cancel();
@@ -1181,9 +1010,9 @@ bool
 RoutingProtocol::IsMyOwnAddress(Ipv4Address src)
 {
     NS_LOG_FUNCTION(this << src);
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+    for (auto interface : m_interfaces)
     {
-        Ipv4InterfaceAddress iface = j->second;
+        Ipv4InterfaceAddress iface = m_interfaceSockets[interface].address;
         if (src == iface.GetLocal())
         {
             return true;
@@ -1215,24 +1044,21 @@ RoutingProtocol::LoopbackRoute(const Ipv4Header& hdr, Ptr<NetDevice> oif) const
     // If RouteOutput() caller specified an outgoing interface, that
     // further constrains the selection of source address
     //
-    auto j = m_socketAddresses.begin();
     if (oif)
     {
         // Iterate to find an address on the oif device
-        for (j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+        for (auto interface : m_interfaces)
         {
-            Ipv4Address addr = j->second.GetLocal();
-            int32_t interface = m_ipv4->GetInterfaceForAddress(addr);
-            if (oif == m_ipv4->GetNetDevice(static_cast<uint32_t>(interface)))
+            if (oif == m_ipv4->GetNetDevice(interface))
             {
-                rt->SetSource(addr);
+                rt->SetSource(m_interfaceSockets[interface].address.GetLocal());
                 break;
             }
         }
     }
-    else
+    else if (!m_interfaces.empty())
     {
-        rt->SetSource(j->second.GetLocal());
+        rt->SetSource(m_interfaceSockets[m_interfaces.front()].address.GetLocal());
     }
     NS_ASSERT_MSG(rt->GetSource() != Ipv4Address(), "Valid greyattackaodv source address not found");
     rt->SetGateway(Ipv4Address("127.0.0.1"));
@@ -1245,18 +1071,19 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
 {
     NS_LOG_FUNCTION(this << dst);
     // A node SHOULD NOT originate more than RREQ_RATELIMIT RREQ messages per second.
-    if (m_rreqCount == m_rreqRateLimit)
+    if (!m_rreqLimiter.TryAcquire(m_rreqRateLimit))
     {
-        Simulator::Schedule(m_rreqRateLimitTimer.GetDelayLeft() + MicroSeconds(100),
-                            &RoutingProtocol::SendRequest,
-                            this,
-                            dst);
+        if (m_rreqPendingSet.Insert(dst, true).second)
+        {
+            m_rreqPending.push_back(dst);
+        }
+        if (!m_rreqPendingTimer.IsRunning())
+        {
+            m_rreqPendingTimer.Schedule(m_rreqLimiter.GetDelayLeft() + MicroSeconds(100));
+        }
         return;
     }
-    else
-    {
-        m_rreqCount++;
-    }
+    m_rreqPendingSet.Erase(dst);
     // Create RREQ header
     RreqHeader rreqHeader;
     rreqHeader.SetDst(dst);
@@ -1331,10 +1158,10 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
     rreqHeader.SetId(m_requestId);
 
     // Send RREQ as subnet directed broadcast from each interface used by greyattackaodv
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+    for (auto interface : m_interfaces)
     {
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
+        Ptr<Socket> socket = m_interfaceSockets[interface].socket;
+        Ipv4InterfaceAddress iface = m_interfaceSockets[interface].address;
 
         rreqHeader.SetOrigin(iface.GetLocal());
         m_rreqIdCache.IsDuplicate(iface.GetLocal(), m_requestId);
@@ -1405,28 +1232,18 @@ RoutingProtocol::ScheduleRreqRetry(Ipv4Address dst)
 }
 
 void
-RoutingProtocol::Recvgreyattack_aodv(Ptr<Socket> socket)
+RoutingProtocol::Recvgreyattack_aodv(uint32_t interface, Ptr<Socket> socket)
 {
-    NS_LOG_FUNCTION(this << socket);
+    NS_LOG_FUNCTION(this << interface << socket);
     Address sourceAddress;
     Ptr<Packet> packet = socket->RecvFrom(sourceAddress);
     InetSocketAddress inetSourceAddr = InetSocketAddress::ConvertFrom(sourceAddress);
     Ipv4Address sender = inetSourceAddr.GetIpv4();
-    Ipv4Address receiver;
-
-    if (m_socketAddresses.find(socket) != m_socketAddresses.end())
-    {
-        receiver = m_socketAddresses[socket].GetLocal();
-    }
-    else if (m_socketSubnetBroadcastAddresses.find(socket) !=
-             m_socketSubnetBroadcastAddresses.end())
-    {
-        receiver = m_socketSubnetBroadcastAddresses[socket].GetLocal();
-    }
-    else
-    {
-        NS_ASSERT_MSG(false, "Received a packet from an unknown socket");
-    }
+    NS_ASSERT_MSG(interface < m_interfaceSockets.size() &&
+                      (m_interfaceSockets[interface].socket == socket ||
+                       m_interfaceSockets[interface].broadcastSocket == socket),
+                  "Received a packet from an unknown socket");
+    Ipv4Address receiver = m_interfaceSockets[interface].address.GetLocal();
     NS_LOG_DEBUG("greyattackaodv node " << this << " received a greyattackaodv packet from " << sender << " to "
                               << receiver);
 
@@ -1464,27 +1281,28 @@ bool
 RoutingProtocol::UpdateRouteLifeTime(Ipv4Address addr, Time lifetime)
 {
     NS_LOG_FUNCTION(this << addr << lifetime);
-    RoutingTableEntry rt;
-    if (m_routingTable.LookupRoute(addr, rt))
-    {
-        if (rt.GetFlag() == VALID)
+    bool updated = m_routingTable.WithRoute(addr, [lifetime](RoutingTableEntry& rt) {
+        if (rt.GetFlag() != VALID)
         {
-            NS_LOG_DEBUG("Updating VALID route");
-            rt.SetRreqCnt(0);
-            rt.SetLifeTime(std::max(lifetime, rt.GetLifeTime()));
-            m_routingTable.Update(rt);
-            return true;
+            return false;
         }
+        rt.SetRreqCnt(0);
+        rt.SetLifeTime(std::max(lifetime, rt.GetLifeTime()));
+        return true;
+    });
+    if (updated)
+    {
+        NS_LOG_DEBUG("Updated VALID route");
     }
-    return false;
+    return updated;
 }
 
 void
 RoutingProtocol::UpdateRouteToNeighbor(Ipv4Address sender, Ipv4Address receiver)
 {
     NS_LOG_FUNCTION(this << "sender " << sender << " receiver " << receiver);
-    RoutingTableEntry toNeighbor;
-    if (!m_routingTable.LookupRoute(sender, toNeighbor))
+    const RoutingTableEntry* toNeighbor = m_routingTable.FindEntry(sender);
+    if (!toNeighbor)
     {
         Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
         RoutingTableEntry newEntry(
@@ -1501,12 +1319,9 @@ RoutingProtocol::UpdateRouteToNeighbor(Ipv4Address sender, Ipv4Address receiver)
     else
     {
         Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
-        if (toNeighbor.GetValidSeqNo() && (toNeighbor.GetHop() == 1) &&
-            (toNeighbor.GetOutputDevice() == dev))
-        {
-            toNeighbor.SetLifeTime(std::max(m_activeRouteTimeout, toNeighbor.GetLifeTime()));
-        }
-        else
+        // A valid one-hop route through dev is left as it is
+        if (!toNeighbor->GetValidSeqNo() || (toNeighbor->GetHop() != 1) ||
+            (toNeighbor->GetOutputDevice() != dev))
         {
             RoutingTableEntry newEntry(
                 /*dev=*/dev,
@@ -1516,7 +1331,7 @@ RoutingProtocol::UpdateRouteToNeighbor(Ipv4Address sender, Ipv4Address receiver)
                 /*iface=*/m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0),
                 /*hops=*/1,
                 /*nextHop=*/sender,
-                /*lifetime=*/std::max(m_activeRouteTimeout, toNeighbor.GetLifeTime()));
+                /*lifetime=*/std::max(m_activeRouteTimeout, toNeighbor->GetLifeTime()));
             m_routingTable.Update(newEntry);
         }
     }
@@ -1530,10 +1345,10 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
     p->RemoveHeader(rreqHeader);
 
     // A node ignores all RREQs received from any node in its blacklist
-    RoutingTableEntry toPrev;
-    if (m_routingTable.LookupRoute(src, toPrev))
+    const RoutingTableEntry* toPrev = m_routingTable.FindEntry(src);
+    if (toPrev)
     {
-        if (toPrev.IsUnidirectional())
+        if (toPrev->IsUnidirectional())
         {
             NS_LOG_DEBUG("Ignoring RREQ from node in blacklist");
             return;
@@ -1569,23 +1384,9 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
      *  5. the Lifetime is set to be the maximum of (ExistingLifetime, MinimalLifetime), where
      *     MinimalLifetime = current time + 2*NetTraversalTime - 2*HopCount*NodeTraversalTime
      */
-    RoutingTableEntry toOrigin;
-    if (!m_routingTable.LookupRoute(origin, toOrigin))
-    {
-        Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
-        RoutingTableEntry newEntry(
-            /*dev=*/dev,
-            /*dst=*/origin,
-            /*vSeqNo=*/true,
-            /*seqNo=*/rreqHeader.GetOriginSeqno(),
-            /*iface=*/m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0),
-            /*hops=*/hop,
-            /*nextHop=*/src,
-            /*lifetime=*/Time((2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime)));
-        m_routingTable.AddRoute(newEntry);
-    }
-    else
-    {
+    Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
+    Ipv4InterfaceAddress iface = m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0);
+    bool toOriginUpdated = m_routingTable.WithRoute(origin, [&](RoutingTableEntry& toOrigin) {
         if (toOrigin.GetValidSeqNo())
         {
             if (int32_t(rreqHeader.GetOriginSeqno()) - int32_t(toOrigin.GetSeqNo()) > 0)
@@ -1599,42 +1400,52 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
         }
         toOrigin.SetValidSeqNo(true);
         toOrigin.SetNextHop(src);
-        toOrigin.SetOutputDevice(m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver)));
-        toOrigin.SetInterface(m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0));
+        toOrigin.SetOutputDevice(dev);
+        toOrigin.SetInterface(iface);
         toOrigin.SetHop(hop);
         toOrigin.SetLifeTime(std::max(Time(2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime),
                                       toOrigin.GetLifeTime()));
-        m_routingTable.Update(toOrigin);
         // m_nb.Update (src, Time (AllowedHelloLoss * HelloInterval));
+        return true;
+    });
+    if (!toOriginUpdated)
+    {
+        RoutingTableEntry newEntry(
+            /*dev=*/dev,
+            /*dst=*/origin,
+            /*vSeqNo=*/true,
+            /*seqNo=*/rreqHeader.GetOriginSeqno(),
+            /*iface=*/iface,
+            /*hops=*/hop,
+            /*nextHop=*/src,
+            /*lifetime=*/Time((2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime)));
+        m_routingTable.AddRoute(newEntry);
     }
 
-    RoutingTableEntry toNeighbor;
-    if (!m_routingTable.LookupRoute(src, toNeighbor))
+    bool toNeighborUpdated = m_routingTable.WithRoute(src, [&](RoutingTableEntry& toNeighbor) {
+        toNeighbor.SetLifeTime(m_activeRouteTimeout);
+        toNeighbor.SetValidSeqNo(false);
+        toNeighbor.SetSeqNo(rreqHeader.GetOriginSeqno());
+        toNeighbor.SetFlag(VALID);
+        toNeighbor.SetOutputDevice(dev);
+        toNeighbor.SetInterface(iface);
+        toNeighbor.SetHop(1);
+        toNeighbor.SetNextHop(src);
+        return true;
+    });
+    if (!toNeighborUpdated)
     {
         NS_LOG_DEBUG("Neighbor:" << src << " not found in routing table. Creating an entry");
-        Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
         RoutingTableEntry newEntry(dev,
                                    src,
                                    false,
                                    rreqHeader.GetOriginSeqno(),
-                                   m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0),
+                                   iface,
                                    1,
                                    src,
                                    m_activeRouteTimeout);
         m_routingTable.AddRoute(newEntry);
     }
-    else
-    {
-        toNeighbor.SetLifeTime(m_activeRouteTimeout);
-        toNeighbor.SetValidSeqNo(false);
-        toNeighbor.SetSeqNo(rreqHeader.GetOriginSeqno());
-        toNeighbor.SetFlag(VALID);
-        toNeighbor.SetOutputDevice(m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver)));
-        toNeighbor.SetInterface(m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0));
-        toNeighbor.SetHop(1);
-        toNeighbor.SetNextHop(src);
-        m_routingTable.Update(toNeighbor);
-    }
     m_nb.Update(src, Time(m_allowedHelloLoss * m_helloInterval));
 
     NS_LOG_LOGIC(receiver << " receive RREQ with hop count "
@@ -1645,6 +1456,7 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
     //  (i)  it is itself the destination,
     if (IsMyOwnAddress(rreqHeader.GetDst()))
     {
+        RoutingTableEntry toOrigin;
         m_routingTable.LookupRoute(origin, toOrigin);
         NS_LOG_DEBUG("Send reply since I am the destination");
         SendReply(rreqHeader, toOrigin);
@@ -1681,6 +1493,7 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
         {
             if (!rreqHeader.GetDestinationOnly() && toDst.GetFlag() == VALID)
             {
+                RoutingTableEntry toOrigin;
                 m_routingTable.LookupRoute(origin, toOrigin);
                 SendReplyByIntermediateNode(toDst, toOrigin, rreqHeader.GetGratuitousRrep());
                 return;
@@ -1698,10 +1511,10 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
         return;
     }
 
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+    for (auto interface : m_interfaces)
     {
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
+        Ptr<Socket> socket = m_interfaceSockets[interface].socket;
+        Ipv4InterfaceAddress iface = m_interfaceSockets[interface].address;
         Ptr<Packet> packet = Create<Packet>();
         SocketIpTtlTag ttl;
         ttl.SetTtl(tag.GetTtl() - 1);
@@ -1884,33 +1697,35 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
         /*hops=*/hop,
         /*nextHop=*/sender,
         /*lifetime=*/rrepHeader.GetLifeTime());
-    RoutingTableEntry toDst;
-    if (m_routingTable.LookupRoute(dst, toDst))
+    const RoutingTableEntry* toDst = m_routingTable.FindEntry(dst);
+    // Remembered, toDst no longer describes the entry once it is updated
+    bool toDstInSearch = toDst && (toDst->GetFlag() == IN_SEARCH);
+    if (toDst)
     {
         /*
          * The existing entry is updated only in the following circumstances:
          * (i) the sequence number in the routing table is marked as invalid in route table entry.
          */
-        if (!toDst.GetValidSeqNo())
+        if (!toDst->GetValidSeqNo())
         {
             m_routingTable.Update(newEntry);
         }
         // (ii)the Destination Sequence Number in the RREP is greater than the node's copy of the
         // destination sequence number and the known value is valid,
-        else if ((int32_t(rrepHeader.GetDstSeqno()) - int32_t(toDst.GetSeqNo())) > 0)
+        else if ((int32_t(rrepHeader.GetDstSeqno()) - int32_t(toDst->GetSeqNo())) > 0)
         {
             m_routingTable.Update(newEntry);
         }
         else
         {
             // (iii) the sequence numbers are the same, but the route is marked as inactive.
-            if ((rrepHeader.GetDstSeqno() == toDst.GetSeqNo()) && (toDst.GetFlag() != VALID))
+            if ((rrepHeader.GetDstSeqno() == toDst->GetSeqNo()) && (toDst->GetFlag() != VALID))
             {
                 m_routingTable.Update(newEntry);
             }
             // (iv)  the sequence numbers are the same, and the New Hop Count is smaller than the
             // hop count in route table entry.
-            else if ((rrepHeader.GetDstSeqno() == toDst.GetSeqNo()) && (hop < toDst.GetHop()))
+            else if ((rrepHeader.GetDstSeqno() == toDst->GetSeqNo()) && (hop < toDst->GetHop()))
             {
                 m_routingTable.Update(newEntry);
             }
@@ -1931,45 +1746,50 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
     NS_LOG_LOGIC("receiver " << receiver << " origin " << rrepHeader.GetOrigin());
     if (IsMyOwnAddress(rrepHeader.GetOrigin()))
     {
-        if (toDst.GetFlag() == IN_SEARCH)
+        if (toDstInSearch)
         {
             m_routingTable.Update(newEntry);
             m_addressReqTimer[dst].Cancel();
             m_addressReqTimer.erase(dst);
         }
-        m_routingTable.LookupRoute(dst, toDst);
-        SendPacketFromQueue(dst, toDst.GetRoute());
+        toDst = m_routingTable.FindEntry(dst);
+        NS_ASSERT(toDst);
+        SendPacketFromQueue(dst, toDst->GetRoute());
         return;
     }
 
-    RoutingTableEntry toOrigin;
-    if (!m_routingTable.LookupRoute(rrepHeader.GetOrigin(), toOrigin) ||
-        toOrigin.GetFlag() == IN_SEARCH)
+    Ipv4Address origin = rrepHeader.GetOrigin();
+    bool toOriginActive = m_routingTable.WithRoute(origin, [this](RoutingTableEntry& toOrigin) {
+        if (toOrigin.GetFlag() == IN_SEARCH)
+        {
+            return false;
+        }
+        toOrigin.SetLifeTime(std::max(m_activeRouteTimeout, toOrigin.GetLifeTime()));
+        return true;
+    });
+    if (!toOriginActive)
     {
         return; // Impossible! drop.
     }
-    toOrigin.SetLifeTime(std::max(m_activeRouteTimeout, toOrigin.GetLifeTime()));
-    m_routingTable.Update(toOrigin);
 
     // Update information about precursors
-    if (m_routingTable.LookupValidRoute(rrepHeader.GetDst(), toDst))
-    {
-        toDst.InsertPrecursor(toOrigin.GetNextHop());
-        m_routingTable.Update(toDst);
-
-        RoutingTableEntry toNextHopToDst;
-        m_routingTable.LookupRoute(toDst.GetNextHop(), toNextHopToDst);
-        toNextHopToDst.InsertPrecursor(toOrigin.GetNextHop());
-        m_routingTable.Update(toNextHopToDst);
-
-        toOrigin.InsertPrecursor(toDst.GetNextHop());
-        m_routingTable.Update(toOrigin);
-
-        RoutingTableEntry toNextHopToOrigin;
-        m_routingTable.LookupRoute(toOrigin.GetNextHop(), toNextHopToOrigin);
-        toNextHopToOrigin.InsertPrecursor(toDst.GetNextHop());
-        m_routingTable.Update(toNextHopToOrigin);
-    }
+    toDst = m_routingTable.FindEntry(dst);
+    if (toDst && toDst->GetFlag() == VALID)
+    {
+        Ipv4Address dstNextHop = toDst->GetNextHop();
+        Ipv4Address originNextHop = m_routingTable.FindEntry(origin)->GetNextHop();
+        auto insertPrecursor = [](Ipv4Address precursor) {
+            return [precursor](RoutingTableEntry& rt) {
+                rt.InsertPrecursor(precursor);
+                return true;
+            };
+        };
+        m_routingTable.WithRoute(dst, insertPrecursor(originNextHop));
+        m_routingTable.WithRoute(dstNextHop, insertPrecursor(originNextHop));
+        m_routingTable.WithRoute(origin, insertPrecursor(dstNextHop));
+        m_routingTable.WithRoute(originNextHop, insertPrecursor(dstNextHop));
+    }
+    const RoutingTableEntry* toOrigin = m_routingTable.FindEntry(origin);
     SocketIpTtlTag tag;
     p->RemovePacketTag(tag);
     if (tag.GetTtl() < 2)
@@ -1986,9 +1806,9 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
     packet->AddHeader(rrepHeader);
     TypeHeader tHeader(greyattack_aodvTYPE_RREP);
     packet->AddHeader(tHeader);
-    Ptr<Socket> socket = FindSocketWithInterfaceAddress(toOrigin.GetInterface());
+    Ptr<Socket> socket = FindSocketWithInterfaceAddress(toOrigin->GetInterface());
     NS_ASSERT(socket);
-    socket->SendTo(packet, 0, InetSocketAddress(toOrigin.GetNextHop(), greyattack_aodv_PORT));
+    socket->SendTo(packet, 0, InetSocketAddress(toOrigin->GetNextHop(), greyattack_aodv_PORT));
 }
 
 void
@@ -2073,14 +1893,7 @@ RoutingProtocol::RecvError(Ptr<Packet> p, Ipv4Address src)
     {
         if (!rerrHeader.AddUnDestination(i->first, i->second))
         {
-            TypeHeader typeHeader(greyattack_aodvTYPE_RERR);
-            Ptr<Packet> packet = Create<Packet>();
-            SocketIpTtlTag tag;
-            tag.SetTtl(1);
-            packet->AddPacketTag(tag);
-            packet->AddHeader(rerrHeader);
-            packet->AddHeader(typeHeader);
-            SendRerrMessage(packet, precursors);
+            QueueRerr(rerrHeader, precursors);
             rerrHeader.Clear();
         }
         else
@@ -2093,14 +1906,7 @@ RoutingProtocol::RecvError(Ptr<Packet> p, Ipv4Address src)
     }
     if (rerrHeader.GetDestCount() != 0)
     {
-        TypeHeader typeHeader(greyattack_aodvTYPE_RERR);
-        Ptr<Packet> packet = Create<Packet>();
-        SocketIpTtlTag tag;
-        tag.SetTtl(1);
-        packet->AddPacketTag(tag);
-        packet->AddHeader(rerrHeader);
-        packet->AddHeader(typeHeader);
-        SendRerrMessage(packet, precursors);
+        QueueRerr(rerrHeader, precursors);
     }
     m_routingTable.InvalidateRoutesWithDst(unreachable);
 }
@@ -2169,19 +1975,23 @@ RoutingProtocol::HelloTimerExpire()
 }
 
 void
-RoutingProtocol::RreqRateLimitTimerExpire()
+RoutingProtocol::SendPendingRequests()
 {
     NS_LOG_FUNCTION(this);
-    m_rreqCount = 0;
-    m_rreqRateLimitTimer.Schedule(Seconds(1));
-}
-
-void
-RoutingProtocol::RerrRateLimitTimerExpire()
-{
-    NS_LOG_FUNCTION(this);
-    m_rerrCount = 0;
-    m_rerrRateLimitTimer.Schedule(Seconds(1));
+    while (!m_rreqPending.empty() && m_rreqLimiter.IsAvailable(m_rreqRateLimit))
+    {
+        Ipv4Address dst = m_rreqPending.front();
+        m_rreqPending.pop_front();
+        // Destinations served since they were queued are no longer in the set
+        if (m_rreqPendingSet.Erase(dst))
+        {
+            SendRequest(dst);
+        }
+    }
+    if (!m_rreqPending.empty())
+    {
+        m_rreqPendingTimer.Schedule(m_rreqLimiter.GetDelayLeft() + MicroSeconds(100));
+    }
 }
 
 void
@@ -2201,10 +2011,10 @@ RoutingProtocol::SendHello()
      *   Hop Count                      0
      *   Lifetime                       AllowedHelloLoss * HelloInterval
      */
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+    for (auto interface : m_interfaces)
     {
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
+        Ptr<Socket> socket = m_interfaceSockets[interface].socket;
+        Ipv4InterfaceAddress iface = m_interfaceSockets[interface].address;
         RrepHeader helloHeader(/*prefixSize=*/0,
                                /*hopCount=*/0,
                                /*dst=*/iface.GetLocal(),
@@ -2229,7 +2039,21 @@ RoutingProtocol::SendHello()
             destination = iface.GetBroadcast();
         }
         Time jitter = Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10)));
-        Simulator::Schedule(jitter, &RoutingProtocol::SendTo, this, socket, packet, destination);
+        if (m_timerWheel)
+        {
+            m_timerWheel->Schedule(
+                jitter,
+                MakeCallback(&RoutingProtocol::SendTo, this).Bind(socket, packet, destination));
+        }
+        else
+        {
+            Simulator::Schedule(jitter,
+                                &RoutingProtocol::SendTo,
+                                this,
+                                socket,
+                                packet,
+                                destination);
+        }
     }
 }
 
@@ -2237,16 +2061,15 @@ void
 RoutingProtocol::SendPacketFromQueue(Ipv4Address dst, Ptr<Ipv4Route> route)
 {
     NS_LOG_FUNCTION(this);
-    QueueEntry queueEntry;
-    while (m_queue.Dequeue(dst, queueEntry))
-    {
+    int32_t routeInterface = m_ipv4->GetInterfaceForDevice(route->GetOutputDevice());
+    uint32_t n = m_queue.DequeueAll(dst, [this, route, routeInterface](QueueEntry& queueEntry) {
         DeferredRouteOutputTag tag;
         Ptr<Packet> p = ConstCast<Packet>(queueEntry.GetPacket());
         if (p->RemovePacketTag(tag) && tag.GetInterface() != -1 &&
-            tag.GetInterface() != m_ipv4->GetInterfaceForDevice(route->GetOutputDevice()))
+            tag.GetInterface() != routeInterface)
         {
             NS_LOG_DEBUG("Output device doesn't match. Dropped.");
-            return;
+            return false;
         }
         UnicastForwardCallback ucb = queueEntry.GetUnicastForwardCallback();
         Ipv4Header header = queueEntry.GetIpv4Header();
@@ -2254,7 +2077,9 @@ RoutingProtocol::SendPacketFromQueue(Ipv4Address dst, Ptr<Ipv4Route> route)
         header.SetTtl(header.GetTtl() +
                       1); // compensate extra TTL decrement by fake loopback routing
         ucb(route, p, header);
-    }
+        return true;
+    });
+    NS_LOG_DEBUG("Released " << n << " queued packets to " << dst);
 }
 
 void
@@ -2278,14 +2103,7 @@ RoutingProtocol::SendRerrWhenBreaksLinkToNextHop(Ipv4Address nextHop)
         if (!rerrHeader.AddUnDestination(i->first, i->second))
         {
             NS_LOG_LOGIC("Send RERR message with maximum size.");
-            TypeHeader typeHeader(greyattack_aodvTYPE_RERR);
-            Ptr<Packet> packet = Create<Packet>();
-            SocketIpTtlTag tag;
-            tag.SetTtl(1);
-            packet->AddPacketTag(tag);
-            packet->AddHeader(rerrHeader);
-            packet->AddHeader(typeHeader);
-            SendRerrMessage(packet, precursors);
+            QueueRerr(rerrHeader, precursors);
             rerrHeader.Clear();
         }
         else
@@ -2298,14 +2116,7 @@ RoutingProtocol::SendRerrWhenBreaksLinkToNextHop(Ipv4Address nextHop)
     }
     if (rerrHeader.GetDestCount() != 0)
     {
-        TypeHeader typeHeader(greyattack_aodvTYPE_RERR);
-        Ptr<Packet> packet = Create<Packet>();
-        SocketIpTtlTag tag;
-        tag.SetTtl(1);
-        packet->AddPacketTag(tag);
-        packet->AddHeader(rerrHeader);
-        packet->AddHeader(typeHeader);
-        SendRerrMessage(packet, precursors);
+        QueueRerr(rerrHeader, precursors);
     }
     unreachable.insert(std::make_pair(nextHop, toNextHop.GetSeqNo()));
     m_routingTable.InvalidateRoutesWithDst(unreachable);
@@ -2318,26 +2129,37 @@ RoutingProtocol::SendRerrWhenNoRouteToForward(Ipv4Address dst,
 {
     NS_LOG_FUNCTION(this);
     // A node SHOULD NOT originate more than RERR_RATELIMIT RERR messages per second.
-    if (m_rerrCount == m_rerrRateLimit)
+    if (!m_rerrLimiter.IsAvailable(m_rerrRateLimit))
     {
-        // Just make sure that the RerrRateLimit timer is running and will expire
-        NS_ASSERT(m_rerrRateLimitTimer.IsRunning());
         // discard the packet and return
         NS_LOG_LOGIC("RerrRateLimit reached at "
-                     << Simulator::Now().As(Time::S) << " with timer delay left "
-                     << m_rerrRateLimitTimer.GetDelayLeft().As(Time::S) << "; suppressing RERR");
+                     << Simulator::Now().As(Time::S) << " with refill delay left "
+                     << m_rerrLimiter.GetDelayLeft().As(Time::S) << "; suppressing RERR");
         return;
     }
     RerrHeader rerrHeader;
     rerrHeader.AddUnDestination(dst, dstSeqNo);
     RoutingTableEntry toOrigin;
+    bool toOriginValid = m_routingTable.LookupValidRoute(origin, toOrigin);
+    if (!m_rerrCoalescingWindow.IsZero())
+    {
+        // The next hop towards the origin is the precursor of the unicast RERR
+        std::vector<Ipv4Address> precursors;
+        if (toOriginValid)
+        {
+            precursors.push_back(toOrigin.GetNextHop());
+        }
+        QueueRerr(rerrHeader, precursors);
+        m_pendingRerrBroadcast |= !toOriginValid;
+        return;
+    }
     Ptr<Packet> packet = Create<Packet>();
     SocketIpTtlTag tag;
     tag.SetTtl(1);
     packet->AddPacketTag(tag);
     packet->AddHeader(rerrHeader);
     packet->AddHeader(TypeHeader(greyattack_aodvTYPE_RERR));
-    if (m_routingTable.LookupValidRoute(origin, toOrigin))
+    if (toOriginValid)
     {
         Ptr<Socket> socket = FindSocketWithInterfaceAddress(toOrigin.GetInterface());
         NS_ASSERT(socket);
@@ -2346,24 +2168,101 @@ RoutingProtocol::SendRerrWhenNoRouteToForward(Ipv4Address dst,
     }
     else
     {
-        for (auto i = m_socketAddresses.begin(); i != m_socketAddresses.end(); ++i)
+        BroadcastRerr(packet);
+    }
+}
+
+void
+RoutingProtocol::BroadcastRerr(Ptr<Packet> packet)
+{
+    NS_LOG_FUNCTION(this);
+    for (auto interface : m_interfaces)
+    {
+        Ptr<Socket> socket = m_interfaceSockets[interface].socket;
+        Ipv4InterfaceAddress iface = m_interfaceSockets[interface].address;
+        NS_ASSERT(socket);
+        NS_LOG_LOGIC("Broadcast RERR message from interface " << iface.GetLocal());
+        // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+        Ipv4Address destination;
+        if (iface.GetMask() == Ipv4Mask::GetOnes())
         {
-            Ptr<Socket> socket = i->first;
-            Ipv4InterfaceAddress iface = i->second;
-            NS_ASSERT(socket);
-            NS_LOG_LOGIC("Broadcast RERR message from interface " << iface.GetLocal());
-            // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
-            Ipv4Address destination;
-            if (iface.GetMask() == Ipv4Mask::GetOnes())
-            {
-                destination = Ipv4Address("255.255.255.255");
-            }
-            else
+            destination = Ipv4Address("255.255.255.255");
+        }
+        else
+        {
+            destination = iface.GetBroadcast();
+        }
+        socket->SendTo(packet->Copy(), 0, InetSocketAddress(destination, greyattack_aodv_PORT));
+    }
+}
+
+void
+RoutingProtocol::QueueRerr(RerrHeader rerrHeader, const std::vector<Ipv4Address>& precursors)
+{
+    NS_LOG_FUNCTION(this);
+    auto mergePrecursors = [this, &precursors]() {
+        for (const auto& precursor : precursors)
+        {
+            if (std::find(m_pendingRerrPrecursors.begin(),
+                          m_pendingRerrPrecursors.end(),
+                          precursor) == m_pendingRerrPrecursors.end())
             {
-                destination = iface.GetBroadcast();
+                m_pendingRerrPrecursors.push_back(precursor);
             }
-            socket->SendTo(packet->Copy(), 0, InetSocketAddress(destination, greyattack_aodv_PORT));
         }
+    };
+    mergePrecursors();
+    std::pair<Ipv4Address, uint32_t> un;
+    while (rerrHeader.RemoveUnDestination(un))
+    {
+        if (m_pendingRerr.GetDestCount() == 255)
+        {
+            // A RERR holds at most 255 destinations
+            FlushRerr();
+            mergePrecursors();
+        }
+        m_pendingRerr.AddUnDestination(un.first, un.second);
+    }
+    if (m_rerrCoalescingWindow.IsZero())
+    {
+        FlushRerr();
+    }
+    else if (!m_rerrCoalescingTimer.IsRunning())
+    {
+        // The window is not extended by later RERRs, so none waits longer than it
+        m_rerrCoalescingTimer.Schedule(m_rerrCoalescingWindow);
+    }
+}
+
+void
+RoutingProtocol::FlushRerr()
+{
+    NS_LOG_FUNCTION(this);
+    m_rerrCoalescingTimer.Cancel();
+    std::vector<Ipv4Address> precursors;
+    precursors.swap(m_pendingRerrPrecursors);
+    bool broadcast = m_pendingRerrBroadcast;
+    m_pendingRerrBroadcast = false;
+    if (m_pendingRerr.GetDestCount() == 0)
+    {
+        return;
+    }
+    TypeHeader typeHeader(greyattack_aodvTYPE_RERR);
+    Ptr<Packet> packet = Create<Packet>();
+    SocketIpTtlTag tag;
+    tag.SetTtl(1);
+    packet->AddPacketTag(tag);
+    packet->AddHeader(m_pendingRerr);
+    packet->AddHeader(typeHeader);
+    m_pendingRerr.Clear();
+    if (!broadcast)
+    {
+        SendRerrMessage(packet, precursors);
+    }
+    else if (m_rerrLimiter.IsAvailable(m_rerrRateLimit))
+    {
+        // A destination had no route back to the data source, tell every neighbor
+        BroadcastRerr(packet);
     }
 }
 
@@ -2378,14 +2277,12 @@ RoutingProtocol::SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> pr
         return;
     }
     // A node SHOULD NOT originate more than RERR_RATELIMIT RERR messages per second.
-    if (m_rerrCount == m_rerrRateLimit)
+    if (!m_rerrLimiter.IsAvailable(m_rerrRateLimit))
     {
-        // Just make sure that the RerrRateLimit timer is running and will expire
-        NS_ASSERT(m_rerrRateLimitTimer.IsRunning());
         // discard the packet and return
         NS_LOG_LOGIC("RerrRateLimit reached at "
-                     << Simulator::Now().As(Time::S) << " with timer delay left "
-                     << m_rerrRateLimitTimer.GetDelayLeft().As(Time::S) << "; suppressing RERR");
+                     << Simulator::Now().As(Time::S) << " with refill delay left "
+                     << m_rerrLimiter.GetDelayLeft().As(Time::S) << "; suppressing RERR");
         return;
     }
     // If there is only one precursor, RERR SHOULD be unicast toward that precursor
@@ -2405,7 +2302,7 @@ RoutingProtocol::SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> pr
                                 socket,
                                 packet,
                                 precursors.front());
-            m_rerrCount++;
+            m_rerrLimiter.TryAcquire(m_rerrRateLimit);
         }
         return;
     }
@@ -2453,10 +2350,10 @@ Ptr<Socket>
 RoutingProtocol::FindSocketWithInterfaceAddress(Ipv4InterfaceAddress addr) const
 {
     NS_LOG_FUNCTION(this << addr);
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+    for (auto interface : m_interfaces)
     {
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
+        Ptr<Socket> socket = m_interfaceSockets[interface].socket;
+        Ipv4InterfaceAddress iface = m_interfaceSockets[interface].address;
         if (iface == addr)
         {
             return socket;
@@ -2470,12 +2367,10 @@ Ptr<Socket>
 RoutingProtocol::FindSubnetBroadcastSocketWithInterfaceAddress(Ipv4InterfaceAddress addr) const
 {
     NS_LOG_FUNCTION(this << addr);
-    for (auto j = m_socketSubnetBroadcastAddresses.begin();
-         j != m_socketSubnetBroadcastAddresses.end();
-         ++j)
+    for (auto interface : m_interfaces)
     {
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
+        Ptr<Socket> socket = m_interfaceSockets[interface].broadcastSocket;
+        Ipv4InterfaceAddress iface = m_interfaceSockets[interface].address;
         if (iface == addr)
         {
             return socket;
@@ -2485,6 +2380,32 @@ RoutingProtocol::FindSubnetBroadcastSocketWithInterfaceAddress(Ipv4InterfaceAddr
     return socket;
 }
 
+void
+RoutingProtocol::SetInterfaceSockets(uint32_t i,
+                                     Ptr<Socket> socket,
+                                     Ptr<Socket> broadcastSocket,
+                                     Ipv4InterfaceAddress iface)
+{
+    NS_LOG_FUNCTION(this << i << iface);
+    if (i >= m_interfaceSockets.size())
+    {
+        m_interfaceSockets.resize(i + 1);
+    }
+    m_interfaceSockets[i].socket = socket;
+    m_interfaceSockets[i].broadcastSocket = broadcastSocket;
+    m_interfaceSockets[i].address = iface;
+    auto it = std::lower_bound(m_interfaces.begin(), m_interfaces.end(), i);
+    bool listed = it != m_interfaces.end() && *it == i;
+    if (socket && !listed)
+    {
+        m_interfaces.insert(it, i);
+    }
+    else if (!socket && listed)
+    {
+        m_interfaces.erase(it);
+    }
+}
+
 void
 RoutingProtocol::DoInitialize()
 {
@@ -2492,57 +2413,22 @@ RoutingProtocol::DoInitialize()
     uint32_t startTime;
     startTime = m_uniformRandomVariable->GetInteger (0, 100);
     NS_LOG_DEBUG ("Starting at time " << startTime << "ms");
+    m_startDelay = MilliSeconds(startTime);
     if (m_enableHello)
     {
         m_htimer.SetFunction (&RoutingProtocol::HelloTimerExpire, this);
-        m_htimer.Schedule (MilliSeconds (startTime));
+        m_htimer.Schedule (m_startDelay);
     }
-    m_DropWindowTimer.SetFunction(&RoutingProtocol::DropWindowAssignDrop, this);
-    m_DropWindowTimer.Schedule(MilliSeconds(startTime));
-    DropWindowDropping = false;
     Ipv4RoutingProtocol::DoInitialize();
-
-    /// Create a grey attack blacklist according to a certain probability
-    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
-    rng->SetAttribute ("Min", DoubleValue (0));
-    rng->SetAttribute ("Max", DoubleValue (1));
-
-    for (uint32_t node = 0; node < num_defending_nodes + num_malicious_nodes + 2; node++) {
-
-        // initialise the vector of dropped stats
-        // to keep a record of the number of dropped packts
-        dropped_stats->drop_count.push_back(0);
-
-        // Get the Drop Select Chance - not used if that strategy is not set
-        if (rng->GetValue() < m_DropSelectChance){
-            dropPacketsFromNodes.push_back(true);
-        }
-        else{
-            dropPacketsFromNodes.push_back(false);
-        }
-    }
 }
 
-void
-RoutingProtocol::DropWindowAssignDrop ()
+bool
+RoutingProtocol::DropForwardedPacket(Ptr<const Packet> p,
+                                     const Ipv4Header& header,
+                                     const RoutingTableEntry& toDst,
+                                     bool& silent)
 {
-    uint32_t dropWindowLength = 5;
-    m_DropWindowTimer.Schedule(Seconds(dropWindowLength));
-    uint32_t this_node = m_ipv4->GetObject<Node> ()->GetId ();
-
-    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
-    rng->SetAttribute ("Min", DoubleValue (0));
-    rng->SetAttribute ("Max", DoubleValue (1));
-
-    double randomDouble = rng->GetValue();
-    if (randomDouble < m_DropWindowChance) {
-        NS_LOG_INFO("Node: " << this_node << " is dropping.");
-        DropWindowDropping = true;
-    }
-    else{
-        NS_LOG_INFO("Node: " << this_node << " is not dropping.");
-        DropWindowDropping = false;
-    }
+    return false;
 }
 
 } // namespace greyattackaodv
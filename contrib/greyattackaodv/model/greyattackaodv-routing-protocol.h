@@ -30,8 +30,10 @@
 #include "greyattackaodv-dpd.h"
 #include "greyattackaodv-neighbor.h"
 #include "greyattackaodv-packet.h"
+#include "greyattackaodv-rate-limiter.h"
 #include "greyattackaodv-rqueue.h"
 #include "greyattackaodv-rtable.h"
+#include "greyattackaodv-timer-wheel.h"
 
 #include "ns3/ipv4-interface.h"
 #include "ns3/ipv4-l3-protocol.h"
@@ -39,8 +41,8 @@
 #include "ns3/node.h"
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/random-variable-stream.h"
-#include "ns3/shared_vars.h"
 
+#include <deque>
 #include <map>
 
 namespace ns3
@@ -55,6 +57,9 @@ namespace greyattackaodv
  * \ingroup greyattackaodv
  *
  * \brief greyattackaodv routing protocol
+ *
+ * This class forwards every packet it has a route for; the grey hole
+ * variant is GreyHoleRoutingProtocol.
  */
 class RoutingProtocol : public Ipv4RoutingProtocol
 {
@@ -194,6 +199,24 @@ class RoutingProtocol : public Ipv4RoutingProtocol
         return m_enableBroadcast;
     }
 
+    /**
+     * Set the routing table storage backend
+     * \param backend the backend
+     */
+    void SetRoutingTableBackend(RoutingTableBackend backend)
+    {
+        m_routingTable.SetBackend(backend);
+    }
+
+    /**
+     * Get the routing table storage backend
+     * \returns the backend
+     */
+    RoutingTableBackend GetRoutingTableBackend() const
+    {
+        return m_routingTable.GetBackend();
+    }
+
     /**
      * Assign a fixed random variable stream number to the random variables
      * used by this model.  Return the number of streams (possibly zero) that
@@ -202,11 +225,59 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param stream first stream index to use
      * \return the number of stream indices assigned by this model
      */
-    int64_t AssignStreams(int64_t stream);
+    virtual int64_t AssignStreams(int64_t stream);
+
+    /**
+     * Run the hello, hello jitter and neighbor purge timers on a wheel, whose
+     * context should be the id of the node.  Must be called before the
+     * protocol starts.
+     *
+     * \param wheel the wheel
+     */
+    void SetTimerWheel(Ptr<TimerWheel> wheel);
+
+    /**
+     * \returns the wheel running the timers, null if each timer uses its own events
+     */
+    Ptr<TimerWheel> GetTimerWheel() const
+    {
+        return m_timerWheel;
+    }
 
   protected:
     void DoInitialize() override;
 
+    /**
+     * Called for each data packet about to be forwarded on a valid route,
+     * after the route lifetimes have been refreshed
+     *
+     * \param p the packet
+     * \param header the IP header
+     * \param toDst the route to the destination
+     * \param [out] silent set to true if the sender must not be notified of a drop
+     * \returns true to drop the packet
+     */
+    virtual bool DropForwardedPacket(Ptr<const Packet> p,
+                                     const Ipv4Header& header,
+                                     const RoutingTableEntry& toDst,
+                                     bool& silent);
+
+    /**
+     * \returns the random delay between DoInitialize() and the first HELLO
+     */
+    Time GetStartDelay() const
+    {
+        return m_startDelay;
+    }
+
+    /**
+     * \returns the IP layer the protocol is installed on
+     */
+    Ptr<Ipv4> GetIpv4() const
+    {
+        return m_ipv4;
+    }
+
   private:
     /**
      * Notify that an MPDU was dropped.
@@ -261,14 +332,25 @@ class RoutingProtocol : public Ipv4RoutingProtocol
                              ///< originated route discovery.
     bool m_enableHello;      ///< Indicates whether a hello messages enable
     bool m_enableBroadcast;  ///< Indicates whether a a broadcast data packets forwarding enable
+    /// Recognize deferred packets on the loopback by their source address instead of a tag
+    bool m_deferredRouteFastPath;
+    /// RERRs are merged during this time before being sent, zero to send them immediately
+    Time m_rerrCoalescingWindow;
 
     /// IP protocol
     Ptr<Ipv4> m_ipv4;
-    /// Raw unicast socket per each IP interface, map socket -> iface address (IP + mask)
-    std::map<Ptr<Socket>, Ipv4InterfaceAddress> m_socketAddresses;
-    /// Raw subnet directed broadcast socket per each IP interface, map socket -> iface address (IP
-    /// + mask)
-    std::map<Ptr<Socket>, Ipv4InterfaceAddress> m_socketSubnetBroadcastAddresses;
+    /// Sockets of an IP interface used by greyattackaodv
+    struct InterfaceSockets
+    {
+        Ptr<Socket> socket;           ///< raw unicast socket
+        Ptr<Socket> broadcastSocket;  ///< raw subnet directed broadcast socket
+        Ipv4InterfaceAddress address; ///< interface address (IP + mask)
+    };
+
+    /// Sockets per IP interface, indexed by interface; interfaces without socket are unused
+    std::vector<InterfaceSockets> m_interfaceSockets;
+    /// Interfaces used by greyattackaodv, in increasing order
+    std::vector<uint32_t> m_interfaces;
     /// Loopback device used to defer RREQ until packet will be fully formed
     Ptr<NetDevice> m_lo;
 
@@ -287,10 +369,10 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     DuplicatePacketDetection m_dpd;
     /// Handle neighbors
     Neighbors m_nb;
-    /// Number of RREQs used for RREQ rate control
-    uint16_t m_rreqCount;
-    /// Number of RERRs used for RERR rate control
-    uint16_t m_rerrCount;
+    /// RREQ rate control
+    RateLimiter m_rreqLimiter;
+    /// RERR rate control
+    RateLimiter m_rerrLimiter;
 
   private:
     /// Start protocol operation
@@ -361,6 +443,18 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \returns the socket associated with the interface
      */
     Ptr<Socket> FindSubnetBroadcastSocketWithInterfaceAddress(Ipv4InterfaceAddress iface) const;
+    /**
+     * Record the sockets of an interface, or forget them if they are null
+     *
+     * \param i the interface index
+     * \param socket the unicast socket
+     * \param broadcastSocket the subnet directed broadcast socket
+     * \param iface the interface address
+     */
+    void SetInterfaceSockets(uint32_t i,
+                             Ptr<Socket> socket,
+                             Ptr<Socket> broadcastSocket,
+                             Ipv4InterfaceAddress iface);
     /**
      * Process hello message
      *
@@ -383,9 +477,10 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     /**
      * Receive and process control packet
+     * \param interface the interface the socket is bound to
      * \param socket input socket
      */
-    void Recvgreyattack_aodv(Ptr<Socket> socket);
+    void Recvgreyattack_aodv(uint32_t interface, Ptr<Socket> socket);
     /**
      * Receive RREQ
      * \param p packet
@@ -455,6 +550,20 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param precursors list of addresses of the visited nodes
      */
     void SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> precursors);
+    /**
+     * Send RERR to the precursors, or merge it into the pending RERR if
+     * RERR coalescing is enabled
+     * \param rerrHeader the unreachable destinations
+     * \param precursors list of addresses of the visited nodes
+     */
+    void QueueRerr(RerrHeader rerrHeader, const std::vector<Ipv4Address>& precursors);
+    /// Send the RERR merged during the coalescing window
+    void FlushRerr();
+    /**
+     * Broadcast RERR from every interface used by greyattackaodv
+     * \param packet the RERR packet
+     */
+    void BroadcastRerr(Ptr<Packet> packet);
     /**
      * Send RERR message when no route to forward input packet. Unicast if there is reverse route to
      * originating node, broadcast otherwise.
@@ -473,22 +582,28 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void SendTo(Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination);
 
-    /// Drop Window Timer - Every t seconds, a function triggers and the window is assigned
-    /// either to be a drop window or a forward window
-    Timer m_DropWindowTimer;
-
     /// Hello timer
-    Timer m_htimer;
+    WheelTimer m_htimer;
+    /// Wheel running the timers, null to use one simulator event per timer
+    Ptr<TimerWheel> m_timerWheel;
     /// Schedule next send of hello message
     void HelloTimerExpire();
-    /// RREQ rate limit timer
-    Timer m_rreqRateLimitTimer;
-    /// Reset RREQ count and schedule RREQ rate limit timer with delay 1 sec.
-    void RreqRateLimitTimerExpire();
-    /// RERR rate limit timer
-    Timer m_rerrRateLimitTimer;
-    /// Reset RERR count and schedule RERR rate limit timer with delay 1 sec.
-    void RerrRateLimitTimerExpire();
+    /// Destinations whose RREQ is delayed by the rate limit, in request order
+    std::deque<Ipv4Address> m_rreqPending;
+    /// Destinations in m_rreqPending that still need a RREQ
+    Ipv4AddressTable<bool> m_rreqPendingSet;
+    /// Fires once RREQ tokens are available again, runs only while RREQs are pending
+    Timer m_rreqPendingTimer;
+    /// Send the pending RREQs the rate limit allows, and wait for the rest
+    void SendPendingRequests();
+    /// Unreachable destinations merged during the RERR coalescing window
+    RerrHeader m_pendingRerr;
+    /// Precursors of the destinations in m_pendingRerr
+    std::vector<Ipv4Address> m_pendingRerrPrecursors;
+    /// m_pendingRerr is to be broadcast on every interface
+    bool m_pendingRerrBroadcast;
+    /// Ends the RERR coalescing window, runs only while a RERR is pending
+    Timer m_rerrCoalescingTimer;
     /// Map IP address + RREQ timer.
     std::map<Ipv4Address, Timer> m_addressReqTimer;
     /**
@@ -504,34 +619,12 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void AckTimerExpire(Ipv4Address neighbor, Time blacklistTimeout);
 
-    ///// THESE ARE WHERE MY FUNCTIONS BEGIN
-    void DropWindowAssignDrop();
-
     /// Provides uniform random variables.
     Ptr<UniformRandomVariable> m_uniformRandomVariable;
     /// Keep track of the last bcast time
     Time m_lastBcastTime;
-
-    //strategy
-    uint32_t m_strat;
-    AttackStratSelect strat;
-
-    // non-configurable attack parameters
-    bool DropWindowDropping;
-    std::vector<bool> dropPacketsFromNodes;
-
-    // My variables for the strategies
-    Ptr<TargetNodes> targetNodes;
-    double m_vPercentDrop;
-    double m_vTConnection;
-    uint32_t m_vTNeighbour;
-    double m_DropWindowChance;
-    double m_DropSelectChance;
-    uint32_t num_defending_nodes;
-    uint32_t num_malicious_nodes;
-
-    // my variables for collecting statistics
-    Ptr<DroppedStats> dropped_stats;
+    /// Random delay before the first HELLO
+    Time m_startDelay;
 };
 
 } // namespace greyattackaodv
@@ -195,7 +195,7 @@ RoutingProtocol::RoutingProtocol()
 
     for(uint32_t tn = 0; tn < num_defending_nodes + num_malicious_nodes + 2; tn++)
     {
-        targetNodes->connection_strength.push_back(-90.0);
+        targetNodes->SetConnectionStrength(tn, -90.0);
         targetNodes->d_connection_strength.push_back(0.0);
     }
 }
@@ -789,7 +789,7 @@ RoutingProtocol::Forwarding(Ptr<const Packet> p,
                 uint32_t index = unsigned(buf[3]) - 1;
 
                 // check if we have updated the connection_strength vector...
-                if (!targetNodes->connection_strength.size())
+                if (!targetNodes->GetConnectionStrength().size())
                     break;
 
                 // get the node number of the precursor.
@@ -800,17 +800,17 @@ RoutingProtocol::Forwarding(Ptr<const Packet> p,
                     precur_node = unsigned(precur_buf[3]) - 1;
 
                     // check if the precursor node is valid
-                    if (precur_node >= targetNodes->connection_strength.size())
+                    if (precur_node >= targetNodes->GetConnectionStrength().size())
                         continue;
 
-                    if(targetNodes->connection_strength[precur_node])
+                    if(targetNodes->GetConnectionStrength()[precur_node])
                     {
-                        precur_connection_strength = targetNodes->connection_strength[precur_node];
+                        precur_connection_strength = targetNodes->GetConnectionStrength()[precur_node];
                         break;
                     }
                 }
 
-                if (targetNodes->connection_strength[index]
+                if (targetNodes->GetConnectionStrength()[index]
                     && precur_connection_strength < m_vTConnection
                     && p->GetSize() > 400) {
                     //i.e. if we have a less than m_vTConnection connectivity to
@@ -832,7 +832,7 @@ RoutingProtocol::Forwarding(Ptr<const Packet> p,
             case PACKET_DROP_NEIGHBOURS:{
                 uint32_t neighbour_bad_con_count = 0;
                 NS_LOG_ERROR("[Attack - PACKET_DROP_NEIGHBOUR] Selected");
-                for (auto i: targetNodes->connection_strength)
+                for (auto i: targetNodes->GetConnectionStrength())
                 {
                     if(i < 1.0) {
                         neighbour_bad_con_count++;
@@ -44,28 +44,28 @@ uint32_t
 RequestQueue::GetSize()
 {
     Purge();
-    return m_queue.size();
+    return m_size;
 }
 
 bool
 RequestQueue::Enqueue(QueueEntry& entry)
 {
     Purge();
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    Ipv4Address dst = entry.GetIpv4Header().GetDestination();
+    const DstList* list = m_dst.Find(dst);
+    for (uint32_t i = list ? list->first : NONE; i != NONE; i = m_ring[i].next)
     {
-        if ((i->GetPacket()->GetUid() == entry.GetPacket()->GetUid()) &&
-            (i->GetIpv4Header().GetDestination() == entry.GetIpv4Header().GetDestination()))
+        if (m_ring[i].entry.GetPacket()->GetUid() == entry.GetPacket()->GetUid())
         {
             return false;
         }
     }
     entry.SetExpireTime(m_queueTimeout);
-    if (m_queue.size() == m_maxLen)
+    if (m_size == m_maxLen && m_size > 0)
     {
-        Drop(m_queue.front(), "Drop the most aged packet"); // Drop the most aged packet
-        m_queue.erase(m_queue.begin());
+        Drop(Unlink(m_head), "Drop the most aged packet"); // Drop the most aged packet
     }
-    m_queue.push_back(entry);
+    Append(entry);
     return true;
 }
 
@@ -74,78 +74,161 @@ RequestQueue::DropPacketWithDst(Ipv4Address dst)
 {
     NS_LOG_FUNCTION(this << dst);
     Purge();
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    const DstList* list;
+    while ((list = m_dst.Find(dst)))
     {
-        if (i->GetIpv4Header().GetDestination() == dst)
-        {
-            Drop(*i, "DropPacketWithDst ");
-        }
+        Drop(Unlink(list->first), "DropPacketWithDst ");
     }
-    auto new_end = std::remove_if(m_queue.begin(), m_queue.end(), [&](const QueueEntry& en) {
-        return en.GetIpv4Header().GetDestination() == dst;
-    });
-    m_queue.erase(new_end, m_queue.end());
 }
 
 bool
 RequestQueue::Dequeue(Ipv4Address dst, QueueEntry& entry)
 {
     Purge();
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    const DstList* list = m_dst.Find(dst);
+    if (!list)
     {
-        if (i->GetIpv4Header().GetDestination() == dst)
-        {
-            entry = *i;
-            m_queue.erase(i);
-            return true;
-        }
+        return false;
     }
-    return false;
+    entry = Unlink(list->first);
+    return true;
 }
 
 bool
 RequestQueue::Find(Ipv4Address dst)
 {
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    return m_dst.Find(dst) != nullptr;
+}
+
+void
+RequestQueue::Append(const QueueEntry& entry)
+{
+    if (m_span == m_ring.size())
+    {
+        Rebuild(std::max<uint32_t>(16, 2 * m_size));
+    }
+    uint32_t slot = SlotAt(m_span);
+    Slot& s = m_ring[slot];
+    s.entry = entry;
+    s.next = NONE;
+    s.live = true;
+    std::pair<DstList*, bool> list = m_dst.Insert(entry.GetIpv4Header().GetDestination(), DstList());
+    if (list.second)
+    {
+        s.prev = NONE;
+        list.first->first = slot;
+    }
+    else
+    {
+        s.prev = list.first->last;
+        m_ring[s.prev].next = slot;
+    }
+    list.first->last = slot;
+    ++m_span;
+    ++m_size;
+}
+
+QueueEntry
+RequestQueue::Unlink(uint32_t slot)
+{
+    Slot& s = m_ring[slot];
+    NS_ASSERT(s.live);
+    Ipv4Address dst = s.entry.GetIpv4Header().GetDestination();
+    if (s.prev == NONE && s.next == NONE)
+    {
+        m_dst.Erase(dst);
+    }
+    else
     {
-        if (i->GetIpv4Header().GetDestination() == dst)
+        DstList* list = m_dst.Find(dst);
+        if (s.prev == NONE)
+        {
+            list->first = s.next;
+        }
+        else
         {
-            return true;
+            m_ring[s.prev].next = s.next;
         }
+        if (s.next == NONE)
+        {
+            list->last = s.prev;
+        }
+        else
+        {
+            m_ring[s.next].prev = s.prev;
+        }
+    }
+    QueueEntry entry = s.entry;
+    s.entry = QueueEntry();
+    s.live = false;
+    --m_size;
+
+    // Trim the holes at both ends of the ring
+    while (m_span > 0 && !m_ring[m_head].live)
+    {
+        m_head = SlotAt(1);
+        --m_span;
+    }
+    while (m_span > 0 && !m_ring[SlotAt(m_span - 1)].live)
+    {
+        --m_span;
+    }
+    if (m_size == 0)
+    {
+        m_expiryOrdered = true;
     }
-    return false;
+    return entry;
 }
 
-/**
- * \brief IsExpired structure
- */
-struct IsExpired
+void
+RequestQueue::Rebuild(uint32_t capacity)
 {
-    bool
-    /**
-     * Check if the entry is expired
-     *
-     * \param e QueueEntry entry
-     * \return true if expired, false otherwise
-     */
-    operator()(const QueueEntry& e) const
+    NS_ASSERT(capacity >= m_size);
+    std::vector<Slot> old;
+    old.swap(m_ring);
+    uint32_t head = m_head;
+    uint32_t span = m_span;
+    m_ring.resize(capacity);
+    for (auto& s : m_ring)
+    {
+        s.live = false;
+    }
+    m_head = 0;
+    m_span = 0;
+    m_size = 0;
+    m_dst.Clear();
+    for (uint32_t i = 0; i < span; ++i)
     {
-        return (e.GetExpireTime() < Seconds(0));
+        Slot& s = old[(head + i) % old.size()];
+        if (s.live)
+        {
+            Append(s.entry);
+        }
     }
-};
+}
 
 void
 RequestQueue::Purge()
 {
-    IsExpired pred;
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    if (m_expiryOrdered)
+    {
+        // The head is always live; stop at the first unexpired entry
+        while (m_size > 0 && m_ring[m_head].entry.GetExpireTime() < Seconds(0))
+        {
+            Drop(Unlink(m_head), "Drop outdated packet ");
+        }
+        return;
+    }
+    uint32_t span = m_span;
+    uint32_t head = m_head;
+    for (uint32_t i = 0; i < span && m_size > 0; ++i)
     {
-        if (pred(*i))
+        uint32_t slot = (head + i) % m_ring.size();
+        if (m_ring[slot].live && m_ring[slot].entry.GetExpireTime() < Seconds(0))
         {
-            Drop(*i, "Drop outdated packet ");
+            Drop(Unlink(slot), "Drop outdated packet ");
         }
     }
-    m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(), pred), m_queue.end());
 }
 
 void
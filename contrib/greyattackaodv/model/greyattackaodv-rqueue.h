@@ -27,6 +27,8 @@
 #ifndef greyattack_aodv_RQUEUE_H
 #define greyattack_aodv_RQUEUE_H
 
+#include "greyattackaodv-address-table.h"
+
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/simulator.h"
 
@@ -192,6 +194,12 @@ class QueueEntry
  * \brief greyattackaodv route request queue
  *
  * Since greyattackaodv is an on demand routing we queue requests while looking for route.
+ *
+ * Entries live in a ring buffer in insertion order, and the entries of each
+ * destination are chained in an intrusive list.  Since all entries share the
+ * same timeout, insertion order is also expiry order, so purging stops at the
+ * first unexpired entry; only after the timeout has been shortened while
+ * packets were queued does a purge scan the whole queue.
  */
 class RequestQueue
 {
@@ -203,7 +211,11 @@ class RequestQueue
      * \param routeToQueueTimeout the route to queue timeout
      */
     RequestQueue(uint32_t maxLen, Time routeToQueueTimeout)
-        : m_maxLen(maxLen),
+        : m_head(0),
+          m_span(0),
+          m_size(0),
+          m_expiryOrdered(true),
+          m_maxLen(maxLen),
           m_queueTimeout(routeToQueueTimeout)
     {
     }
@@ -223,6 +235,18 @@ class RequestQueue
      * \returns true if the entry is dequeued
      */
     bool Dequeue(Ipv4Address dst, QueueEntry& entry);
+    /**
+     * Dequeue the entries for given destination, earliest first, and pass
+     * each of them to handler.  Expired entries are purged once, up front.
+     *
+     * \param dst the destination IP address
+     * \param handler called with each dequeued entry as
+     * bool handler(QueueEntry&); returning false stops the drain and leaves
+     * the remaining entries queued
+     * \returns the number of dequeued entries
+     */
+    template <typename F>
+    uint32_t DequeueAll(Ipv4Address dst, F handler);
     /**
      * Remove all packets with destination IP address dst
      * \param dst the destination IP address
@@ -274,12 +298,60 @@ class RequestQueue
      */
     void SetQueueTimeout(Time t)
     {
+        if (t < m_queueTimeout && m_size > 0)
+        {
+            // queued entries may now expire after entries queued later
+            m_expiryOrdered = false;
+        }
         m_queueTimeout = t;
     }
 
   private:
-    /// The queue
-    std::vector<QueueEntry> m_queue;
+    /// Marker for the end of a list
+    static const uint32_t NONE = 0xffffffff;
+
+    /// Ring buffer slot
+    struct Slot
+    {
+        QueueEntry entry; //!< queued entry
+        uint32_t prev;    //!< previous slot with the same destination, or NONE
+        uint32_t next;    //!< next slot with the same destination, or NONE
+        bool live;        //!< the slot holds a queued entry
+    };
+
+    /// Slots of the queued entries of one destination
+    struct DstList
+    {
+        uint32_t first; //!< earliest slot
+        uint32_t last;  //!< latest slot
+    };
+
+    /**
+     * \param i slot position, relative to the oldest slot
+     * \returns the slot index
+     */
+    uint32_t SlotAt(uint32_t i) const
+    {
+        i += m_head;
+        return (i >= m_ring.size()) ? i - m_ring.size() : i;
+    }
+
+    /**
+     * Append an entry
+     * \param entry the queue entry
+     */
+    void Append(const QueueEntry& entry);
+    /**
+     * Remove an entry from the queue
+     * \param slot the slot index of the entry
+     * \returns the removed entry
+     */
+    QueueEntry Unlink(uint32_t slot);
+    /**
+     * Move the live entries into a ring of the given capacity
+     * \param capacity the new capacity
+     */
+    void Rebuild(uint32_t capacity);
     /// Remove all expired entries
     void Purge();
     /**
@@ -288,6 +360,18 @@ class RequestQueue
      * \param reason the reason to drop the entry
      */
     void Drop(QueueEntry en, std::string reason);
+    /// The ring buffer
+    std::vector<Slot> m_ring;
+    /// Index of the oldest slot
+    uint32_t m_head;
+    /// Number of slots from the oldest to the newest entry, holes included
+    uint32_t m_span;
+    /// Number of queued entries
+    uint32_t m_size;
+    /// Entries of each destination
+    Ipv4AddressTable<DstList> m_dst;
+    /// Entries expire in insertion order
+    bool m_expiryOrdered;
     /// The maximum number of packets that we allow a routing protocol to buffer.
     uint32_t m_maxLen;
     /// The maximum period of time that a routing protocol is allowed to buffer a packet for,
@@ -295,6 +379,26 @@ class RequestQueue
     Time m_queueTimeout;
 };
 
+template <typename F>
+uint32_t
+RequestQueue::DequeueAll(Ipv4Address dst, F handler)
+{
+    Purge();
+    uint32_t n = 0;
+    // The handler may enqueue, so the list is looked up again for each entry
+    const DstList* list;
+    while ((list = m_dst.Find(dst)))
+    {
+        QueueEntry entry = Unlink(list->first);
+        ++n;
+        if (!handler(entry))
+        {
+            break;
+        }
+    }
+    return n;
+}
+
 } // namespace greyattackaodv
 } // namespace ns3
 
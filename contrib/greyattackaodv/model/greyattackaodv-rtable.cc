@@ -31,6 +31,7 @@
 #include "ns3/simulator.h"
 
 #include <algorithm>
+#include <functional>
 #include <iomanip>
 
 namespace ns3
@@ -81,7 +82,10 @@ RoutingTableEntry::InsertPrecursor(Ipv4Address id)
     NS_LOG_FUNCTION(this << id);
     if (!LookupPrecursor(id))
     {
-        m_precursorList.push_back(id);
+        Precursor precursor;
+        precursor.address = id;
+        precursor.node = Ipv4NodeIndex::Lookup(id);
+        m_precursorList.PushBack(precursor);
         return true;
     }
     else
@@ -94,9 +98,9 @@ bool
 RoutingTableEntry::LookupPrecursor(Ipv4Address id)
 {
     NS_LOG_FUNCTION(this << id);
-    for (auto i = m_precursorList.begin(); i != m_precursorList.end(); ++i)
+    for (uint32_t i = 0; i < m_precursorList.GetSize(); ++i)
     {
-        if (*i == id)
+        if (m_precursorList[i].address == id)
         {
             NS_LOG_LOGIC("Precursor " << id << " found");
             return true;
@@ -110,31 +114,31 @@ bool
 RoutingTableEntry::DeletePrecursor(Ipv4Address id)
 {
     NS_LOG_FUNCTION(this << id);
-    auto i = std::remove(m_precursorList.begin(), m_precursorList.end(), id);
-    if (i == m_precursorList.end())
+    // Precursors are unique, see InsertPrecursor()
+    for (uint32_t i = 0; i < m_precursorList.GetSize(); ++i)
     {
-        NS_LOG_LOGIC("Precursor " << id << " not found");
-        return false;
-    }
-    else
-    {
-        NS_LOG_LOGIC("Precursor " << id << " found");
-        m_precursorList.erase(i, m_precursorList.end());
+        if (m_precursorList[i].address == id)
+        {
+            NS_LOG_LOGIC("Precursor " << id << " found");
+            m_precursorList.Erase(i);
+            return true;
+        }
     }
-    return true;
+    NS_LOG_LOGIC("Precursor " << id << " not found");
+    return false;
 }
 
 void
 RoutingTableEntry::DeleteAllPrecursors()
 {
     NS_LOG_FUNCTION(this);
-    m_precursorList.clear();
+    m_precursorList.Clear();
 }
 
 bool
 RoutingTableEntry::IsPrecursorListEmpty() const
 {
-    return m_precursorList.empty();
+    return m_precursorList.IsEmpty();
 }
 
 void
@@ -145,12 +149,12 @@ RoutingTableEntry::GetPrecursors(std::vector<Ipv4Address>& prec) const
     {
         return;
     }
-    for (auto i = m_precursorList.begin(); i != m_precursorList.end(); ++i)
+    for (uint32_t i = 0; i < m_precursorList.GetSize(); ++i)
     {
         bool result = true;
         for (auto j = prec.begin(); j != prec.end(); ++j)
         {
-            if (*j == *i)
+            if (*j == m_precursorList[i].address)
             {
                 result = false;
                 break;
@@ -158,7 +162,7 @@ RoutingTableEntry::GetPrecursors(std::vector<Ipv4Address>& prec) const
         }
         if (result)
         {
-            prec.push_back(*i);
+            prec.push_back(m_precursorList[i].address);
         }
     }
 }
@@ -225,27 +229,179 @@ RoutingTableEntry::Print(Ptr<OutputStreamWrapper> stream, Time::Unit unit /* = T
  */
 
 RoutingTable::RoutingTable(Time t)
-    : m_badLinkLifetime(t)
+    : m_backend(ORDERED_MAP),
+      m_nextExpiry(Time::Max()),
+      m_badLinkLifetime(t)
 {
 }
 
+void
+RoutingTable::SetBackend(RoutingTableBackend backend)
+{
+    NS_LOG_FUNCTION(this << backend);
+    if (backend == m_backend)
+    {
+        return;
+    }
+    std::vector<RoutingTableEntry> entries;
+    if (m_backend == HASH_TABLE)
+    {
+        for (uint32_t i = 0; i < m_hashedEntry.GetSize(); ++i)
+        {
+            entries.push_back(m_hashedEntry.GetValue(i).entry);
+        }
+    }
+    else
+    {
+        for (auto i = m_ipv4AddressEntry.begin(); i != m_ipv4AddressEntry.end(); ++i)
+        {
+            entries.push_back(i->second);
+        }
+    }
+    Clear();
+    m_backend = backend;
+    for (auto i = entries.begin(); i != entries.end(); ++i)
+    {
+        if (m_backend == HASH_TABLE)
+        {
+            auto result = m_hashedEntry.Insert(i->GetDestination(), HashedRoute(*i));
+            ScheduleExpiry(i->GetDestination(), *result.first);
+        }
+        else
+        {
+            m_ipv4AddressEntry.insert(std::make_pair(i->GetDestination(), *i));
+            ScheduleExpiry(i->GetDestination());
+        }
+        IndexNextHop(i->GetDestination(), i->GetNextHop());
+    }
+}
+
+void
+RoutingTable::IndexNextHop(Ipv4Address dst, Ipv4Address nextHop)
+{
+    auto result = m_indexedNextHop.Insert(dst, nextHop);
+    if (!result.second)
+    {
+        if (*result.first == nextHop)
+        {
+            return;
+        }
+        UnindexNextHop(dst);
+        m_indexedNextHop.Insert(dst, nextHop);
+    }
+    std::vector<Ipv4Address>* dsts = m_nextHopIndex.Find(nextHop);
+    if (dsts)
+    {
+        dsts->push_back(dst);
+    }
+    else
+    {
+        m_nextHopIndex.Insert(nextHop, std::vector<Ipv4Address>(1, dst));
+    }
+}
+
+void
+RoutingTable::UnindexNextHop(Ipv4Address dst)
+{
+    Ipv4Address* nextHop = m_indexedNextHop.Find(dst);
+    if (!nextHop)
+    {
+        return;
+    }
+    std::vector<Ipv4Address>* dsts = m_nextHopIndex.Find(*nextHop);
+    NS_ASSERT(dsts);
+    auto i = std::find(dsts->begin(), dsts->end(), dst);
+    NS_ASSERT(i != dsts->end());
+    *i = dsts->back();
+    dsts->pop_back();
+    if (dsts->empty())
+    {
+        m_nextHopIndex.Erase(*nextHop);
+    }
+    m_indexedNextHop.Erase(dst);
+}
+
+bool
+RoutingTable::Erase(Ipv4Address dst)
+{
+    bool erased = (m_backend == HASH_TABLE) ? m_hashedEntry.Erase(dst)
+                                            : (m_ipv4AddressEntry.erase(dst) != 0);
+    if (erased)
+    {
+        UnindexNextHop(dst);
+    }
+    return erased;
+}
+
+RoutingTableEntry*
+RoutingTable::Locate(Ipv4Address dst)
+{
+    if (m_backend == HASH_TABLE)
+    {
+        HashedRoute* route = m_hashedEntry.Find(dst);
+        return route ? &route->entry : nullptr;
+    }
+    auto i = m_ipv4AddressEntry.find(dst);
+    return (i == m_ipv4AddressEntry.end()) ? nullptr : &i->second;
+}
+
+void
+RoutingTable::ScheduleExpiry(Ipv4Address dst)
+{
+    if (m_backend != HASH_TABLE)
+    {
+        auto i = m_ipv4AddressEntry.find(dst);
+        if (i != m_ipv4AddressEntry.end() && i->second.GetFlag() != IN_SEARCH)
+        {
+            m_nextExpiry = std::min(m_nextExpiry, Simulator::Now() + i->second.GetLifeTime());
+        }
+        return;
+    }
+    HashedRoute* route = m_hashedEntry.Find(dst);
+    if (route)
+    {
+        ScheduleExpiry(dst, *route);
+    }
+}
+
+void
+RoutingTable::ScheduleExpiry(Ipv4Address dst, HashedRoute& route)
+{
+    Time expiry = Simulator::Now() + route.entry.GetLifeTime();
+    if (expiry < route.expiry)
+    {
+        // Older records for dst, if any, become stale and are skipped when popped
+        route.expiry = expiry;
+        m_expiryQueue.emplace_back(expiry, dst);
+        std::push_heap(m_expiryQueue.begin(),
+                       m_expiryQueue.end(),
+                       std::greater<std::pair<Time, Ipv4Address>>());
+    }
+}
+
+void
+RoutingTable::Clear()
+{
+    m_ipv4AddressEntry.clear();
+    m_hashedEntry.Clear();
+    m_expiryQueue.clear();
+    m_nextExpiry = Time::Max();
+    m_nextHopIndex.Clear();
+    m_indexedNextHop.Clear();
+}
+
 bool
 RoutingTable::LookupRoute(Ipv4Address id, RoutingTableEntry& rt)
 {
     NS_LOG_FUNCTION(this << id);
     Purge();
-    if (m_ipv4AddressEntry.empty())
-    {
-        NS_LOG_LOGIC("Route to " << id << " not found; m_ipv4AddressEntry is empty");
-        return false;
-    }
-    auto i = m_ipv4AddressEntry.find(id);
-    if (i == m_ipv4AddressEntry.end())
+    RoutingTableEntry* entry = Locate(id);
+    if (!entry)
     {
         NS_LOG_LOGIC("Route to " << id << " not found");
         return false;
     }
-    rt = i->second;
+    rt = *entry;
     NS_LOG_LOGIC("Route to " << id << " found");
     return true;
 }
@@ -269,7 +425,7 @@ RoutingTable::DeleteRoute(Ipv4Address dst)
 {
     NS_LOG_FUNCTION(this << dst);
     Purge();
-    if (m_ipv4AddressEntry.erase(dst) != 0)
+    if (Erase(dst))
     {
         NS_LOG_LOGIC("Route deletion to " << dst << " successful");
         return true;
@@ -287,7 +443,22 @@ RoutingTable::AddRoute(RoutingTableEntry& rt)
     {
         rt.SetRreqCnt(0);
     }
+    if (m_backend == HASH_TABLE)
+    {
+        auto result = m_hashedEntry.Insert(rt.GetDestination(), HashedRoute(rt));
+        if (result.second)
+        {
+            ScheduleExpiry(rt.GetDestination(), *result.first);
+            IndexNextHop(rt.GetDestination(), rt.GetNextHop());
+        }
+        return result.second;
+    }
     auto result = m_ipv4AddressEntry.insert(std::make_pair(rt.GetDestination(), rt));
+    if (result.second)
+    {
+        ScheduleExpiry(rt.GetDestination());
+        IndexNextHop(rt.GetDestination(), rt.GetNextHop());
+    }
     return result.second;
 }
 
@@ -295,33 +466,77 @@ bool
 RoutingTable::Update(RoutingTableEntry& rt)
 {
     NS_LOG_FUNCTION(this);
-    auto i = m_ipv4AddressEntry.find(rt.GetDestination());
-    if (i == m_ipv4AddressEntry.end())
+    RoutingTableEntry* entry = Locate(rt.GetDestination());
+    if (!entry)
     {
         NS_LOG_LOGIC("Route update to " << rt.GetDestination() << " fails; not found");
         return false;
     }
-    i->second = rt;
-    if (i->second.GetFlag() != IN_SEARCH)
+    *entry = rt;
+    Commit(rt.GetDestination(), *entry);
+    return true;
+}
+
+const RoutingTableEntry*
+RoutingTable::FindEntry(Ipv4Address dst)
+{
+    NS_LOG_FUNCTION(this << dst);
+    Purge();
+    return Locate(dst);
+}
+
+Ipv4Address
+RoutingTable::RefreshActivePath(Ipv4Address origin, Ipv4Address dst, Time lifetime)
+{
+    NS_LOG_FUNCTION(this << origin << dst << lifetime);
+    RoutingTableEntry* toOrigin = Locate(origin);
+    RoutingTableEntry* toDst = Locate(dst);
+    Ipv4Address originNextHop = toOrigin ? toOrigin->GetNextHop() : Ipv4Address();
+    Ipv4Address dstNextHop = toDst ? toDst->GetNextHop() : Ipv4Address();
+    std::pair<Ipv4Address, RoutingTableEntry*> path[] = {
+        {origin, toOrigin},
+        {dst, toDst},
+        {dstNextHop, toDst ? Locate(dstNextHop) : nullptr},
+        {originNextHop, Locate(originNextHop)},
+    };
+    for (auto& hop : path)
+    {
+        RoutingTableEntry* entry = hop.second;
+        if (entry && entry->GetFlag() == VALID)
+        {
+            entry->SetRreqCnt(0);
+            entry->SetLifeTime(std::max(lifetime, entry->GetLifeTime()));
+            Commit(hop.first, *entry);
+        }
+    }
+    return originNextHop;
+}
+
+void
+RoutingTable::Commit(Ipv4Address dst, RoutingTableEntry& entry)
+{
+    if (entry.GetFlag() != IN_SEARCH)
     {
-        NS_LOG_LOGIC("Route update to " << rt.GetDestination() << " set RreqCnt to 0");
-        i->second.SetRreqCnt(0);
+        NS_LOG_LOGIC("Route update to " << dst << " set RreqCnt to 0");
+        entry.SetRreqCnt(0);
     }
-    return true;
+    ScheduleExpiry(dst);
+    IndexNextHop(dst, entry.GetNextHop());
 }
 
 bool
 RoutingTable::SetEntryState(Ipv4Address id, RouteFlags state)
 {
     NS_LOG_FUNCTION(this);
-    auto i = m_ipv4AddressEntry.find(id);
-    if (i == m_ipv4AddressEntry.end())
+    RoutingTableEntry* entry = Locate(id);
+    if (!entry)
     {
         NS_LOG_LOGIC("Route set entry state to " << id << " fails; not found");
         return false;
     }
-    i->second.SetFlag(state);
-    i->second.SetRreqCnt(0);
+    entry->SetFlag(state);
+    entry->SetRreqCnt(0);
+    ScheduleExpiry(id);
     NS_LOG_LOGIC("Route set entry state to " << id << ": new state is " << state);
     return true;
 }
@@ -333,12 +548,19 @@ RoutingTable::GetListOfDestinationWithNextHop(Ipv4Address nextHop,
     NS_LOG_FUNCTION(this);
     Purge();
     unreachable.clear();
-    for (auto i = m_ipv4AddressEntry.begin(); i != m_ipv4AddressEntry.end(); ++i)
+    const std::vector<Ipv4Address>* dsts = m_nextHopIndex.Find(nextHop);
+    if (!dsts)
     {
-        if (i->second.GetNextHop() == nextHop)
+        return;
+    }
+    for (auto i = dsts->begin(); i != dsts->end(); ++i)
+    {
+        RoutingTableEntry* entry = Locate(*i);
+        NS_ASSERT(entry);
+        if (entry->GetNextHop() == nextHop)
         {
-            NS_LOG_LOGIC("Unreachable insert " << i->first << " " << i->second.GetSeqNo());
-            unreachable.insert(std::make_pair(i->first, i->second.GetSeqNo()));
+            NS_LOG_LOGIC("Unreachable insert " << *i << " " << entry->GetSeqNo());
+            unreachable.insert(std::make_pair(*i, entry->GetSeqNo()));
         }
     }
 }
@@ -348,15 +570,14 @@ RoutingTable::InvalidateRoutesWithDst(const std::map<Ipv4Address, uint32_t>& unr
 {
     NS_LOG_FUNCTION(this);
     Purge();
-    for (auto i = m_ipv4AddressEntry.begin(); i != m_ipv4AddressEntry.end(); ++i)
+    for (auto j = unreachable.begin(); j != unreachable.end(); ++j)
     {
-        for (auto j = unreachable.begin(); j != unreachable.end(); ++j)
+        RoutingTableEntry* entry = Locate(j->first);
+        if (entry && entry->GetFlag() == VALID)
         {
-            if ((i->first == j->first) && (i->second.GetFlag() == VALID))
-            {
-                NS_LOG_LOGIC("Invalidate route with destination address " << i->first);
-                i->second.Invalidate(m_badLinkLifetime);
-            }
+            NS_LOG_LOGIC("Invalidate route with destination address " << j->first);
+            entry->Invalidate(m_badLinkLifetime);
+            ScheduleExpiry(j->first);
         }
     }
 }
@@ -365,6 +586,22 @@ void
 RoutingTable::DeleteAllRoutesFromInterface(Ipv4InterfaceAddress iface)
 {
     NS_LOG_FUNCTION(this);
+    if (m_backend == HASH_TABLE)
+    {
+        for (uint32_t i = 0; i < m_hashedEntry.GetSize();)
+        {
+            if (m_hashedEntry.GetValue(i).entry.GetInterface() == iface)
+            {
+                // The last entry is moved to position i
+                Erase(m_hashedEntry.GetKey(i));
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        return;
+    }
     if (m_ipv4AddressEntry.empty())
     {
         return;
@@ -375,6 +612,7 @@ RoutingTable::DeleteAllRoutesFromInterface(Ipv4InterfaceAddress iface)
         {
             auto tmp = i;
             ++i;
+            UnindexNextHop(tmp->first);
             m_ipv4AddressEntry.erase(tmp);
         }
         else
@@ -388,10 +626,17 @@ void
 RoutingTable::Purge()
 {
     NS_LOG_FUNCTION(this);
-    if (m_ipv4AddressEntry.empty())
+    if (m_backend == HASH_TABLE)
+    {
+        PurgeExpired();
+        return;
+    }
+    Time now = Simulator::Now();
+    if (m_ipv4AddressEntry.empty() || !(m_nextExpiry < now))
     {
         return;
     }
+    m_nextExpiry = Time::Max();
     for (auto i = m_ipv4AddressEntry.begin(); i != m_ipv4AddressEntry.end();)
     {
         if (i->second.GetLifeTime() < Seconds(0))
@@ -400,23 +645,59 @@ RoutingTable::Purge()
             {
                 auto tmp = i;
                 ++i;
+                UnindexNextHop(tmp->first);
                 m_ipv4AddressEntry.erase(tmp);
+                continue;
             }
             else if (i->second.GetFlag() == VALID)
             {
                 NS_LOG_LOGIC("Invalidate route with destination address " << i->first);
                 i->second.Invalidate(m_badLinkLifetime);
-                ++i;
-            }
-            else
-            {
-                ++i;
             }
         }
-        else
+        if (i->second.GetFlag() != IN_SEARCH)
         {
-            ++i;
+            m_nextExpiry = std::min(m_nextExpiry, now + i->second.GetLifeTime());
+        }
+        ++i;
+    }
+}
+
+void
+RoutingTable::PurgeExpired()
+{
+    Time now = Simulator::Now();
+    while (!m_expiryQueue.empty() && m_expiryQueue.front().first < now)
+    {
+        std::pair<Time, Ipv4Address> record = m_expiryQueue.front();
+        std::pop_heap(m_expiryQueue.begin(),
+                      m_expiryQueue.end(),
+                      std::greater<std::pair<Time, Ipv4Address>>());
+        m_expiryQueue.pop_back();
+        HashedRoute* route = m_hashedEntry.Find(record.second);
+        if (!route || route->expiry != record.first)
+        {
+            // Entry deleted, or covered by an earlier record already processed
+            continue;
+        }
+        route->expiry = Time::Max();
+        if (route->entry.GetLifeTime() >= Seconds(0))
+        {
+            // Lifetime was extended since the record was queued
+            ScheduleExpiry(record.second, *route);
+            continue;
+        }
+        if (route->entry.GetFlag() == INVALID)
+        {
+            Erase(record.second);
+        }
+        else if (route->entry.GetFlag() == VALID)
+        {
+            NS_LOG_LOGIC("Invalidate route with destination address " << record.second);
+            route->entry.Invalidate(m_badLinkLifetime);
+            ScheduleExpiry(record.second, *route);
         }
+        // Expired IN_SEARCH entries stay as they are until the next change
     }
 }
 
@@ -460,15 +741,15 @@ bool
 RoutingTable::MarkLinkAsUnidirectional(Ipv4Address neighbor, Time blacklistTimeout)
 {
     NS_LOG_FUNCTION(this << neighbor << blacklistTimeout.As(Time::S));
-    auto i = m_ipv4AddressEntry.find(neighbor);
-    if (i == m_ipv4AddressEntry.end())
+    RoutingTableEntry* entry = Locate(neighbor);
+    if (!entry)
     {
         NS_LOG_LOGIC("Mark link unidirectional to  " << neighbor << " fails; not found");
         return false;
     }
-    i->second.SetUnidirectional(true);
-    i->second.SetBlacklistTimeout(blacklistTimeout);
-    i->second.SetRreqCnt(0);
+    entry->SetUnidirectional(true);
+    entry->SetBlacklistTimeout(blacklistTimeout);
+    entry->SetRreqCnt(0);
     NS_LOG_LOGIC("Set link to " << neighbor << " to unidirectional");
     return true;
 }
@@ -477,6 +758,10 @@ void
 RoutingTable::Print(Ptr<OutputStreamWrapper> stream, Time::Unit unit /* = Time::S */) const
 {
     std::map<Ipv4Address, RoutingTableEntry> table = m_ipv4AddressEntry;
+    for (uint32_t i = 0; i < m_hashedEntry.GetSize(); ++i)
+    {
+        table.insert(std::make_pair(m_hashedEntry.GetKey(i), m_hashedEntry.GetValue(i).entry));
+    }
     Purge(table);
     std::ostream* os = stream->GetStream();
     // Copy the current ostream state
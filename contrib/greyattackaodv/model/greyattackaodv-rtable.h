@@ -27,6 +27,10 @@
 #ifndef greyattack_aodv_RTABLE_H
 #define greyattack_aodv_RTABLE_H
 
+#include "greyattackaodv-address-table.h"
+#include "greyattackaodv-node-index.h"
+#include "greyattackaodv-small-vector.h"
+
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4.h"
 #include "ns3/net-device.h"
@@ -37,6 +41,8 @@
 #include <map>
 #include <stdint.h>
 #include <sys/types.h>
+#include <utility>
+#include <vector>
 
 namespace ns3
 {
@@ -54,6 +60,16 @@ enum RouteFlags
     IN_SEARCH = 2, //!< IN_SEARCH
 };
 
+/**
+ * \ingroup greyattackaodv
+ * \brief Storage used by the routing table
+ */
+enum RoutingTableBackend
+{
+    ORDERED_MAP = 0, //!< std::map keyed by destination, full scan once an entry is due to expire
+    HASH_TABLE = 1,  //!< open-addressing hash keyed by destination plus an expiry min-heap
+};
+
 /**
  * \ingroup greyattackaodv
  * \brief Routing table entry
@@ -116,6 +132,35 @@ class RoutingTableEntry
      * \param prec vector of precursor addresses
      */
     void GetPrecursors(std::vector<Ipv4Address>& prec) const;
+    /**
+     * \returns the number of precursors
+     */
+    uint32_t GetNPrecursors() const
+    {
+        return m_precursorList.GetSize();
+    }
+    /**
+     * \param i precursor position, less than GetNPrecursors()
+     * \returns the address of precursor i
+     */
+    Ipv4Address GetPrecursor(uint32_t i) const
+    {
+        return m_precursorList[i].address;
+    }
+    /**
+     * \param i precursor position, less than GetNPrecursors()
+     * \returns the node id of precursor i, or Ipv4NodeIndex::NOT_FOUND
+     */
+    uint32_t GetPrecursorNode(uint32_t i) const
+    {
+        const Precursor& precursor = m_precursorList[i];
+        if (precursor.node == Ipv4NodeIndex::NOT_FOUND)
+        {
+            // The address may have been assigned since the insertion
+            precursor.node = Ipv4NodeIndex::Lookup(precursor.address);
+        }
+        return precursor.node;
+    }
     //\}
 
     /**
@@ -404,8 +449,15 @@ class RoutingTableEntry
     /// Routing flags: valid, invalid or in search
     RouteFlags m_flag;
 
+    /// Precursor description
+    struct Precursor
+    {
+        Ipv4Address address;   //!< precursor address
+        mutable uint32_t node; //!< node id of the precursor, resolved on insertion or use
+    };
+
     /// List of precursors
-    std::vector<Ipv4Address> m_precursorList;
+    SmallVector<Precursor, 4> m_precursorList;
     /// When I can send another request
     Time m_routeRequestTimeout;
     /// Number of route requests
@@ -452,6 +504,22 @@ class RoutingTable
     }
 
     //\}
+
+    /**
+     * Select the storage backend.  Existing entries are migrated, so the
+     * table content is the same before and after the call.
+     * \param backend the backend to use
+     */
+    void SetBackend(RoutingTableBackend backend);
+
+    /**
+     * \returns the storage backend in use
+     */
+    RoutingTableBackend GetBackend() const
+    {
+        return m_backend;
+    }
+
     /**
      * Add routing table entry if it doesn't yet exist in routing table
      * \param r routing table entry
@@ -478,6 +546,45 @@ class RoutingTable
      * \return true on success
      */
     bool LookupValidRoute(Ipv4Address dst, RoutingTableEntry& rt);
+    /**
+     * Lookup routing table entry with destination address dst, without
+     * copying it
+     * \param dst destination address
+     * \return the entry, or nullptr if it does not exist.  The pointer
+     * remains valid until the next call adding or deleting entries, table
+     * purges included.
+     */
+    const RoutingTableEntry* FindEntry(Ipv4Address dst);
+    /**
+     * Modify the entry with destination address dst in place.
+     *
+     * Same as LookupRoute(), changing the copy and writing it back with
+     * Update() if fn returns true, but the entry is never copied.  fn must
+     * not change the destination of the entry nor access the routing table.
+     *
+     * \param dst destination address
+     * \param fn callable taking a RoutingTableEntry&, returning true if it
+     * modified the entry and false if it left it unchanged
+     * \return true if the entry exists and fn returned true
+     */
+    template <typename F>
+    bool WithRoute(Ipv4Address dst, F fn);
+    /**
+     * Refresh the routes used to forward a data packet from origin to dst.
+     *
+     * The routes to origin, to dst, to the next hop towards dst and to the
+     * next hop towards origin that are VALID get their RREQ count reset and
+     * their lifetime extended to at least lifetime.  Each entry is located
+     * once.  The table is not purged and no entry is added or deleted, so
+     * pointers returned by FindEntry() remain valid.
+     *
+     * \param origin source address of the packet
+     * \param dst destination address of the packet
+     * \param lifetime the minimum lifetime
+     * \return the next hop towards origin, or Ipv4Address() if there is no
+     * route to origin
+     */
+    Ipv4Address RefreshActivePath(Ipv4Address origin, Ipv4Address dst, Time lifetime);
     /**
      * Update routing table
      * \param rt entry with destination address dst, if exists
@@ -494,6 +601,11 @@ class RoutingTable
     /**
      * Lookup routing entries with next hop Address dst and not empty list of precursors.
      *
+     * Served from an index of destinations by next hop, so the cost is
+     * proportional to the number of routes through nextHop.  The index is
+     * maintained by AddRoute(), Update() and route removal; an entry whose
+     * next hop is changed must be written back with Update().
+     *
      * \param nextHop the next hop IP address
      * \param unreachable
      */
@@ -515,12 +627,15 @@ class RoutingTable
     void DeleteAllRoutesFromInterface(Ipv4InterfaceAddress iface);
 
     /// Delete all entries from routing table
-    void Clear()
-    {
-        m_ipv4AddressEntry.clear();
-    }
+    void Clear();
 
-    /// Delete all outdated entries and invalidate valid entry if Lifetime is expired
+    /**
+     * Delete all outdated entries and invalidate valid entry if Lifetime is expired.
+     *
+     * The table tracks the earliest time an entry can expire, so the call
+     * returns at once when no entry is due.  Lookups purge the table
+     * themselves and need not be preceded by a call to Purge().
+     */
     void Purge();
     /** Mark entry as unidirectional (e.g. add this neighbor to "blacklist" for blacklistTimeout
      * period)
@@ -537,10 +652,87 @@ class RoutingTable
     void Print(Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
 
   private:
-    /// The routing table
+    /// Entry of the HASH_TABLE backend
+    struct HashedRoute
+    {
+        /**
+         * constructor
+         * \param rt the routing table entry
+         */
+        HashedRoute(const RoutingTableEntry& rt)
+            : entry(rt),
+              expiry(Time::Max())
+        {
+        }
+
+        /// The routing table entry
+        RoutingTableEntry entry;
+        /// Time of the expiry queue record covering this entry, Time::Max () if none
+        Time expiry;
+    };
+
+    /// Storage in use
+    RoutingTableBackend m_backend;
+    /// The routing table (ORDERED_MAP backend)
     std::map<Ipv4Address, RoutingTableEntry> m_ipv4AddressEntry;
+    /// The routing table (HASH_TABLE backend)
+    Ipv4AddressTable<HashedRoute> m_hashedEntry;
+    /// Min-heap of (expiry time, destination) records (HASH_TABLE backend)
+    std::vector<std::pair<Time, Ipv4Address>> m_expiryQueue;
+    /// No VALID or INVALID entry expires before this time (ORDERED_MAP backend)
+    Time m_nextExpiry;
+    /// Destinations currently routed through each next hop
+    Ipv4AddressTable<std::vector<Ipv4Address>> m_nextHopIndex;
+    /// Next hop under which each destination is filed in m_nextHopIndex
+    Ipv4AddressTable<Ipv4Address> m_indexedNextHop;
     /// Deletion time for invalid routes
     Time m_badLinkLifetime;
+    /**
+     * File destination dst under nextHop in the next hop index, moving it
+     * away from the next hop it was previously filed under
+     * \param dst destination address
+     * \param nextHop next hop address
+     */
+    void IndexNextHop(Ipv4Address dst, Ipv4Address nextHop);
+    /**
+     * Remove destination dst from the next hop index
+     * \param dst destination address
+     */
+    void UnindexNextHop(Ipv4Address dst);
+    /**
+     * Remove the entry for dst from the storage and the next hop index
+     * \param dst destination address
+     * \returns true if an entry was removed
+     */
+    bool Erase(Ipv4Address dst);
+    /**
+     * Find the stored entry for a destination, whatever the backend
+     * \param dst destination address
+     * \returns the entry or nullptr
+     */
+    RoutingTableEntry* Locate(Ipv4Address dst);
+    /**
+     * Bookkeeping after the entry for dst was changed: reset the RREQ count
+     * unless the entry is IN_SEARCH, reschedule its expiry and index its
+     * next hop
+     * \param dst destination address
+     * \param entry the stored entry for dst
+     */
+    void Commit(Ipv4Address dst, RoutingTableEntry& entry);
+    /**
+     * Make sure the expiry queue (HASH_TABLE) or the next expiry time
+     * (ORDERED_MAP) covers the lifetime of the entry for dst.  Must be
+     * called after any change to an entry.
+     * \param dst destination address
+     */
+    void ScheduleExpiry(Ipv4Address dst);
+    /**
+     * \copydoc ScheduleExpiry(Ipv4Address)
+     * \param route the stored entry for dst
+     */
+    void ScheduleExpiry(Ipv4Address dst, HashedRoute& route);
+    /// Purge() for the HASH_TABLE backend: process expiry records that are due
+    void PurgeExpired();
     /**
      * const version of Purge, for use by Print() method
      * \param table the routing table entry to purge
@@ -548,6 +740,20 @@ class RoutingTable
     void Purge(std::map<Ipv4Address, RoutingTableEntry>& table) const;
 };
 
+template <typename F>
+bool
+RoutingTable::WithRoute(Ipv4Address dst, F fn)
+{
+    Purge();
+    RoutingTableEntry* entry = Locate(dst);
+    if (!entry || !fn(*entry))
+    {
+        return false;
+    }
+    Commit(dst, *entry);
+    return true;
+}
+
 } // namespace greyattackaodv
 } // namespace ns3
 
@@ -0,0 +1,207 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "greyattackaodv-shadow-decision-log.h"
+
+#include "greyattackaodv-binary-io.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("greyattackaodvShadowDecisionLog");
+
+namespace greyattackaodv
+{
+
+namespace
+{
+
+/// First bytes of a shadow decision file
+const char MAGIC[4] = {'G', 'A', 'A', 'D'};
+/// Version of the file format
+const uint8_t VERSION = 1;
+
+} // namespace
+
+NS_OBJECT_ENSURE_REGISTERED(ShadowDecisionLog);
+
+TypeId
+ShadowDecisionLog::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::greyattackaodv::ShadowDecisionLog")
+            .SetParent<Object>()
+            .SetGroupName("greyattackaodv")
+            .AddConstructor<ShadowDecisionLog>()
+            .AddAttribute("MaxRecords",
+                          "The maximum number of packets recorded, 0 for no limit. The packets "
+                          "forwarded once the log is full are only counted.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&ShadowDecisionLog::m_maxRecords),
+                          MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+ShadowDecisionLog::ShadowDecisionLog()
+    : m_maxRecords(0),
+      m_nMissed(0)
+{
+}
+
+ShadowDecisionLog::~ShadowDecisionLog()
+{
+}
+
+void
+ShadowDecisionLog::DoDispose()
+{
+    m_factories.clear();
+    Clear();
+    Object::DoDispose();
+}
+
+uint32_t
+ShadowDecisionLog::AddStrategy(const ObjectFactory& factory)
+{
+    NS_ASSERT_MSG(m_records.empty(), "Shadow strategy added after the first decision");
+    NS_ASSERT_MSG(factory.GetTypeId().IsChildOf(AttackStrategy::GetTypeId()),
+                  factory.GetTypeId().GetName() << " is not an attack strategy");
+    m_factories.push_back(factory);
+    return m_factories.size() - 1;
+}
+
+uint32_t
+ShadowDecisionLog::GetNStrategies() const
+{
+    return m_factories.size();
+}
+
+std::vector<Ptr<AttackStrategy>>
+ShadowDecisionLog::CreateStrategies() const
+{
+    std::vector<Ptr<AttackStrategy>> strategies;
+    for (const auto& factory : m_factories)
+    {
+        strategies.push_back(factory.Create<AttackStrategy>());
+    }
+    return strategies;
+}
+
+uint32_t
+ShadowDecisionLog::GetNWords() const
+{
+    return (m_factories.size() + 63) / 64;
+}
+
+void
+ShadowDecisionLog::Add(const Record& record, const uint64_t* decisions)
+{
+    if (m_maxRecords && m_records.size() >= m_maxRecords)
+    {
+        if (!m_nMissed++)
+        {
+            NS_LOG_WARN("Shadow decision log full after " << m_maxRecords << " records");
+        }
+        return;
+    }
+    m_records.push_back(record);
+    m_decisions.insert(m_decisions.end(), decisions, decisions + GetNWords());
+}
+
+uint32_t
+ShadowDecisionLog::GetNRecords() const
+{
+    return m_records.size();
+}
+
+uint32_t
+ShadowDecisionLog::GetNMissed() const
+{
+    return m_nMissed;
+}
+
+const ShadowDecisionLog::Record&
+ShadowDecisionLog::GetRecord(uint32_t i) const
+{
+    NS_ASSERT(i < m_records.size());
+    return m_records[i];
+}
+
+bool
+ShadowDecisionLog::GetDecision(uint32_t i, uint32_t strategy) const
+{
+    NS_ASSERT(i < m_records.size() && strategy < m_factories.size());
+    return (m_decisions[i * GetNWords() + strategy / 64] >> (strategy % 64)) & 1;
+}
+
+uint32_t
+ShadowDecisionLog::CountDrops(uint32_t strategy) const
+{
+    NS_ASSERT(strategy < m_factories.size());
+    uint32_t words = GetNWords();
+    uint32_t drops = 0;
+    for (uint32_t w = strategy / 64; w < m_decisions.size(); w += words)
+    {
+        drops += (m_decisions[w] >> (strategy % 64)) & 1;
+    }
+    return drops;
+}
+
+void
+ShadowDecisionLog::Save(const std::string& filename) const
+{
+    NS_LOG_FUNCTION(this << filename);
+    std::ofstream os(filename, std::ios::binary);
+    NS_ABORT_MSG_UNLESS(os, "Cannot open " << filename);
+    // Header, then one fixed size entry per record followed by its
+    // decision words
+    os.write(MAGIC, sizeof(MAGIC));
+    WriteLe(os, VERSION, 1);
+    WriteLe(os, m_factories.size(), 4);
+    WriteLe(os, m_records.size(), 4);
+    WriteLe(os, m_nMissed, 4);
+    uint32_t words = GetNWords();
+    for (uint32_t i = 0; i < m_records.size(); ++i)
+    {
+        const Record& record = m_records[i];
+        WriteLe(os, record.time.GetNanoSeconds(), 8);
+        WriteLe(os, record.attacker, 4);
+        WriteLe(os, record.precursorNode, 4);
+        WriteLe(os, record.packetId, 2);
+        WriteLe(os, record.drop, 1);
+        for (uint32_t w = 0; w < words; ++w)
+        {
+            WriteLe(os, m_decisions[i * words + w], 8);
+        }
+    }
+    NS_ABORT_MSG_UNLESS(os, "Cannot write " << filename);
+}
+
+void
+ShadowDecisionLog::Clear()
+{
+    m_records.clear();
+    m_decisions.clear();
+    m_nMissed = 0;
+}
+
+} // namespace greyattackaodv
+} // namespace ns3
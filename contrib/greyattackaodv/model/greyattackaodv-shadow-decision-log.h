@@ -0,0 +1,148 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_SHADOW_DECISION_LOG_H
+#define greyattack_aodv_SHADOW_DECISION_LOG_H
+
+#include "greyattackaodv-attack-strategy.h"
+
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/object.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+namespace greyattackaodv
+{
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Decisions the shadow attack strategies would have taken.
+ *
+ * Each grey hole node sharing the log builds its own instance of every
+ * shadow strategy, with its own random variable, and asks all of them
+ * about every data packet it forwards, next to the strategy that actually
+ * decides.  Shadow decisions are never applied: one record per packet
+ * keeps the actual decision and one bit per shadow strategy, so that a
+ * single run yields the drops of many attack configurations.
+ *
+ * The records are kept in memory until Save() or Clear(): each packet
+ * forwarded by a grey hole node costs a Record, 24 bytes on common
+ * platforms, plus 8 bytes per 64 shadow strategies.  MaxRecords bounds
+ * the log; the packets forwarded once it is full are only counted.
+ */
+class ShadowDecisionLog : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    ShadowDecisionLog();
+    ~ShadowDecisionLog() override;
+
+    /// A forwarded packet
+    struct Record
+    {
+        Time time;              ///< time of the decision
+        uint32_t attacker;      ///< node id of the forwarder
+        uint32_t precursorNode; ///< node id of the precursor, or Ipv4NodeIndex::NOT_FOUND
+        uint16_t packetId;      ///< IP identification of the packet
+        bool drop;              ///< decision of the actual strategy
+    };
+
+    /**
+     * Add a shadow strategy, before any decision is recorded
+     * \param factory the factory of the strategy, configured with its attributes
+     * \returns the index of the strategy
+     */
+    uint32_t AddStrategy(const ObjectFactory& factory);
+    /**
+     * \returns the number of shadow strategies
+     */
+    uint32_t GetNStrategies() const;
+    /**
+     * \returns a new instance of each shadow strategy, in index order
+     */
+    std::vector<Ptr<AttackStrategy>> CreateStrategies() const;
+    /**
+     * \returns the number of 64 bit words holding the decisions of a packet
+     */
+    uint32_t GetNWords() const;
+
+    /**
+     * Record the decisions about a packet
+     * \param record the packet and the actual decision
+     * \param decisions GetNWords() words, bit k of the decisions being set
+     * if shadow strategy k drops the packet
+     */
+    void Add(const Record& record, const uint64_t* decisions);
+
+    /**
+     * \returns the number of recorded packets
+     */
+    uint32_t GetNRecords() const;
+    /**
+     * \returns the number of packets not recorded because the log was full
+     */
+    uint32_t GetNMissed() const;
+    /**
+     * \param i the index of a recorded packet
+     * \returns the packet
+     */
+    const Record& GetRecord(uint32_t i) const;
+    /**
+     * \param i the index of a recorded packet
+     * \param strategy the index of a shadow strategy
+     * \returns true if the strategy would have dropped the packet
+     */
+    bool GetDecision(uint32_t i, uint32_t strategy) const;
+    /**
+     * \param strategy the index of a shadow strategy
+     * \returns the number of packets the strategy would have dropped
+     */
+    uint32_t CountDrops(uint32_t strategy) const;
+
+    /**
+     * Write the records to a binary file: a header with the format
+     * version, the strategy, record and missed packet counts, then one
+     * entry per record
+     * \param filename the file name
+     */
+    void Save(const std::string& filename) const;
+    /// Forget the records and the missed packets
+    void Clear();
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    std::vector<ObjectFactory> m_factories; ///< shadow strategies
+    std::vector<Record> m_records;          ///< recorded packets
+    std::vector<uint64_t> m_decisions;      ///< GetNWords() words per recorded packet
+    uint32_t m_maxRecords;                  ///< maximum number of records, 0 for no limit
+    uint32_t m_nMissed;                     ///< packets not recorded because the log was full
+};
+
+} // namespace greyattackaodv
+} // namespace ns3
+
+#endif /* greyattack_aodv_SHADOW_DECISION_LOG_H */
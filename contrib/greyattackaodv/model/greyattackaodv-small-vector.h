@@ -0,0 +1,130 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_SMALL_VECTOR_H
+#define greyattack_aodv_SMALL_VECTOR_H
+
+#include "ns3/assert.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+namespace greyattackaodv
+{
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Ordered sequence storing its first N elements inline.
+ *
+ * Copying or filling a SmallVector of at most N elements never touches the
+ * heap; further elements spill into a std::vector.
+ */
+template <typename T, uint32_t N>
+class SmallVector
+{
+  public:
+    SmallVector()
+        : m_size(0)
+    {
+    }
+
+    /**
+     * Append an element
+     * \param value the element
+     */
+    void PushBack(const T& value)
+    {
+        if (m_size < N)
+        {
+            m_inline[m_size] = value;
+        }
+        else
+        {
+            m_overflow.push_back(value);
+        }
+        ++m_size;
+    }
+
+    /**
+     * Remove an element, keeping the order of the others
+     * \param i position of the element, less than GetSize()
+     */
+    void Erase(uint32_t i)
+    {
+        NS_ASSERT(i < m_size);
+        for (uint32_t j = i; j + 1 < m_size; ++j)
+        {
+            (*this)[j] = (*this)[j + 1];
+        }
+        --m_size;
+        if (m_size >= N)
+        {
+            m_overflow.pop_back();
+        }
+    }
+
+    /// Remove all elements
+    void Clear()
+    {
+        m_size = 0;
+        m_overflow.clear();
+    }
+
+    /**
+     * \returns the number of elements
+     */
+    uint32_t GetSize() const
+    {
+        return m_size;
+    }
+
+    /**
+     * \returns true if there are no elements
+     */
+    bool IsEmpty() const
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * \param i position, less than GetSize()
+     * \returns the element at position i
+     */
+    T& operator[](uint32_t i)
+    {
+        return (i < N) ? m_inline[i] : m_overflow[i - N];
+    }
+
+    /**
+     * \param i position, less than GetSize()
+     * \returns the element at position i
+     */
+    const T& operator[](uint32_t i) const
+    {
+        return (i < N) ? m_inline[i] : m_overflow[i - N];
+    }
+
+  private:
+    T m_inline[N];            ///< first N elements
+    std::vector<T> m_overflow; ///< elements beyond the first N
+    uint32_t m_size;          ///< number of elements
+};
+
+} // namespace greyattackaodv
+} // namespace ns3
+
+#endif /* greyattack_aodv_SMALL_VECTOR_H */
@@ -0,0 +1,473 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "greyattackaodv-timer-wheel.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("greyattackaodvTimerWheel");
+
+namespace greyattackaodv
+{
+
+namespace
+{
+
+/// Tick of a wheel without timers
+const uint64_t NO_TICK = std::numeric_limits<uint64_t>::max();
+
+/**
+ * \param occupied bitmap of the non-empty slots of a level, not zero
+ * \param index the slot of the current tick
+ * \returns the distance from index to the next non-empty slot, in [1, 64]
+ */
+uint32_t
+NextSlot(uint64_t occupied, uint32_t index)
+{
+    uint32_t shift = (index + 1) % 64;
+    uint64_t rotated = shift ? (occupied >> shift) | (occupied << (64 - shift)) : occupied;
+    uint32_t distance = 1;
+    while (!(rotated & 1))
+    {
+        rotated >>= 1;
+        ++distance;
+    }
+    return distance;
+}
+
+} // namespace
+
+NS_OBJECT_ENSURE_REGISTERED(TimerWheel);
+
+TypeId
+TimerWheel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::greyattackaodv::TimerWheel")
+            .SetParent<Object>()
+            .SetGroupName("greyattackaodv")
+            .AddConstructor<TimerWheel>()
+            .AddAttribute("Resolution",
+                          "Duration of a tick, timers are rounded up to a whole number of ticks.",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&TimerWheel::SetResolution, &TimerWheel::GetResolution),
+                          MakeTimeChecker(TimeStep(1)));
+    return tid;
+}
+
+TimerWheel::TimerWheel()
+    : m_resolution(MilliSeconds(1)),
+      m_now(0),
+      m_occupied(),
+      m_lastId(0),
+      m_nextTick(NO_TICK),
+      m_context(Simulator::NO_CONTEXT),
+      m_expiring(false),
+      m_resetScheduled(false),
+      m_ticks(0)
+{
+}
+
+TimerWheel::~TimerWheel()
+{
+}
+
+void
+TimerWheel::DoDispose()
+{
+    Reset();
+    Object::DoDispose();
+}
+
+void
+TimerWheel::SetResolution(Time resolution)
+{
+    NS_ASSERT_MSG(m_pending.empty(), "Resolution changed while timers are pending");
+    m_resolution = resolution;
+}
+
+Time
+TimerWheel::GetResolution() const
+{
+    return m_resolution;
+}
+
+uint64_t
+TimerWheel::GetTicks() const
+{
+    return m_ticks;
+}
+
+void
+TimerWheel::SetContext(uint32_t context)
+{
+    m_context = context;
+}
+
+uint32_t
+TimerWheel::GetContext() const
+{
+    return m_context;
+}
+
+TimerWheel::TimerId
+TimerWheel::Schedule(Time delay, const Callback<void>& callback)
+{
+    NS_LOG_FUNCTION(this << delay);
+    NS_ASSERT(!delay.IsNegative());
+    int64_t resolution = m_resolution.GetTimeStep();
+    if (!m_expiring)
+    {
+        // Catch up with the ticks skipped since the last one processed, without
+        // passing a tick whose event is still to run
+        uint64_t current = Simulator::Now().GetTimeStep() / resolution;
+        m_now = std::max(m_now, std::min(current, m_nextTick - 1));
+    }
+    Entry entry;
+    entry.id = ++m_lastId;
+    entry.expiry = ((Simulator::Now() + delay).GetTimeStep() + resolution - 1) / resolution;
+    entry.callback = callback;
+    Insert(entry);
+    if (!m_expiring)
+    {
+        Reschedule();
+    }
+    return entry.id;
+}
+
+void
+TimerWheel::Cancel(TimerId id)
+{
+    NS_LOG_FUNCTION(this << id);
+    auto i = m_pending.find(id);
+    if (i == m_pending.end())
+    {
+        return;
+    }
+    uint32_t location = i->second;
+    m_pending.erase(i);
+    // Entries taken from the due list by Expire() are not found, and are
+    // skipped there as they are no longer pending
+    std::vector<Entry>& list = GetList(location);
+    auto entry =
+        std::find_if(list.begin(), list.end(), [id](const Entry& e) { return e.id == id; });
+    if (entry != list.end())
+    {
+        list.erase(entry);
+    }
+    if (location < OVERFLOW_LIST && list.empty())
+    {
+        m_occupied[location / SLOTS] &= ~(uint64_t(1) << (location % SLOTS));
+    }
+    if (!m_expiring)
+    {
+        Reschedule();
+    }
+}
+
+bool
+TimerWheel::IsPending(TimerId id) const
+{
+    return m_pending.count(id) > 0;
+}
+
+void
+TimerWheel::Insert(const Entry& entry)
+{
+    if (entry.expiry <= m_now)
+    {
+        m_due.push_back(entry);
+        m_pending[entry.id] = DUE_LIST;
+        return;
+    }
+    for (uint32_t level = 0; level < LEVELS; ++level)
+    {
+        uint32_t shift = level * SLOT_BITS;
+        if ((entry.expiry >> shift) - (m_now >> shift) < SLOTS)
+        {
+            uint32_t slot = (entry.expiry >> shift) % SLOTS;
+            m_slots[level][slot].push_back(entry);
+            m_occupied[level] |= uint64_t(1) << slot;
+            m_pending[entry.id] = level * SLOTS + slot;
+            return;
+        }
+    }
+    m_overflow.push_back(entry);
+    m_pending[entry.id] = OVERFLOW_LIST;
+}
+
+std::vector<TimerWheel::Entry>&
+TimerWheel::GetList(uint32_t location)
+{
+    if (location == DUE_LIST)
+    {
+        return m_due;
+    }
+    if (location == OVERFLOW_LIST)
+    {
+        return m_overflow;
+    }
+    return m_slots[location / SLOTS][location % SLOTS];
+}
+
+uint64_t
+TimerWheel::GetNextTick() const
+{
+    if (!m_due.empty())
+    {
+        return m_now;
+    }
+    uint64_t next = NO_TICK;
+    for (uint32_t level = 0; level < LEVELS; ++level)
+    {
+        if (m_occupied[level])
+        {
+            // Level 0 slots expire at their tick, the slots of the other
+            // levels are cascaded when their period starts
+            uint32_t shift = level * SLOT_BITS;
+            uint64_t current = m_now >> shift;
+            uint64_t tick = (current + NextSlot(m_occupied[level], current % SLOTS)) << shift;
+            next = std::min(next, tick);
+        }
+    }
+    if (!m_overflow.empty())
+    {
+        uint32_t shift = LEVELS * SLOT_BITS;
+        next = std::min(next, ((m_now >> shift) + 1) << shift);
+    }
+    return next;
+}
+
+void
+TimerWheel::Reschedule()
+{
+    m_nextTick = GetNextTick();
+    for (auto i = m_wakeups.begin(); i != m_wakeups.end();)
+    {
+        if (i->first != m_nextTick && i->second.IsRunning())
+        {
+            Simulator::Remove(i->second);
+            i = m_wakeups.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    if (m_nextTick == NO_TICK || m_wakeups.count(m_nextTick))
+    {
+        return;
+    }
+    if (!m_resetScheduled)
+    {
+        Simulator::ScheduleDestroy(&TimerWheel::Reset, Ptr<TimerWheel>(this));
+        m_resetScheduled = true;
+    }
+    Time delay = TimeStep(m_nextTick * m_resolution.GetTimeStep()) - Simulator::Now();
+    if (Simulator::GetContext() == m_context)
+    {
+        m_wakeups[m_nextTick] =
+            Simulator::Schedule(delay, &TimerWheel::Expire, Ptr<TimerWheel>(this), m_nextTick);
+    }
+    else
+    {
+        // ScheduleWithContext() gives no EventId: this event runs even if
+        // the tick is left without timers, and Expire() ignores it then
+        Simulator::ScheduleWithContext(m_context,
+                                       delay,
+                                       &TimerWheel::Expire,
+                                       Ptr<TimerWheel>(this),
+                                       m_nextTick);
+        m_wakeups[m_nextTick] = EventId();
+    }
+}
+
+void
+TimerWheel::Expire(uint64_t tick)
+{
+    m_wakeups.erase(tick);
+    if (tick != m_nextTick)
+    {
+        // Superseded by an earlier tick, which rescheduled the wheel
+        return;
+    }
+    NS_LOG_FUNCTION(this << tick);
+    ++m_ticks;
+    m_expiring = true;
+    m_now = tick;
+
+    // Move the timers of the periods starting now down the wheel
+    std::vector<Entry> entries;
+    if (tick % (uint64_t(1) << (LEVELS * SLOT_BITS)) == 0)
+    {
+        entries.swap(m_overflow);
+        for (const auto& entry : entries)
+        {
+            Insert(entry);
+        }
+    }
+    for (uint32_t level = LEVELS - 1; level > 0; --level)
+    {
+        uint32_t shift = level * SLOT_BITS;
+        if (tick % (uint64_t(1) << shift) != 0)
+        {
+            continue;
+        }
+        uint32_t slot = (tick >> shift) % SLOTS;
+        entries.clear();
+        entries.swap(m_slots[level][slot]);
+        m_occupied[level] &= ~(uint64_t(1) << slot);
+        for (const auto& entry : entries)
+        {
+            Insert(entry);
+        }
+    }
+    uint32_t slot = tick % SLOTS;
+    entries.clear();
+    entries.swap(m_slots[0][slot]);
+    m_occupied[0] &= ~(uint64_t(1) << slot);
+    for (const auto& entry : entries)
+    {
+        Insert(entry);
+    }
+
+    // Callbacks may schedule timers due in this tick
+    while (!m_due.empty())
+    {
+        entries.clear();
+        entries.swap(m_due);
+        for (const auto& entry : entries)
+        {
+            if (m_pending.erase(entry.id))
+            {
+                entry.callback();
+            }
+        }
+    }
+    m_expiring = false;
+    Reschedule();
+}
+
+void
+TimerWheel::Reset()
+{
+    NS_LOG_FUNCTION(this);
+    for (uint32_t level = 0; level < LEVELS; ++level)
+    {
+        for (uint32_t slot = 0; slot < SLOTS; ++slot)
+        {
+            m_slots[level][slot].clear();
+        }
+        m_occupied[level] = 0;
+    }
+    m_overflow.clear();
+    m_due.clear();
+    m_pending.clear();
+    for (auto& wakeup : m_wakeups)
+    {
+        wakeup.second.Cancel();
+    }
+    m_wakeups.clear();
+    m_now = 0;
+    m_nextTick = NO_TICK;
+    m_resetScheduled = false;
+}
+
+WheelTimer::WheelTimer()
+    : m_id(0)
+{
+}
+
+WheelTimer::~WheelTimer()
+{
+    Cancel();
+}
+
+void
+WheelTimer::SetWheel(Ptr<TimerWheel> wheel)
+{
+    NS_ASSERT_MSG(!IsRunning(), "Wheel changed while the timer is running");
+    m_wheel = wheel;
+}
+
+void
+WheelTimer::SetDelay(const Time& delay)
+{
+    m_delay = delay;
+}
+
+Time
+WheelTimer::GetDelay() const
+{
+    return m_delay;
+}
+
+void
+WheelTimer::Schedule()
+{
+    Schedule(m_delay);
+}
+
+void
+WheelTimer::Schedule(Time delay)
+{
+    NS_ASSERT_MSG(!IsRunning(), "Timer is still running while re-scheduling");
+    if (m_wheel)
+    {
+        m_id = m_wheel->Schedule(delay, MakeCallback(&WheelTimer::Expire, this));
+    }
+    else
+    {
+        m_event = Simulator::Schedule(delay, &WheelTimer::Expire, this);
+    }
+}
+
+void
+WheelTimer::Cancel()
+{
+    if (m_id)
+    {
+        m_wheel->Cancel(m_id);
+        m_id = 0;
+    }
+    m_event.Cancel();
+}
+
+bool
+WheelTimer::IsRunning() const
+{
+    if (m_wheel)
+    {
+        return m_id && m_wheel->IsPending(m_id);
+    }
+    return m_event.IsRunning();
+}
+
+void
+WheelTimer::Expire()
+{
+    m_id = 0;
+    m_callback();
+}
+
+} // namespace greyattackaodv
+} // namespace ns3
@@ -0,0 +1,239 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef greyattack_aodv_TIMER_WHEEL_H
+#define greyattack_aodv_TIMER_WHEEL_H
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+
+#include <map>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+namespace greyattackaodv
+{
+
+/**
+ * \ingroup greyattackaodv
+ * \brief Hierarchical timer wheel running the timers of a greyattackaodv node.
+ *
+ * Expiration times are rounded up to the wheel resolution, and all the
+ * timers due in the same tick run from a single simulator event.  Ticks
+ * without due timers are skipped: cancelled timers are removed from the
+ * wheel at once, and the simulator event of a tick left without timers is
+ * removed too.  Four levels of 64 slots cover 2^24 ticks ahead, later
+ * timers wait in an overflow list.
+ *
+ * Callbacks run in the context given by SetContext(), the node id of the
+ * owner, so that logs and traces are attributed to it.  A wheel shared by
+ * several nodes runs all their callbacks in the same context.
+ */
+class TimerWheel : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    TimerWheel();
+    ~TimerWheel() override;
+
+    /// Timer handle, zero is never a valid handle
+    typedef uint64_t TimerId;
+
+    /**
+     * Schedule a callback
+     * \param delay the time to wait, rounded up to the resolution
+     * \param callback the callback
+     * \returns the timer handle
+     */
+    TimerId Schedule(Time delay, const Callback<void>& callback);
+    /**
+     * Cancel a timer, if it is still pending
+     * \param id the timer handle
+     */
+    void Cancel(TimerId id);
+    /**
+     * \param id the timer handle
+     * \returns true if the timer has neither expired nor been cancelled
+     */
+    bool IsPending(TimerId id) const;
+    /**
+     * \returns the resolution of the wheel
+     */
+    Time GetResolution() const;
+    /**
+     * \returns the number of simulator events run by the wheel
+     */
+    uint64_t GetTicks() const;
+    /**
+     * Set the context of the simulator events of the wheel
+     * \param context the context, usually the id of the node owning the wheel
+     */
+    void SetContext(uint32_t context);
+    /**
+     * \returns the context of the simulator events of the wheel,
+     * Simulator::NO_CONTEXT by default
+     */
+    uint32_t GetContext() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /// A scheduled callback
+    struct Entry
+    {
+        TimerId id;              ///< timer handle
+        uint64_t expiry;         ///< tick the timer is due
+        Callback<void> callback; ///< callback
+    };
+
+    /// Number of levels
+    static const uint32_t LEVELS = 4;
+    /// log2 of the number of slots per level
+    static const uint32_t SLOT_BITS = 6;
+    /// Number of slots per level
+    static const uint32_t SLOTS = 1 << SLOT_BITS;
+    /// Location of the entries in the overflow list, slots are level * SLOTS + slot
+    static const uint32_t OVERFLOW_LIST = LEVELS * SLOTS;
+    /// Location of the entries in the due list
+    static const uint32_t DUE_LIST = LEVELS * SLOTS + 1;
+
+    /**
+     * Set the resolution of the wheel, while no timer is pending
+     * \param resolution the resolution
+     */
+    void SetResolution(Time resolution);
+    /**
+     * Store an entry in the slot covering its expiry, or in the due list,
+     * and record where it is
+     * \param entry the entry
+     */
+    void Insert(const Entry& entry);
+    /**
+     * \param location a location recorded by Insert()
+     * \returns the list of entries at this location
+     */
+    std::vector<Entry>& GetList(uint32_t location);
+    /**
+     * \returns the next tick at which timers are due or a slot is cascaded
+     */
+    uint64_t GetNextTick() const;
+    /// Arm the simulator event for the next tick with work, and remove the others
+    void Reschedule();
+    /**
+     * Run the timers due at a tick
+     * \param tick the tick
+     */
+    void Expire(uint64_t tick);
+    /// Drop all the timers when the simulation is destroyed
+    void Reset();
+
+    Time m_resolution;                         ///< duration of a tick
+    uint64_t m_now;                            ///< last processed tick
+    std::vector<Entry> m_slots[LEVELS][SLOTS]; ///< slots of each level
+    uint64_t m_occupied[LEVELS];               ///< bitmap of the non-empty slots
+    std::vector<Entry> m_overflow;             ///< timers beyond the last level
+    std::vector<Entry> m_due;                  ///< timers due at the current tick
+    /// Location of the pending timers, as recorded by Insert()
+    std::unordered_map<TimerId, uint32_t> m_pending;
+    TimerId m_lastId;                          ///< last handle given out
+    uint64_t m_nextTick;                       ///< tick the wheel runs next
+    /// Ticks with a simulator event, the event is not set if it cannot be removed
+    std::map<uint64_t, EventId> m_wakeups;
+    uint32_t m_context;                        ///< context of the simulator events
+    bool m_expiring;                           ///< Expire() is running
+    bool m_resetScheduled;                     ///< Reset() runs on Simulator::Destroy
+    uint64_t m_ticks;                          ///< simulator events run
+};
+
+/**
+ * \ingroup greyattackaodv
+ * \brief One-shot timer run by a TimerWheel.
+ *
+ * Without a wheel the timer uses one simulator event per expiration, as
+ * ns3::Timer does.  The timer is cancelled when destroyed.
+ */
+class WheelTimer
+{
+  public:
+    WheelTimer();
+    ~WheelTimer();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    WheelTimer(const WheelTimer&) = delete;
+    WheelTimer& operator=(const WheelTimer&) = delete;
+
+    /**
+     * Run the timer on a wheel, or on the simulator if null
+     * \param wheel the wheel
+     */
+    void SetWheel(Ptr<TimerWheel> wheel);
+    /**
+     * \param memPtr the member function to call on expiration
+     * \param objPtr the object to call it on
+     */
+    template <typename MEM_PTR, typename OBJ_PTR>
+    void SetFunction(MEM_PTR memPtr, OBJ_PTR objPtr)
+    {
+        m_callback = MakeCallback(memPtr, objPtr);
+    }
+
+    /**
+     * \param delay the delay used by Schedule()
+     */
+    void SetDelay(const Time& delay);
+    /**
+     * \returns the delay used by Schedule()
+     */
+    Time GetDelay() const;
+    /// Schedule the timer after the default delay
+    void Schedule();
+    /**
+     * Schedule the timer
+     * \param delay the delay
+     */
+    void Schedule(Time delay);
+    /// Cancel the timer if it is running
+    void Cancel();
+    /**
+     * \returns true if the timer is running
+     */
+    bool IsRunning() const;
+
+  private:
+    /// Forget the run and call the function
+    void Expire();
+
+    Ptr<TimerWheel> m_wheel;   ///< wheel, or null for the simulator
+    Callback<void> m_callback; ///< function to call
+    Time m_delay;              ///< default delay
+    EventId m_event;           ///< simulator event, without wheel
+    TimerWheel::TimerId m_id;  ///< wheel timer handle, with wheel
+};
+
+} // namespace greyattackaodv
+} // namespace ns3
+
+#endif /* greyattack_aodv_TIMER_WHEEL_H */
@@ -109,6 +109,57 @@ IdCacheTest::CheckTimeout3()
     NS_TEST_EXPECT_MSG_EQ(cache.GetSize(), 0, "All records expire");
 }
 
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Unit test for id cache entries added after the lifetime is shortened
+ */
+class IdCacheLifetimeTest : public TestCase
+{
+  public:
+    IdCacheLifetimeTest()
+        : TestCase("Id Cache shortened lifetime"),
+          cache(Seconds(10))
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /// Check that only the entries added with the short lifetime expired
+    void CheckTimeout();
+
+    /// ID cache
+    IdCache cache;
+};
+
+void
+IdCacheLifetimeTest::DoRun()
+{
+    for (uint32_t id = 0; id < 100; ++id)
+    {
+        cache.IsDuplicate(Ipv4Address("1.1.1.1"), id);
+    }
+    cache.SetLifetime(Seconds(1));
+    for (uint32_t id = 0; id < 100; ++id)
+    {
+        cache.IsDuplicate(Ipv4Address("2.2.2.2"), id);
+    }
+    NS_TEST_EXPECT_MSG_EQ(cache.GetSize(), 200, "trivial");
+
+    Simulator::Schedule(Seconds(2), &IdCacheLifetimeTest::CheckTimeout, this);
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+void
+IdCacheLifetimeTest::CheckTimeout()
+{
+    NS_TEST_EXPECT_MSG_EQ(cache.GetSize(), 100, "Short lifetime records expire");
+    NS_TEST_EXPECT_MSG_EQ(cache.IsDuplicate(Ipv4Address("1.1.1.1"), 7), true, "Still known");
+    NS_TEST_EXPECT_MSG_EQ(cache.IsDuplicate(Ipv4Address("2.2.2.2"), 7), false, "Forgotten");
+}
+
 /**
  * \ingroup greyattackaodv-test
  *
@@ -121,6 +172,7 @@ class IdCacheTestSuite : public TestSuite
         : TestSuite("greyattackaodv-routing-id-cache", UNIT)
     {
         AddTestCase(new IdCacheTest, TestCase::QUICK);
+        AddTestCase(new IdCacheLifetimeTest, TestCase::QUICK);
     }
 } g_idCacheTestSuite; ///< the test suite
 
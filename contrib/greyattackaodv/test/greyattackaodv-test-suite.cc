@@ -16,12 +16,53 @@
  *
  * Authors: Pavel Boyko <boyko@iitp.ru>
  */
+#include "ns3/arp-cache.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/greyattackaodv-attack-observatory.h"
+#include "ns3/greyattackaodv-attack-schedule.h"
+#include "ns3/greyattackaodv-attack-strategy.h"
+#include "ns3/greyattackaodv-grey-hole-routing-protocol.h"
+#include "ns3/greyattackaodv-helper.h"
+#include "ns3/greyattackaodv-link-quality-monitor.h"
 #include "ns3/greyattackaodv-neighbor.h"
 #include "ns3/greyattackaodv-packet.h"
+#include "ns3/greyattackaodv-rate-limiter.h"
+#include "ns3/greyattackaodv-routing-protocol.h"
 #include "ns3/greyattackaodv-rqueue.h"
 #include "ns3/greyattackaodv-rtable.h"
+#include "ns3/greyattackaodv-shadow-decision-log.h"
+#include "ns3/greyattackaodv-small-vector.h"
+#include "ns3/greyattackaodv-timer-wheel.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-l3-protocol.h"
 #include "ns3/ipv4-route.h"
+#include "ns3/loopback-net-device.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/pointer.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/string.h"
 #include "ns3/test.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/yans-wifi-helper.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 namespace ns3
 {
@@ -133,6 +174,107 @@ NeighborTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Link failures of the neighbors stored after a removed one
+ *
+ * Four neighbors with resolved MAC addresses; the second expires, which
+ * moves the last two, then a TX error towards the last one closes it.
+ */
+struct NeighborLinkFailureTest : public TestCase
+{
+    NeighborLinkFailureTest()
+        : TestCase("Neighbor link failures after a removal"),
+          neighbor(nullptr)
+    {
+    }
+
+    void DoRun() override;
+    /**
+     * Record a link failure
+     * \param addr the IPv4 address of the neighbor
+     */
+    void Handler(Ipv4Address addr);
+    /// Check the expiry of the second neighbor, then close the last one
+    void CheckRemoval();
+    /// The Neighbors
+    Neighbors* neighbor;
+    /// Neighbors whose link failed, in order
+    std::vector<Ipv4Address> failures;
+};
+
+void
+NeighborLinkFailureTest::Handler(Ipv4Address addr)
+{
+    failures.push_back(addr);
+}
+
+void
+NeighborLinkFailureTest::CheckRemoval()
+{
+    NS_TEST_EXPECT_MSG_EQ(neighbor->IsNeighbor(Ipv4Address("10.0.0.2")), false, "Expired");
+    NS_TEST_ASSERT_MSG_EQ(failures.size(), 1, "One link failure");
+    NS_TEST_EXPECT_MSG_EQ(failures[0], Ipv4Address("10.0.0.2"), "Expired neighbor");
+    NS_TEST_ASSERT_MSG_EQ(neighbor->GetNNeighbors(), 3, "Expired neighbor removed");
+    NS_TEST_EXPECT_MSG_EQ(neighbor->GetNeighbor(1).m_neighborAddress,
+                          Ipv4Address("10.0.0.3"),
+                          "Order kept");
+    NS_TEST_EXPECT_MSG_EQ(neighbor->GetNeighbor(2).m_hardwareAddress,
+                          Mac48Address("00:00:00:00:00:04"),
+                          "MAC address moved with the neighbor");
+
+    WifiMacHeader hdr;
+    hdr.SetAddr1(Mac48Address("00:00:00:00:00:04"));
+    neighbor->GetTxErrorCallback()(hdr);
+    NS_TEST_ASSERT_MSG_EQ(failures.size(), 2, "TX error closes one link");
+    NS_TEST_EXPECT_MSG_EQ(failures[1], Ipv4Address("10.0.0.4"), "Neighbor of the MAC address");
+    NS_TEST_EXPECT_MSG_EQ(neighbor->IsNeighbor(Ipv4Address("10.0.0.4")), false, "Closed");
+    NS_TEST_EXPECT_MSG_EQ(neighbor->IsNeighbor(Ipv4Address("10.0.0.1")), true, "Still open");
+    NS_TEST_EXPECT_MSG_EQ(neighbor->IsNeighbor(Ipv4Address("10.0.0.3")), true, "Still open");
+    NS_TEST_EXPECT_MSG_EQ(neighbor->GetExpireTime(Ipv4Address("10.0.0.3")),
+                          Seconds(10) - MilliSeconds(2500),
+                          "Expire time moved with the neighbor");
+
+    neighbor->Clear();
+    NS_TEST_EXPECT_MSG_EQ(neighbor->GetNNeighbors(), 0, "Cleared");
+    NS_TEST_EXPECT_MSG_EQ(neighbor->IsNeighbor(Ipv4Address("10.0.0.1")), false, "Cleared");
+    NS_TEST_EXPECT_MSG_EQ(failures.size(), 2, "No link failure on Clear");
+}
+
+void
+NeighborLinkFailureTest::DoRun()
+{
+    Ptr<ArpCache> arp = CreateObject<ArpCache>();
+    for (uint32_t i = 1; i <= 4; ++i)
+    {
+        std::ostringstream ip;
+        ip << "10.0.0." << i;
+        std::ostringstream mac;
+        mac << "00:00:00:00:00:0" << i;
+        ArpCache::Entry* entry = arp->Add(Ipv4Address(ip.str().c_str()));
+        entry->SetMacAddress(Mac48Address(mac.str().c_str()));
+        entry->MarkPermanent();
+    }
+    Neighbors nb(Seconds(1));
+    neighbor = &nb;
+    neighbor->AddArpCache(arp);
+    neighbor->SetCallback(MakeCallback(&NeighborLinkFailureTest::Handler, this));
+    neighbor->Update(Ipv4Address("10.0.0.1"), Seconds(10));
+    neighbor->Update(Ipv4Address("10.0.0.2"), Seconds(2));
+    neighbor->Update(Ipv4Address("10.0.0.3"), Seconds(10));
+    neighbor->Update(Ipv4Address("10.0.0.4"), Seconds(10));
+    NS_TEST_EXPECT_MSG_EQ(neighbor->GetNNeighbors(), 4, "Four neighbors");
+    NS_TEST_EXPECT_MSG_EQ(neighbor->GetNeighbor(3).m_hardwareAddress,
+                          Mac48Address("00:00:00:00:00:04"),
+                          "MAC address resolved");
+
+    Simulator::Schedule(MilliSeconds(2500), &NeighborLinkFailureTest::CheckRemoval, this);
+    Simulator::Run();
+    Simulator::Destroy();
+    arp->Dispose();
+}
+
 /**
  * \ingroup greyattackaodv-test
  *
@@ -550,6 +692,364 @@ greyattackaodvRqueueTest::CheckTimeout()
     NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 0, "Must be empty now");
 }
 
+//-----------------------------------------------------------------------------
+/// Unit test for RequestQueue expiry after the queue timeout is shortened
+struct greyattackaodvRqueueTimeoutTest : public TestCase
+{
+    greyattackaodvRqueueTimeoutTest()
+        : TestCase("Rqueue timeout change"),
+          q(64, Seconds(10))
+    {
+    }
+
+    void DoRun() override;
+
+    /**
+     * Error test function
+     * \param p The packet
+     * \param h The header
+     * \param e the socket error
+     */
+    void Error(Ptr<const Packet> p, const Ipv4Header& h, Socket::SocketErrno e)
+    {
+        ++m_dropped;
+    }
+
+    /// Check that only the entry queued with the short timeout expired
+    void CheckExpired();
+
+    /// Request queue
+    RequestQueue q;
+    /// Number of expired packets
+    uint32_t m_dropped{0};
+};
+
+void
+greyattackaodvRqueueTimeoutTest::DoRun()
+{
+    Ipv4RoutingProtocol::ErrorCallback ecb =
+        MakeCallback(&greyattackaodvRqueueTimeoutTest::Error, this);
+    Ipv4Header h;
+    h.SetDestination(Ipv4Address("1.1.1.1"));
+    QueueEntry e1(Create<Packet>(), h, Ipv4RoutingProtocol::UnicastForwardCallback(), ecb);
+    q.Enqueue(e1);
+    // The entry queued second expires first
+    q.SetQueueTimeout(Seconds(1));
+    h.SetDestination(Ipv4Address("2.2.2.2"));
+    QueueEntry e2(Create<Packet>(), h, Ipv4RoutingProtocol::UnicastForwardCallback(), ecb);
+    q.Enqueue(e2);
+    NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 2, "trivial");
+
+    Simulator::Schedule(Seconds(2), &greyattackaodvRqueueTimeoutTest::CheckExpired, this);
+
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+void
+greyattackaodvRqueueTimeoutTest::CheckExpired()
+{
+    NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 1, "One entry expired");
+    NS_TEST_EXPECT_MSG_EQ(q.Find(Ipv4Address("1.1.1.1")), true, "Entry with the long timeout kept");
+    NS_TEST_EXPECT_MSG_EQ(q.Find(Ipv4Address("2.2.2.2")), false, "Entry with the short timeout dropped");
+    NS_TEST_EXPECT_MSG_EQ(m_dropped, 1, "Error callback called for the expired entry");
+}
+
+//-----------------------------------------------------------------------------
+/// Unit test for RequestQueue::DequeueAll()
+struct greyattackaodvRqueueDrainTest : public TestCase
+{
+    greyattackaodvRqueueDrainTest()
+        : TestCase("Rqueue drain"),
+          q(64, Seconds(10))
+    {
+    }
+
+    void DoRun() override;
+
+    /**
+     * Error test function
+     * \param p The packet
+     * \param h The header
+     * \param e the socket error
+     */
+    void Error(Ptr<const Packet> p, const Ipv4Header& h, Socket::SocketErrno e)
+    {
+        ++m_dropped;
+    }
+
+    /**
+     * Queue a new packet
+     * \param dst the destination IP address
+     * \returns the packet uid
+     */
+    uint64_t Enqueue(Ipv4Address dst)
+    {
+        Ipv4Header h;
+        h.SetDestination(dst);
+        QueueEntry e(Create<Packet>(),
+                     h,
+                     Ipv4RoutingProtocol::UnicastForwardCallback(),
+                     MakeCallback(&greyattackaodvRqueueDrainTest::Error, this));
+        q.Enqueue(e);
+        return e.GetPacket()->GetUid();
+    }
+
+    /// Drain after the entry with the short timeout expired
+    void CheckExpired();
+
+    /// Request queue
+    RequestQueue q;
+    /// Number of expired packets
+    uint32_t m_dropped{0};
+    /// Uid of the entry expected to survive until CheckExpired()
+    uint64_t m_kept{0};
+};
+
+void
+greyattackaodvRqueueDrainTest::DoRun()
+{
+    Ipv4Address dst1("1.1.1.1");
+    Ipv4Address dst2("2.2.2.2");
+    std::vector<uint64_t> expected;
+    expected.push_back(Enqueue(dst1));
+    Enqueue(dst2);
+    expected.push_back(Enqueue(dst1));
+    Enqueue(dst2);
+    expected.push_back(Enqueue(dst1));
+
+    std::vector<uint64_t> released;
+    uint32_t n = q.DequeueAll(dst1, [&released](QueueEntry& e) {
+        released.push_back(e.GetPacket()->GetUid());
+        return true;
+    });
+    NS_TEST_EXPECT_MSG_EQ(n, 3, "All entries for the destination dequeued");
+    NS_TEST_EXPECT_MSG_EQ((released == expected), true, "Entries dequeued in queue order");
+    NS_TEST_EXPECT_MSG_EQ(q.Find(dst1), false, "No entry left for the destination");
+    NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 2, "Other entries kept");
+
+    n = q.DequeueAll(dst2, [](QueueEntry&) { return false; });
+    NS_TEST_EXPECT_MSG_EQ(n, 1, "Drain stopped by the handler");
+    NS_TEST_EXPECT_MSG_EQ(q.Find(dst2), true, "Remaining entry kept");
+    n = q.DequeueAll(dst1, [](QueueEntry&) { return true; });
+    NS_TEST_EXPECT_MSG_EQ(n, 0, "Nothing to dequeue");
+
+    // The entry queued last expires first
+    m_kept = Enqueue(dst1);
+    q.SetQueueTimeout(Seconds(1));
+    Enqueue(dst1);
+    Simulator::Schedule(Seconds(2), &greyattackaodvRqueueDrainTest::CheckExpired, this);
+
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+void
+greyattackaodvRqueueDrainTest::CheckExpired()
+{
+    std::vector<uint64_t> released;
+    uint32_t n = q.DequeueAll(Ipv4Address("1.1.1.1"), [&released](QueueEntry& e) {
+        released.push_back(e.GetPacket()->GetUid());
+        return true;
+    });
+    NS_TEST_EXPECT_MSG_EQ(n, 1, "Expired entry not dequeued");
+    NS_TEST_EXPECT_MSG_EQ(released.front(), m_kept, "Unexpired entry dequeued");
+    NS_TEST_EXPECT_MSG_EQ(m_dropped, 1, "Error callback called for the expired entry");
+    NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 1, "Entry for the other destination kept");
+}
+
+//-----------------------------------------------------------------------------
+/// Unit test for RateLimiter
+struct greyattackaodvRateLimiterTest : public TestCase
+{
+    greyattackaodvRateLimiterTest()
+        : TestCase("RateLimiter")
+    {
+    }
+
+    void DoRun() override;
+
+    /**
+     * Take the tokens of the current period
+     * \param delayLeft the expected time left before the refill
+     */
+    void CheckPeriod(Time delayLeft);
+
+    /// Rate limiter under test, with 1 s periods
+    RateLimiter m_limiter;
+};
+
+void
+greyattackaodvRateLimiterTest::DoRun()
+{
+    m_limiter.Start();
+    CheckPeriod(Seconds(1));
+    // Periods stay aligned on the start time, whenever tokens are asked for
+    Simulator::Schedule(MilliSeconds(1500),
+                        &greyattackaodvRateLimiterTest::CheckPeriod,
+                        this,
+                        MilliSeconds(500));
+    Simulator::Schedule(Seconds(3), &greyattackaodvRateLimiterTest::CheckPeriod, this, Seconds(1));
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+void
+greyattackaodvRateLimiterTest::CheckPeriod(Time delayLeft)
+{
+    NS_TEST_EXPECT_MSG_EQ(m_limiter.GetDelayLeft(), delayLeft, "Time left before the refill");
+    NS_TEST_EXPECT_MSG_EQ(m_limiter.IsAvailable(3), true, "Bucket refilled");
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_limiter.TryAcquire(3), true, "Token " << i << " available");
+    }
+    NS_TEST_EXPECT_MSG_EQ(m_limiter.TryAcquire(3), false, "Limit reached");
+    NS_TEST_EXPECT_MSG_EQ(m_limiter.IsAvailable(3), false, "Limit reached");
+    NS_TEST_EXPECT_MSG_EQ(m_limiter.IsAvailable(4), true, "Limit read on every call");
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Check the queue of RREQs held back by the rate limit
+ *
+ * With one RREQ per second, packets to new destinations are sent at 1.5 s,
+ * some destinations twice, and more at 2.5 s while RREQs are pending.  Each
+ * destination gets a single RREQ, in request order, one per period, 100 us
+ * after the refill.  Requesting again while RREQs are pending must not arm
+ * a second wakeup, which would abort the simulation.
+ */
+class greyattackaodvPendingRequestTest : public TestCase
+{
+  public:
+    greyattackaodvPendingRequestTest()
+        : TestCase("RREQs pending on the rate limit")
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /**
+     * Send one packet to each destination
+     * \param socket the sending socket
+     * \param dsts the destinations, in order
+     */
+    void Send(Ptr<Socket> socket, std::vector<Ipv4Address> dsts);
+    /**
+     * Record the RREQs sent
+     * \param packet the packet, with its IP header
+     * \param ipv4 the IPv4 stack
+     * \param interface the output interface
+     */
+    void Tx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+
+    /// Destination and transmission time of the RREQs, in request order
+    std::vector<std::pair<Ipv4Address, Time>> m_rreqs;
+};
+
+void
+greyattackaodvPendingRequestTest::Send(Ptr<Socket> socket, std::vector<Ipv4Address> dsts)
+{
+    for (const auto& dst : dsts)
+    {
+        socket->SendTo(Create<Packet>(100), 0, InetSocketAddress(dst, 9));
+    }
+}
+
+void
+greyattackaodvPendingRequestTest::Tx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+    Ptr<Packet> p = packet->Copy();
+    Ipv4Header ipHeader;
+    p->RemoveHeader(ipHeader);
+    UdpHeader udpHeader;
+    if (ipHeader.GetProtocol() != UdpL4Protocol::PROT_NUMBER || !p->RemoveHeader(udpHeader) ||
+        udpHeader.GetDestinationPort() != RoutingProtocol::greyattack_aodv_PORT)
+    {
+        return;
+    }
+    TypeHeader typeHeader;
+    p->RemoveHeader(typeHeader);
+    if (typeHeader.Get() != greyattack_aodvTYPE_RREQ)
+    {
+        return;
+    }
+    RreqHeader rreqHeader;
+    p->RemoveHeader(rreqHeader);
+    // Request ids follow the order of the SendRequest() calls, whatever the jitter
+    if (m_rreqs.size() < rreqHeader.GetId())
+    {
+        m_rreqs.resize(rreqHeader.GetId());
+    }
+    m_rreqs[rreqHeader.GetId() - 1] = std::make_pair(rreqHeader.GetDst(), Simulator::Now());
+}
+
+void
+greyattackaodvPendingRequestTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(1);
+    greyattackaodvHelper greyattackaodv;
+    greyattackaodv.Set("EnableHello", BooleanValue(false));
+    greyattackaodv.Set("RreqRateLimit", UintegerValue(1));
+    // A single RREQ per destination, with the longest timeout
+    greyattackaodv.Set("TtlStart", UintegerValue(35));
+    greyattackaodv.Set("RreqRetries", UintegerValue(1));
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(greyattackaodv);
+    internet.Install(nodes);
+    SimpleNetDeviceHelper simple;
+    NetDeviceContainer devices = simple.Install(nodes);
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.0");
+    address.Assign(devices);
+    nodes.Get(0)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+        "Tx",
+        MakeCallback(&greyattackaodvPendingRequestTest::Tx, this));
+
+    Ipv4Address a("10.0.0.101");
+    Ipv4Address b("10.0.0.102");
+    Ipv4Address c("10.0.0.103");
+    Ipv4Address d("10.0.0.104");
+    Ipv4Address e("10.0.0.105");
+    Ptr<Socket> tx = Socket::CreateSocket(nodes.Get(0), UdpSocketFactory::GetTypeId());
+    Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                   MilliSeconds(1500),
+                                   &greyattackaodvPendingRequestTest::Send,
+                                   this,
+                                   tx,
+                                   std::vector<Ipv4Address>{a, b, c, b, d, c});
+    Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                   MilliSeconds(2500),
+                                   &greyattackaodvPendingRequestTest::Send,
+                                   this,
+                                   tx,
+                                   std::vector<Ipv4Address>{e, b, d, c});
+    Simulator::Stop(Seconds(6));
+    Simulator::Run();
+    tx->Close();
+    Simulator::Destroy();
+
+    // Rate limit periods start at 0 s, the RREQs are sent with up to 10 ms jitter
+    std::vector<std::pair<Ipv4Address, Time>> expected = {
+        {a, MilliSeconds(1500)},
+        {b, Seconds(2) + MicroSeconds(100)},
+        {c, Seconds(3) + MicroSeconds(100)},
+        {d, Seconds(4) + MicroSeconds(100)},
+        {e, Seconds(5) + MicroSeconds(100)},
+    };
+    NS_TEST_ASSERT_MSG_EQ(m_rreqs.size(), expected.size(), "One RREQ per destination");
+    for (uint32_t i = 0; i < expected.size(); ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_rreqs[i].first, expected[i].first, "RREQ " << i << " in order");
+        NS_TEST_EXPECT_MSG_EQ_TOL(m_rreqs[i].second,
+                                  expected[i].second + MilliSeconds(5),
+                                  MilliSeconds(5),
+                                  "RREQ " << i << " sent right after the refill");
+    }
+}
+
 /**
  * \ingroup greyattackaodv-test
  *
@@ -650,14 +1150,24 @@ struct greyattackaodvRtableEntryTest : public TestCase
  */
 struct greyattackaodvRtableTest : public TestCase
 {
-    greyattackaodvRtableTest()
-        : TestCase("Rtable")
+    /**
+     * constructor
+     * \param backend the routing table storage backend under test
+     */
+    greyattackaodvRtableTest(RoutingTableBackend backend = ORDERED_MAP)
+        : TestCase(backend == HASH_TABLE ? "Rtable (hash table backend)" : "Rtable"),
+          m_backend(backend)
     {
     }
 
+    /// Storage backend under test
+    RoutingTableBackend m_backend;
+
     void DoRun() override
     {
         RoutingTable rtable(Seconds(2));
+        rtable.SetBackend(m_backend);
+        NS_TEST_EXPECT_MSG_EQ(rtable.GetBackend(), m_backend, "trivial");
         NS_TEST_EXPECT_MSG_EQ(rtable.GetBadLinkLifetime(), Seconds(2), "trivial");
         rtable.SetBadLinkLifetime(Seconds(1));
         NS_TEST_EXPECT_MSG_EQ(rtable.GetBadLinkLifetime(), Seconds(1), "trivial");
@@ -730,6 +1240,2066 @@ struct greyattackaodvRtableTest : public TestCase
     }
 };
 
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Check that FindEntry() and WithRoute() work on the stored entry
+ * without copying it
+ */
+struct greyattackaodvRtableInPlaceTest : public TestCase
+{
+    /**
+     * constructor
+     * \param backend the routing table storage backend under test
+     */
+    greyattackaodvRtableInPlaceTest(RoutingTableBackend backend)
+        : TestCase(backend == HASH_TABLE ? "Rtable in-place access (hash table backend)"
+                                         : "Rtable in-place access"),
+          m_backend(backend)
+    {
+    }
+
+    /// Storage backend under test
+    RoutingTableBackend m_backend;
+
+    void DoRun() override
+    {
+        RoutingTable rtable(Seconds(1));
+        rtable.SetBackend(m_backend);
+        Ipv4Address dst("1.2.3.4");
+        RoutingTableEntry rt(/*output device*/ nullptr,
+                             /*dst*/ dst,
+                             /*validSeqNo*/ true,
+                             /*seqNo*/ 10,
+                             /*interface*/ Ipv4InterfaceAddress(),
+                             /*hop*/ 5,
+                             /*next hop*/ Ipv4Address("1.1.1.1"),
+                             /*lifetime*/ Seconds(10));
+        rtable.AddRoute(rt);
+        rt = RoutingTableEntry();
+
+        NS_TEST_EXPECT_MSG_EQ((rtable.FindEntry(Ipv4Address("4.3.2.1")) == nullptr),
+                              true,
+                              "No entry");
+        const RoutingTableEntry* entry = rtable.FindEntry(dst);
+        NS_TEST_ASSERT_MSG_EQ((entry != nullptr), true, "Entry found");
+        // The stored entry holds the only reference to its route
+        NS_TEST_EXPECT_MSG_EQ(entry->GetRoute()->GetReferenceCount(), 2, "Entry not copied");
+
+        bool visited = rtable.WithRoute(dst, [entry, this](RoutingTableEntry& e) {
+            NS_TEST_EXPECT_MSG_EQ(&e, entry, "Visitor gets the stored entry");
+            e.SetRreqCnt(3);
+            e.SetFlag(IN_SEARCH);
+            e.SetNextHop(Ipv4Address("2.2.2.2"));
+            return true;
+        });
+        NS_TEST_EXPECT_MSG_EQ(visited, true, "Entry visited");
+        NS_TEST_EXPECT_MSG_EQ(rtable.FindEntry(dst), entry, "Entry not moved");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetRreqCnt(), 3, "RreqCnt kept while IN_SEARCH");
+        std::map<Ipv4Address, uint32_t> unreachable;
+        rtable.GetListOfDestinationWithNextHop(Ipv4Address("2.2.2.2"), unreachable);
+        NS_TEST_EXPECT_MSG_EQ(unreachable.size(), 1, "Next hop index follows the change");
+
+        visited = rtable.WithRoute(dst, [](RoutingTableEntry& e) {
+            e.SetFlag(VALID);
+            return true;
+        });
+        NS_TEST_EXPECT_MSG_EQ(visited, true, "Entry visited");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetRreqCnt(), 0, "RreqCnt reset as by Update()");
+        visited = rtable.WithRoute(dst, [](RoutingTableEntry&) { return false; });
+        NS_TEST_EXPECT_MSG_EQ(visited, false, "Visitor declined");
+        visited = rtable.WithRoute(Ipv4Address("4.3.2.1"), [](RoutingTableEntry&) { return true; });
+        NS_TEST_EXPECT_MSG_EQ(visited, false, "No entry to visit");
+
+        // RefreshActivePath() extends the lifetimes without moving the entries
+        Ipv4Address origin("5.5.5.5");
+        RoutingTableEntry toOrigin(nullptr,
+                                   origin,
+                                   true,
+                                   1,
+                                   Ipv4InterfaceAddress(),
+                                   1,
+                                   origin,
+                                   Seconds(1));
+        rtable.AddRoute(toOrigin);
+        // Adding a route may move the stored entries
+        entry = rtable.FindEntry(dst);
+        NS_TEST_EXPECT_MSG_EQ(rtable.RefreshActivePath(origin, dst, Seconds(20)),
+                              origin,
+                              "Next hop towards the origin");
+        NS_TEST_EXPECT_MSG_EQ(rtable.FindEntry(dst), entry, "Entry not moved");
+        NS_TEST_EXPECT_MSG_EQ(entry->GetLifeTime(), Seconds(20), "Destination refreshed");
+        NS_TEST_EXPECT_MSG_EQ(rtable.FindEntry(origin)->GetLifeTime(),
+                              Seconds(20),
+                              "Origin refreshed");
+        rtable.RefreshActivePath(origin, dst, Seconds(5));
+        NS_TEST_EXPECT_MSG_EQ(entry->GetLifeTime(), Seconds(20), "Lifetime never shortened");
+        NS_TEST_EXPECT_MSG_EQ(rtable.RefreshActivePath(Ipv4Address("6.6.6.6"), dst, Seconds(5)),
+                              Ipv4Address(),
+                              "No route towards the origin");
+
+        // Shortening the lifetime in place must be picked up by the expiry
+        rtable.WithRoute(dst, [](RoutingTableEntry& e) {
+            e.SetLifeTime(Seconds(1));
+            return true;
+        });
+        Simulator::Schedule(Seconds(2), [&rtable, dst, this]() {
+            const RoutingTableEntry* expired = rtable.FindEntry(dst);
+            NS_TEST_ASSERT_MSG_EQ((expired != nullptr), true, "Entry kept");
+            NS_TEST_EXPECT_MSG_EQ(expired->GetFlag(), INVALID, "Entry invalidated");
+        });
+        Simulator::Run();
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Check that Purge() skips nothing: entries expiring exactly at the
+ * next expiry time are handled right after it, and a lifetime shortened by
+ * Update() or WithRoute() moves the next expiry time forward
+ */
+struct greyattackaodvRtablePurgeGateTest : public TestCase
+{
+    /**
+     * constructor
+     * \param backend the routing table storage backend under test
+     */
+    greyattackaodvRtablePurgeGateTest(RoutingTableBackend backend)
+        : TestCase(backend == HASH_TABLE ? "Rtable purge gate (hash table backend)"
+                                         : "Rtable purge gate"),
+          m_backend(backend)
+    {
+    }
+
+    /// Storage backend under test
+    RoutingTableBackend m_backend;
+
+    /**
+     * Add a VALID route
+     * \param rtable the routing table
+     * \param dst the destination
+     * \param lifetime the route lifetime
+     */
+    static void AddRoute(RoutingTable& rtable, Ipv4Address dst, Time lifetime)
+    {
+        RoutingTableEntry rt(/*output device*/ nullptr,
+                             /*dst*/ dst,
+                             /*validSeqNo*/ true,
+                             /*seqNo*/ 10,
+                             /*interface*/ Ipv4InterfaceAddress(),
+                             /*hop*/ 1,
+                             /*next hop*/ dst,
+                             /*lifetime*/ lifetime);
+        rtable.AddRoute(rt);
+    }
+
+    /**
+     * \param rtable the routing table
+     * \param dst the destination
+     * \returns the flag of the route to dst, or IN_SEARCH if there is none
+     */
+    static RouteFlags Flag(RoutingTable& rtable, Ipv4Address dst)
+    {
+        const RoutingTableEntry* entry = rtable.FindEntry(dst);
+        return entry ? entry->GetFlag() : IN_SEARCH;
+    }
+
+    void DoRun() override
+    {
+        RoutingTable rtable(/*bad link lifetime*/ Seconds(1));
+        rtable.SetBackend(m_backend);
+        Ipv4Address a("10.0.0.1");
+        Ipv4Address b("10.0.0.2");
+        Ipv4Address c("10.0.0.3");
+        Ipv4Address d("10.0.0.4");
+        AddRoute(rtable, a, Seconds(2));
+        AddRoute(rtable, b, Seconds(2));
+        AddRoute(rtable, c, Seconds(10));
+        AddRoute(rtable, d, Seconds(10));
+
+        // c is shortened by Update() and d in place, below the current gate
+        RoutingTableEntry rt;
+        rtable.LookupRoute(c, rt);
+        rt.SetLifeTime(Seconds(1));
+        rtable.Update(rt);
+        rtable.WithRoute(d, [](RoutingTableEntry& e) {
+            e.SetLifeTime(MilliSeconds(1500));
+            return true;
+        });
+
+        Simulator::Schedule(Seconds(1), [&rtable, c, this]() {
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, c), VALID, "Not expired at its lifetime");
+        });
+        Simulator::Schedule(Seconds(1) + NanoSeconds(1), [&rtable, c, d, this]() {
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, c), INVALID, "Shortened by Update()");
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, d), VALID, "Not expired yet");
+        });
+        Simulator::Schedule(MilliSeconds(1500) + NanoSeconds(1), [&rtable, d, this]() {
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, d), INVALID, "Shortened in place");
+        });
+        // a and b expire together, both at the next expiry time
+        Simulator::Schedule(Seconds(2), [&rtable, a, b, this]() {
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, a), VALID, "Not expired at its lifetime");
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, b), VALID, "Not expired at its lifetime");
+        });
+        Simulator::Schedule(Seconds(2) + NanoSeconds(1), [&rtable, a, b, c, this]() {
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, a), INVALID, "Expired");
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, b), INVALID, "Expired at the same time");
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, c), INVALID, "Deleted after its lifetime only");
+        });
+        Simulator::Schedule(Seconds(2) + NanoSeconds(2), [&rtable, c, d, this]() {
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, c), IN_SEARCH, "Invalid route deleted");
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, d), INVALID, "Not deleted yet");
+        });
+        Simulator::Schedule(Seconds(3) + NanoSeconds(2), [&rtable, a, b, d, this]() {
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, a), IN_SEARCH, "Invalid route deleted");
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, b), IN_SEARCH, "Invalid route deleted");
+            NS_TEST_EXPECT_MSG_EQ(Flag(rtable, d), IN_SEARCH, "Invalid route deleted");
+        });
+        Simulator::Run();
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Check that the ORDERED_MAP and HASH_TABLE routing table backends
+ * evolve identically under the same random sequence of operations, and
+ * that the next hop index matches the table content.
+ */
+struct greyattackaodvRtableBackendTest : public TestCase
+{
+    greyattackaodvRtableBackendTest()
+        : TestCase("Rtable backends equivalence"),
+          m_map(Seconds(1)),
+          m_hash(Seconds(1)),
+          m_state(1)
+    {
+        m_hash.SetBackend(HASH_TABLE);
+    }
+
+    void DoRun() override
+    {
+        for (uint32_t i = 0; i < 400; ++i)
+        {
+            Simulator::Schedule(MilliSeconds(25 * i),
+                                &greyattackaodvRtableBackendTest::Step,
+                                this);
+        }
+        Simulator::Run();
+        Simulator::Destroy();
+    }
+
+    /**
+     * \param n the range
+     * \returns a pseudo-random integer in [0, n)
+     */
+    uint32_t Draw(uint32_t n)
+    {
+        m_state = m_state * 1103515245 + 12345;
+        return (m_state >> 16) % n;
+    }
+
+    /**
+     * \returns one of a small pool of destination addresses
+     */
+    Ipv4Address DrawAddress()
+    {
+        return Ipv4Address(0x0a000001 + Draw(40));
+    }
+
+    /// Apply one random operation to both tables and compare them
+    void Step()
+    {
+        Ipv4Address dst = DrawAddress();
+        Ipv4Address nextHop(0x0a000001 + Draw(5));
+        RoutingTableEntry a;
+        RoutingTableEntry b;
+        switch (Draw(6))
+        {
+        case 0: {
+            Time lifetime = MilliSeconds(static_cast<int64_t>(Draw(3000)) - 200);
+            Ptr<NetDevice> dev;
+            RoutingTableEntry rtA(dev, dst, true, 1, Ipv4InterfaceAddress(), 1, nextHop, lifetime);
+            RoutingTableEntry rtB(dev, dst, true, 1, Ipv4InterfaceAddress(), 1, nextHop, lifetime);
+            bool added = m_map.AddRoute(rtA);
+            NS_TEST_EXPECT_MSG_EQ(m_hash.AddRoute(rtB), added, "AddRoute");
+            break;
+        }
+        case 1: {
+            bool found = m_map.LookupRoute(dst, a);
+            NS_TEST_EXPECT_MSG_EQ(m_hash.LookupRoute(dst, b), found, "LookupRoute");
+            if (found)
+            {
+                NS_TEST_EXPECT_MSG_EQ(a.GetFlag(), b.GetFlag(), "flag");
+                NS_TEST_EXPECT_MSG_EQ(a.GetLifeTime(), b.GetLifeTime(), "lifetime");
+                Time lifetime = MilliSeconds(Draw(2000));
+                a.SetLifeTime(lifetime);
+                b.SetLifeTime(lifetime);
+                if (Draw(2))
+                {
+                    a.SetNextHop(nextHop);
+                    b.SetNextHop(nextHop);
+                }
+                bool updated = m_map.Update(a);
+                NS_TEST_EXPECT_MSG_EQ(m_hash.Update(b), updated, "Update");
+            }
+            break;
+        }
+        case 2: {
+            RouteFlags state = static_cast<RouteFlags>(Draw(3));
+            bool set = m_map.SetEntryState(dst, state);
+            NS_TEST_EXPECT_MSG_EQ(m_hash.SetEntryState(dst, state), set, "SetEntryState");
+            break;
+        }
+        case 3: {
+            bool deleted = m_map.DeleteRoute(dst);
+            NS_TEST_EXPECT_MSG_EQ(m_hash.DeleteRoute(dst), deleted, "DeleteRoute");
+            break;
+        }
+        case 4: {
+            std::map<Ipv4Address, uint32_t> unreachableA;
+            std::map<Ipv4Address, uint32_t> unreachableB;
+            m_map.GetListOfDestinationWithNextHop(nextHop, unreachableA);
+            m_hash.GetListOfDestinationWithNextHop(nextHop, unreachableB);
+            NS_TEST_EXPECT_MSG_EQ((unreachableA == unreachableB),
+                                  true,
+                                  "GetListOfDestinationWithNextHop");
+            // The next hop index must agree with a lookup of every destination
+            std::map<Ipv4Address, uint32_t> expected;
+            for (uint32_t k = 0; k < 40; ++k)
+            {
+                Ipv4Address candidate(0x0a000001 + k);
+                if (m_map.LookupRoute(candidate, a) && a.GetNextHop() == nextHop)
+                {
+                    expected.insert(std::make_pair(candidate, a.GetSeqNo()));
+                }
+            }
+            NS_TEST_EXPECT_MSG_EQ((unreachableA == expected), true, "Next hop index out of date");
+            m_map.InvalidateRoutesWithDst(unreachableA);
+            m_hash.InvalidateRoutesWithDst(unreachableB);
+            break;
+        }
+        default: {
+            bool marked = m_map.MarkLinkAsUnidirectional(dst, Seconds(1));
+            NS_TEST_EXPECT_MSG_EQ(m_hash.MarkLinkAsUnidirectional(dst, Seconds(1)),
+                                  marked,
+                                  "MarkLinkAsUnidirectional");
+            break;
+        }
+        }
+        std::ostringstream dumpA;
+        std::ostringstream dumpB;
+        m_map.Print(Create<OutputStreamWrapper>(&dumpA));
+        m_hash.Print(Create<OutputStreamWrapper>(&dumpB));
+        NS_TEST_EXPECT_MSG_EQ(dumpA.str(), dumpB.str(), "Tables diverged");
+    }
+
+    /// Routing table with the ORDERED_MAP backend
+    RoutingTable m_map;
+    /// Routing table with the HASH_TABLE backend
+    RoutingTable m_hash;
+    /// State of the pseudo-random generator
+    uint32_t m_state;
+};
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief SmallVector test case
+ */
+class greyattackaodvSmallVectorTest : public TestCase
+{
+  public:
+    greyattackaodvSmallVectorTest()
+        : TestCase("SmallVector")
+    {
+    }
+
+    void DoRun() override
+    {
+        SmallVector<uint32_t, 2> v;
+        NS_TEST_EXPECT_MSG_EQ(v.IsEmpty(), true, "Empty");
+        for (uint32_t i = 0; i < 5; ++i)
+        {
+            v.PushBack(i);
+        }
+        NS_TEST_EXPECT_MSG_EQ(v.GetSize(), 5, "Spilled elements are kept");
+        v.Erase(1);
+        v.Erase(2);
+        NS_TEST_EXPECT_MSG_EQ(v.GetSize(), 3, "Two elements erased");
+        NS_TEST_EXPECT_MSG_EQ(v[0], 0, "Order is kept");
+        NS_TEST_EXPECT_MSG_EQ(v[1], 2, "Order is kept");
+        NS_TEST_EXPECT_MSG_EQ(v[2], 4, "Order is kept");
+        SmallVector<uint32_t, 2> copy = v;
+        v.Clear();
+        NS_TEST_EXPECT_MSG_EQ(v.IsEmpty(), true, "Cleared");
+        NS_TEST_EXPECT_MSG_EQ(copy[2], 4, "Copies are independent");
+    }
+};
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Attack strategy test case
+ */
+class greyattackaodvAttackStrategyTest : public TestCase
+{
+  public:
+    greyattackaodvAttackStrategyTest()
+        : TestCase("AttackStrategy")
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /**
+     * Ask the composite strategy for a decision
+     * \param expected the expected decision
+     */
+    void CheckWindow(bool expected);
+    /**
+     * Set a connection strength during the run and ask the neighbours
+     * strategy for a decision
+     * \param strength the connection strength of node 3
+     * \param expected the expected decision
+     */
+    void CheckSetStrength(float strength, bool expected);
+    /**
+     * Build the context of a packet
+     * \param size the packet size
+     * \param nextHop the next hop
+     * \returns the context
+     */
+    AttackContext MakeContext(uint32_t size, Ipv4Address nextHop);
+
+    /// Route of the packets
+    RoutingTableEntry m_route;
+    /// Time window AND select strategy
+    Ptr<AndAttackStrategy> m_window;
+    /// Neighbours strategy
+    Ptr<AttackStrategy> m_neighbours;
+    /// Connection strengths read by m_neighbours
+    Ptr<TargetNodes> m_targetNodes;
+};
+
+AttackContext
+greyattackaodvAttackStrategyTest::MakeContext(uint32_t size, Ipv4Address nextHop)
+{
+    AttackContext ctx;
+    ctx.packetId = 1;
+    ctx.packetSize = size;
+    ctx.nextHop = nextHop;
+    ctx.route = &m_route;
+    ctx.precursor = m_route.GetPrecursor(m_route.GetNPrecursors() - 1);
+    ctx.precursorNode = m_route.GetPrecursorNode(m_route.GetNPrecursors() - 1);
+    return ctx;
+}
+
+void
+greyattackaodvAttackStrategyTest::CheckWindow(bool expected)
+{
+    AttackContext ctx = MakeContext(500, Ipv4Address("10.0.0.3"));
+    bool drop = m_window->Decide(ctx);
+    NS_TEST_EXPECT_MSG_EQ(drop, expected, "Drop window at " << Simulator::Now().As(Time::S));
+}
+
+void
+greyattackaodvAttackStrategyTest::CheckSetStrength(float strength, bool expected)
+{
+    m_targetNodes->SetConnectionStrength(3, strength);
+    AttackContext ctx = MakeContext(500, Ipv4Address("10.0.0.3"));
+    bool drop = m_neighbours->Decide(ctx);
+    NS_TEST_EXPECT_MSG_EQ(drop, expected, "Strength set at " << Simulator::Now().As(Time::S));
+}
+
+void
+greyattackaodvAttackStrategyTest::DoRun()
+{
+    // Node i owns 10.0.0.(i+1)
+    NodeContainer nodes;
+    nodes.Create(4);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    SimpleNetDeviceHelper simple;
+    NetDeviceContainer devices = simple.Install(nodes);
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.0");
+    address.Assign(devices);
+    NS_TEST_EXPECT_MSG_EQ(Ipv4NodeIndex::Lookup(Ipv4Address("10.0.0.3")), 2U, "Node id");
+    NS_TEST_EXPECT_MSG_EQ(Ipv4NodeIndex::Lookup(Ipv4Address("10.0.1.3")),
+                          Ipv4NodeIndex::NOT_FOUND,
+                          "Unknown address");
+    NS_TEST_EXPECT_MSG_EQ(Ipv4NodeIndex::Lookup(Ipv4Address::GetLoopback()),
+                          Ipv4NodeIndex::NOT_FOUND,
+                          "Loopback is not indexed");
+
+    m_route.InsertPrecursor(Ipv4Address("10.0.0.1"));
+    m_route.InsertPrecursor(Ipv4Address("10.0.0.2"));
+    NS_TEST_EXPECT_MSG_EQ(m_route.GetPrecursorNode(1), 1U, "Precursor node id");
+
+    Ptr<TargetNodes> targetNodes = CreateObject<TargetNodes>();
+    targetNodes->SetConnectionStrength(1, 0.5);
+    targetNodes->SetConnectionStrength(2, 2.0);
+    AttackEnvironment env;
+    env.rng = CreateObject<UniformRandomVariable>();
+    env.targetNodes = targetNodes;
+    env.nNodes = 4;
+    env.startDelay = Seconds(1);
+    env.nodeId = 0;
+
+    Ptr<AttackStrategy> perc =
+        CreateObjectWithAttributes<PercentAttackStrategy>("DropProbability", DoubleValue(1.0));
+    perc->Install(env);
+    AttackContext ctx = MakeContext(500, Ipv4Address("10.0.0.3"));
+    bool drop = perc->Decide(ctx);
+    NS_TEST_EXPECT_MSG_EQ(drop, true, "Large packet dropped");
+    ctx = MakeContext(100, Ipv4Address("10.0.0.3"));
+    drop = perc->Decide(ctx);
+    NS_TEST_EXPECT_MSG_EQ(drop, false, "Small packet forwarded");
+    NS_TEST_EXPECT_MSG_EQ(perc->IsSilentDrop(), true, "Percent drops are silent");
+    NS_TEST_EXPECT_MSG_EQ(perc->GetKind(), PACKET_DROP_PERC, "Legacy kind");
+
+    // The first precursor with a known connection is charged with the drop
+    Ptr<AttackStrategy> connection =
+        CreateObjectWithAttributes<ConnectionAttackStrategy>("Threshold", DoubleValue(1.0));
+    connection->Install(env);
+    ctx = MakeContext(500, Ipv4Address("10.0.0.3"));
+    drop = connection->Decide(ctx);
+    NS_TEST_EXPECT_MSG_EQ(drop, true, "Poorly connected precursor");
+    NS_TEST_EXPECT_MSG_EQ(ctx.precursorNode, 1U, "Charged precursor");
+    NS_TEST_EXPECT_MSG_EQ(ctx.precursor, Ipv4Address("10.0.0.2"), "Charged precursor");
+    ctx = MakeContext(500, Ipv4Address("10.0.0.4"));
+    drop = connection->Decide(ctx);
+    NS_TEST_EXPECT_MSG_EQ(drop, false, "Next hop not connected");
+
+    Ptr<AttackStrategy> neighbours =
+        CreateObjectWithAttributes<NeighboursAttackStrategy>("Threshold", UintegerValue(3));
+    neighbours->Install(env);
+    m_neighbours = neighbours;
+    m_targetNodes = targetNodes;
+    ctx = MakeContext(500, Ipv4Address("10.0.0.3"));
+    drop = neighbours->Decide(ctx);
+    NS_TEST_EXPECT_MSG_EQ(drop, true, "Three poorly connected neighbours");
+    targetNodes->SetConnectionStrength(0, 2.0);
+    drop = neighbours->Decide(ctx);
+    NS_TEST_EXPECT_MSG_EQ(drop, false, "Count updated with the connection strength");
+    targetNodes->SetConnectionStrength(0, 0.0);
+
+    Ptr<SelectAttackStrategy> select =
+        CreateObjectWithAttributes<SelectAttackStrategy>("SelectChance", DoubleValue(1.0));
+    Ptr<TimeWindowAttackStrategy> window =
+        CreateObjectWithAttributes<TimeWindowAttackStrategy>("DropChance", DoubleValue(1.0));
+    m_window = CreateObject<AndAttackStrategy>();
+    m_window->Add(window);
+    m_window->Add(select);
+    m_window->Install(env);
+    NS_TEST_EXPECT_MSG_EQ(m_window->GetKind(), PACKET_DROP_IN_TIME, "Kind of the first operand");
+    Simulator::Schedule(MilliSeconds(500),
+                        &greyattackaodvAttackStrategyTest::CheckWindow,
+                        this,
+                        false);
+    Simulator::Schedule(Seconds(2), &greyattackaodvAttackStrategyTest::CheckWindow, this, true);
+    // Scripts refresh the strengths during the run
+    Simulator::Schedule(MilliSeconds(1200),
+                        &greyattackaodvAttackStrategyTest::CheckSetStrength,
+                        this,
+                        2.0,
+                        false);
+    Simulator::Schedule(MilliSeconds(1400),
+                        &greyattackaodvAttackStrategyTest::CheckSetStrength,
+                        this,
+                        0.0,
+                        true);
+    Simulator::Stop(Seconds(3));
+    Simulator::Run();
+    m_window->Dispose();
+    m_window = nullptr;
+    m_neighbours = nullptr;
+    m_targetNodes = nullptr;
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Drop windows and selections replayed from a saved attack schedule
+ */
+class greyattackaodvAttackScheduleTest : public TestCase
+{
+  public:
+    greyattackaodvAttackScheduleTest()
+        : TestCase("AttackSchedule")
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /**
+     * Record the decisions of the time window strategies
+     */
+    void Sample();
+
+    /// Time window strategies drawing each window, generating and replaying a schedule
+    Ptr<AttackStrategy> m_strategies[3];
+    /// Decisions of each strategy
+    std::vector<bool> m_decisions[3];
+};
+
+void
+greyattackaodvAttackScheduleTest::Sample()
+{
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        AttackContext ctx;
+        ctx.packetSize = 500;
+        ctx.precursorNode = 1;
+        m_decisions[i].push_back(m_strategies[i]->Decide(ctx));
+    }
+}
+
+void
+greyattackaodvAttackScheduleTest::DoRun()
+{
+    Ptr<AttackSchedule> schedule =
+        CreateObjectWithAttributes<AttackSchedule>("Duration", TimeValue(Seconds(60)));
+    AttackEnvironment env;
+    env.nNodes = 20;
+    env.startDelay = Seconds(1);
+    env.nodeId = 3;
+
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        env.rng = CreateObject<UniformRandomVariable>();
+        env.rng->SetStream(5);
+        m_strategies[i] =
+            CreateObjectWithAttributes<TimeWindowAttackStrategy>("DropChance", DoubleValue(0.5));
+        if (i)
+        {
+            m_strategies[i]->SetAttribute("Schedule", PointerValue(schedule));
+        }
+        m_strategies[i]->Install(env);
+    }
+    env.rng = CreateObject<UniformRandomVariable>();
+    env.rng->SetStream(6);
+    Ptr<AttackStrategy> select =
+        CreateObjectWithAttributes<SelectAttackStrategy>("SelectChance",
+                                                         DoubleValue(0.5),
+                                                         "Schedule",
+                                                         PointerValue(schedule));
+    select->Install(env);
+    NS_TEST_EXPECT_MSG_EQ(schedule->GetSelection(3).size(), 20, "One draw per node");
+
+    std::string filename = CreateTempDirFilename("attack-schedule.bin");
+    schedule->Save(filename);
+    Ptr<AttackSchedule> loaded = CreateObject<AttackSchedule>();
+    loaded->Load(filename);
+    NS_TEST_EXPECT_MSG_EQ((loaded->GetTransitions(3) == schedule->GetTransitions(3)),
+                          true,
+                          "Transitions loaded");
+    NS_TEST_EXPECT_MSG_EQ((loaded->GetSelection(3) == schedule->GetSelection(3)),
+                          true,
+                          "Selection loaded");
+    NS_TEST_EXPECT_MSG_EQ(loaded->HasWindows(4), false, "Only the saved nodes are loaded");
+
+    // Replaying draws nothing, so any random variable will do
+    env.rng = CreateObject<UniformRandomVariable>();
+    env.rng->SetStream(7);
+    m_strategies[2] =
+        CreateObjectWithAttributes<TimeWindowAttackStrategy>("DropChance",
+                                                             DoubleValue(0.5),
+                                                             "Schedule",
+                                                             PointerValue(loaded));
+    m_strategies[2]->Install(env);
+    Ptr<AttackStrategy> replayedSelect =
+        CreateObjectWithAttributes<SelectAttackStrategy>("Schedule", PointerValue(loaded));
+    replayedSelect->Install(env);
+    for (uint32_t node = 0; node < 20; ++node)
+    {
+        AttackContext ctx;
+        ctx.packetSize = 500;
+        ctx.precursorNode = node;
+        bool expected = select->Decide(ctx);
+        bool replayed = replayedSelect->Decide(ctx);
+        NS_TEST_EXPECT_MSG_EQ(replayed, expected, "Selection of node " << node);
+    }
+
+    for (uint32_t window = 0; window < 12; ++window)
+    {
+        Simulator::Schedule(Seconds(3.5) + Seconds(5) * window,
+                            &greyattackaodvAttackScheduleTest::Sample,
+                            this);
+    }
+    Simulator::Stop(Seconds(60));
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ((m_decisions[1] == m_decisions[0]),
+                          true,
+                          "Scheduled windows match the windows drawn while running");
+    NS_TEST_EXPECT_MSG_EQ((m_decisions[2] == m_decisions[0]),
+                          true,
+                          "Loaded windows match the windows drawn while running");
+    NS_TEST_EXPECT_MSG_EQ(std::count(m_decisions[0].begin(), m_decisions[0].end(), true) > 0,
+                          true,
+                          "Some drop windows");
+    NS_TEST_EXPECT_MSG_LT(schedule->GetTransitions(3).size(), 13, "At most one event per window");
+    for (auto& strategy : m_strategies)
+    {
+        strategy->Dispose();
+        strategy = nullptr;
+    }
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Network-wide drop matrix
+ */
+class greyattackaodvAttackObservatoryTest : public TestCase
+{
+  public:
+    greyattackaodvAttackObservatoryTest()
+        : TestCase("AttackObservatory")
+    {
+    }
+
+    void DoRun() override;
+};
+
+void
+greyattackaodvAttackObservatoryTest::DoRun()
+{
+    Ptr<AttackObservatory> observatory = AttackObservatory::Get();
+    NS_TEST_EXPECT_MSG_EQ(AttackObservatory::Get(), observatory, "Single observatory");
+    observatory->SetAttribute("BucketWidth", TimeValue(Seconds(1)));
+    std::string prefix = CreateTempDirFilename("observatory");
+    observatory->EnableSnapshots(Seconds(1), prefix);
+
+    Simulator::Schedule(MilliSeconds(500), &AttackObservatory::RecordDrop, observatory, 2, 0);
+    Simulator::Schedule(MilliSeconds(1500),
+                        &AttackObservatory::RecordDrop,
+                        observatory,
+                        2,
+                        uint32_t(Ipv4NodeIndex::NOT_FOUND));
+    // A new node grows the matrix
+    Simulator::Schedule(MilliSeconds(2500), &AttackObservatory::RecordDrop, observatory, 5, 3);
+    Simulator::Stop(Seconds(2.9));
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetNNodes(), 6, "Precursors covered");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetNAttackers(), 2, "One row per attacker");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetAttackerNode(0), 2, "Rows in order of first drop");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetAttackerNode(1), 5, "Rows in order of first drop");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetNBuckets(), 3, "Buckets up to the last drop");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetDrops(0, 2, 0), 1, "Drop kept across growth");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetDrops(1, 2, Ipv4NodeIndex::NOT_FOUND),
+                          1,
+                          "Unknown precursor kept across growth");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetDrops(2, 5, 3), 1, "Drop after growth");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetDrops(7, 2, 0), 0, "Bucket past the end");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetAttackerDrops(2, Seconds(0), Seconds(3)),
+                          2,
+                          "Attacker drops");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetAttackerDrops(2, Seconds(1), Seconds(3)),
+                          1,
+                          "Attacker drops in a time range");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetPrecursorDrops(3, Seconds(0), Seconds(3)),
+                          1,
+                          "Precursor drops");
+    NS_TEST_EXPECT_MSG_EQ(std::ifstream(prefix + "-0.bin").good(), true, "First snapshot");
+    NS_TEST_EXPECT_MSG_EQ(std::ifstream(prefix + "-1.bin").good(), true, "Second snapshot");
+
+    // Without a stop time, the run ends with the snapshot taken once nothing else is scheduled
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(Simulator::Now(), Seconds(3), "Run ended by the last snapshot");
+    NS_TEST_EXPECT_MSG_EQ(std::ifstream(prefix + "-2.bin").good(), true, "Last snapshot");
+    NS_TEST_EXPECT_MSG_EQ(std::ifstream(prefix + "-3.bin").good(), false, "No more snapshots");
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Drop matrix of a network with few attackers among many nodes
+ */
+class greyattackaodvAttackObservatoryRowsTest : public TestCase
+{
+  public:
+    greyattackaodvAttackObservatoryRowsTest()
+        : TestCase("AttackObservatory attacker rows")
+    {
+    }
+
+    void DoRun() override;
+};
+
+void
+greyattackaodvAttackObservatoryRowsTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(50);
+    Ptr<AttackObservatory> observatory = AttackObservatory::Get();
+    observatory->SetAttribute("BucketWidth", TimeValue(Seconds(1)));
+
+    Simulator::Schedule(MilliSeconds(500), &AttackObservatory::RecordDrop, observatory, 40, 3);
+    Simulator::Schedule(MilliSeconds(1500), &AttackObservatory::RecordDrop, observatory, 7, 49);
+    Simulator::Schedule(MilliSeconds(1600), &AttackObservatory::RecordDrop, observatory, 40, 7);
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetNNodes(), 50, "Precursor columns for all nodes");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetNAttackers(), 2, "Rows for the attackers only");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetNCells(),
+                          uint64_t(observatory->GetNBuckets()) * 2 * (50 + 1),
+                          "Matrix proportional to the attackers");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetAttackerNode(0), 40, "First attacker row");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetAttackerNode(1), 7, "Second attacker row");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetDrops(0, 40, 3), 1, "Drop kept across a new row");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetDrops(1, 7, 49), 1, "Drop of the second row");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetDrops(1, 40, 7), 1, "Drop of the first row");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetDrops(1, 3, 7), 0, "Node that never dropped");
+    NS_TEST_EXPECT_MSG_EQ(observatory->GetAttackerDrops(40, Seconds(0), Seconds(2)),
+                          2,
+                          "Attacker drops");
+
+    // Header, row to node id map, then the counters
+    std::string filename = CreateTempDirFilename("observatory-rows.bin");
+    observatory->Save(filename);
+    std::ifstream is(filename, std::ios::binary | std::ios::ate);
+    NS_TEST_EXPECT_MSG_EQ(uint64_t(is.tellg()),
+                          25 + 2 * 4 + observatory->GetNCells() * 4,
+                          "File size proportional to the attackers");
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Check that packets sent while no route exists are queued and
+ * delivered once the route is found, with and without the deferred route
+ * fast path, and that the fast path sends them to the loopback untagged
+ */
+class greyattackaodvDeferredRouteTest : public TestCase
+{
+  public:
+    /**
+     * constructor
+     * \param fastPath value of the DeferredRouteFastPath attribute
+     */
+    greyattackaodvDeferredRouteTest(bool fastPath)
+        : TestCase(fastPath ? "Deferred route output (fast path)" : "Deferred route output"),
+          m_fastPath(fastPath),
+          m_received(0),
+          m_looped(0),
+          m_tagged(0)
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /**
+     * Count the packets sent to the loopback, and those carrying a
+     * DeferredRouteOutputTag
+     * \param packet the packet, with its IP header
+     * \param ipv4 the IPv4 stack
+     * \param interface the output interface
+     */
+    void Tx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+    /**
+     * Send a burst of packets
+     * \param socket the sending socket
+     * \param dst the destination
+     */
+    void SendBurst(Ptr<Socket> socket, Ipv4Address dst);
+    /**
+     * Receive packets
+     * \param socket the receiving socket
+     */
+    void Receive(Ptr<Socket> socket);
+
+    /// Value of the DeferredRouteFastPath attribute
+    bool m_fastPath;
+    /// Number of received packets
+    uint32_t m_received;
+    /// Number of packets sent to the loopback
+    uint32_t m_looped;
+    /// Number of packets sent to the loopback with a DeferredRouteOutputTag
+    uint32_t m_tagged;
+};
+
+void
+greyattackaodvDeferredRouteTest::Tx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+    if (ipv4->GetNetDevice(interface)->GetInstanceTypeId() != LoopbackNetDevice::GetTypeId())
+    {
+        return;
+    }
+    ++m_looped;
+    TypeId tagType = TypeId::LookupByName("ns3::greyattackaodv::DeferredRouteOutputTag");
+    PacketTagIterator i = packet->GetPacketTagIterator();
+    while (i.HasNext())
+    {
+        if (i.Next().GetTypeId() == tagType)
+        {
+            ++m_tagged;
+        }
+    }
+}
+
+void
+greyattackaodvDeferredRouteTest::SendBurst(Ptr<Socket> socket, Ipv4Address dst)
+{
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        socket->SendTo(Create<Packet>(100), 0, InetSocketAddress(dst, 9));
+    }
+}
+
+void
+greyattackaodvDeferredRouteTest::Receive(Ptr<Socket> socket)
+{
+    while (socket->Recv())
+    {
+        ++m_received;
+    }
+}
+
+void
+greyattackaodvDeferredRouteTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(3);
+    greyattackaodvHelper greyattackaodv;
+    greyattackaodv.Set("DeferredRouteFastPath", BooleanValue(m_fastPath));
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(greyattackaodv);
+    internet.Install(nodes);
+    SimpleNetDeviceHelper simple;
+    NetDeviceContainer devices = simple.Install(nodes);
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+
+    Ptr<Socket> rx = Socket::CreateSocket(nodes.Get(2), UdpSocketFactory::GetTypeId());
+    rx->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+    rx->SetRecvCallback(MakeCallback(&greyattackaodvDeferredRouteTest::Receive, this));
+    nodes.Get(0)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+        "Tx",
+        MakeCallback(&greyattackaodvDeferredRouteTest::Tx, this));
+    Ptr<Socket> tx = Socket::CreateSocket(nodes.Get(0), UdpSocketFactory::GetTypeId());
+    Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                   Seconds(1),
+                                   &greyattackaodvDeferredRouteTest::SendBurst,
+                                   this,
+                                   tx,
+                                   interfaces.GetAddress(2));
+    Simulator::Stop(Seconds(5));
+    Simulator::Run();
+    tx->Close();
+    rx->Close();
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(m_received, 5, "Burst queued during route discovery delivered");
+    NS_TEST_EXPECT_MSG_EQ(m_looped, 5, "Burst sent to the loopback");
+    NS_TEST_EXPECT_MSG_EQ(m_tagged,
+                          (m_fastPath ? 0 : 5),
+                          "DeferredRouteOutputTag only without the fast path");
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief RERR coalescing test
+ *
+ * A source reaches two destinations through a relay.  Both links of the
+ * relay to the destinations break at the same time, so that the relay
+ * detects both breaks together: it sends one RERR per broken link without
+ * coalescing, and a single RERR listing both destinations with it.  The
+ * result must not change when the timers run on TimerWheels.
+ */
+class greyattackaodvRerrCoalescingTest : public TestCase
+{
+  public:
+    /**
+     * constructor
+     * \param window value of the RerrCoalescingWindow attribute
+     * \param timerWheel run the timers on TimerWheels
+     */
+    greyattackaodvRerrCoalescingTest(Time window, bool timerWheel = false)
+        : TestCase(std::string(window.IsZero() ? "RERR without coalescing" : "RERR coalescing") +
+                   (timerWheel ? " on a timer wheel" : "")),
+          m_window(window),
+          m_timerWheel(timerWheel),
+          m_rerrs(0),
+          m_unreachable(0)
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /**
+     * Send one packet to each destination
+     * \param socket the sending socket
+     * \param interfaces node addresses
+     */
+    void Send(Ptr<Socket> socket, Ipv4InterfaceContainer interfaces);
+    /**
+     * Break the links between the relay and the destinations
+     * \param devices node devices
+     */
+    void BreakLinks(NetDeviceContainer devices);
+    /**
+     * Count the RERRs sent by the relay
+     * \param packet the packet, with its IP header
+     * \param ipv4 the IPv4 stack
+     * \param interface the output interface
+     */
+    void Tx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+
+    /// Value of the RerrCoalescingWindow attribute
+    Time m_window;
+    /// Run the timers on TimerWheels
+    bool m_timerWheel;
+    /// Number of RERR messages sent by the relay
+    uint32_t m_rerrs;
+    /// Number of unreachable destinations in these messages
+    uint32_t m_unreachable;
+};
+
+void
+greyattackaodvRerrCoalescingTest::Send(Ptr<Socket> socket, Ipv4InterfaceContainer interfaces)
+{
+    socket->SendTo(Create<Packet>(100), 0, InetSocketAddress(interfaces.GetAddress(2), 9));
+    socket->SendTo(Create<Packet>(100), 0, InetSocketAddress(interfaces.GetAddress(3), 9));
+}
+
+void
+greyattackaodvRerrCoalescingTest::BreakLinks(NetDeviceContainer devices)
+{
+    Ptr<SimpleChannel> channel = DynamicCast<SimpleChannel>(devices.Get(0)->GetChannel());
+    Ptr<SimpleNetDevice> relay = DynamicCast<SimpleNetDevice>(devices.Get(1));
+    for (uint32_t i = 2; i < 4; ++i)
+    {
+        Ptr<SimpleNetDevice> dst = DynamicCast<SimpleNetDevice>(devices.Get(i));
+        channel->BlackList(relay, dst);
+        channel->BlackList(dst, relay);
+    }
+}
+
+void
+greyattackaodvRerrCoalescingTest::Tx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+    Ptr<Packet> p = packet->Copy();
+    Ipv4Header ipHeader;
+    p->RemoveHeader(ipHeader);
+    UdpHeader udpHeader;
+    if (ipHeader.GetProtocol() != UdpL4Protocol::PROT_NUMBER || !p->RemoveHeader(udpHeader) ||
+        udpHeader.GetDestinationPort() != RoutingProtocol::greyattack_aodv_PORT)
+    {
+        return;
+    }
+    TypeHeader typeHeader;
+    p->RemoveHeader(typeHeader);
+    if (typeHeader.Get() != greyattack_aodvTYPE_RERR)
+    {
+        return;
+    }
+    RerrHeader rerrHeader;
+    p->RemoveHeader(rerrHeader);
+    ++m_rerrs;
+    m_unreachable += rerrHeader.GetDestCount();
+}
+
+void
+greyattackaodvRerrCoalescingTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(4);
+    greyattackaodvHelper greyattackaodv;
+    greyattackaodv.Set("RerrCoalescingWindow", TimeValue(m_window));
+    if (m_timerWheel)
+    {
+        greyattackaodv.EnableTimerWheel();
+    }
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(greyattackaodv);
+    internet.Install(nodes);
+    SimpleNetDeviceHelper simple;
+    NetDeviceContainer devices = simple.Install(nodes);
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+
+    // Node 0 reaches the destinations 2 and 3 through the relay 1
+    Ptr<SimpleChannel> channel = DynamicCast<SimpleChannel>(devices.Get(0)->GetChannel());
+    Ptr<SimpleNetDevice> src = DynamicCast<SimpleNetDevice>(devices.Get(0));
+    for (uint32_t i = 2; i < 4; ++i)
+    {
+        Ptr<SimpleNetDevice> dst = DynamicCast<SimpleNetDevice>(devices.Get(i));
+        channel->BlackList(src, dst);
+        channel->BlackList(dst, src);
+    }
+    nodes.Get(1)->GetObject<Ipv4L3Protocol>()->TraceConnectWithoutContext(
+        "Tx",
+        MakeCallback(&greyattackaodvRerrCoalescingTest::Tx, this));
+
+    Ptr<Socket> tx = Socket::CreateSocket(nodes.Get(0), UdpSocketFactory::GetTypeId());
+    // Forwarding keeps both next hops alive for ActiveRouteTimeout after the
+    // last packet, so that the relay detects both breaks together
+    for (uint32_t i = 0; i < 20; ++i)
+    {
+        Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                       Seconds(1) + MilliSeconds(100) * i,
+                                       &greyattackaodvRerrCoalescingTest::Send,
+                                       this,
+                                       tx,
+                                       interfaces);
+    }
+    Simulator::Schedule(Seconds(3), &greyattackaodvRerrCoalescingTest::BreakLinks, this, devices);
+    Simulator::Stop(Seconds(8));
+    Simulator::Run();
+    tx->Close();
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(m_unreachable, 2, "Both destinations reported unreachable");
+    NS_TEST_EXPECT_MSG_EQ(m_rerrs, (m_window.IsZero() ? 2 : 1), "Number of RERR messages");
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Interface sockets test
+ *
+ * The receiver interface goes down and up, then loses and gets back its
+ * address; greyattackaodv must reopen its sockets each time.
+ */
+class greyattackaodvInterfaceSocketsTest : public TestCase
+{
+  public:
+    greyattackaodvInterfaceSocketsTest()
+        : TestCase("Interface sockets follow interface and address changes"),
+          m_received(0)
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /**
+     * Send a burst of packets
+     * \param socket the sending socket
+     * \param dst the destination
+     */
+    void SendBurst(Ptr<Socket> socket, Ipv4Address dst);
+    /**
+     * Receive packets
+     * \param socket the receiving socket
+     */
+    void Receive(Ptr<Socket> socket);
+
+    /// Number of received packets
+    uint32_t m_received;
+};
+
+void
+greyattackaodvInterfaceSocketsTest::SendBurst(Ptr<Socket> socket, Ipv4Address dst)
+{
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        socket->SendTo(Create<Packet>(100), 0, InetSocketAddress(dst, 9));
+    }
+}
+
+void
+greyattackaodvInterfaceSocketsTest::Receive(Ptr<Socket> socket)
+{
+    while (socket->Recv())
+    {
+        ++m_received;
+    }
+}
+
+void
+greyattackaodvInterfaceSocketsTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(2);
+    greyattackaodvHelper greyattackaodv;
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(greyattackaodv);
+    internet.Install(nodes);
+    SimpleNetDeviceHelper simple;
+    NetDeviceContainer devices = simple.Install(nodes);
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+
+    Ptr<Socket> rx = Socket::CreateSocket(nodes.Get(1), UdpSocketFactory::GetTypeId());
+    rx->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+    rx->SetRecvCallback(MakeCallback(&greyattackaodvInterfaceSocketsTest::Receive, this));
+    Ptr<Socket> tx = Socket::CreateSocket(nodes.Get(0), UdpSocketFactory::GetTypeId());
+    Ipv4Address dst = interfaces.GetAddress(1);
+    for (uint32_t i = 1; i < 8; i += 3)
+    {
+        Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                       Seconds(i),
+                                       &greyattackaodvInterfaceSocketsTest::SendBurst,
+                                       this,
+                                       tx,
+                                       dst);
+    }
+    Ptr<Ipv4> ipv4 = nodes.Get(1)->GetObject<Ipv4>();
+    uint32_t interface = interfaces.Get(1).second;
+    Ipv4InterfaceAddress iface = ipv4->GetAddress(interface, 0);
+    Simulator::Schedule(Seconds(2), &Ipv4::SetDown, ipv4, interface);
+    Simulator::Schedule(Seconds(3), &Ipv4::SetUp, ipv4, interface);
+    Simulator::Schedule(Seconds(5),
+                        static_cast<bool (Ipv4::*)(uint32_t, uint32_t)>(&Ipv4::RemoveAddress),
+                        ipv4,
+                        interface,
+                        0);
+    Simulator::Schedule(Seconds(6), &Ipv4::AddAddress, ipv4, interface, iface);
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+    tx->Close();
+    rx->Close();
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(m_received, 15, "Packets delivered after each interface change");
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief TimerWheel test
+ *
+ * Timers on every level of the wheel and beyond it expire at their delay
+ * rounded up to the resolution, in order, unless cancelled.  Timers due in
+ * the same tick share one simulator event, run in the context of the wheel,
+ * and ticks left without timers by cancellations cost no event.
+ */
+class greyattackaodvTimerWheelTest : public TestCase
+{
+  public:
+    greyattackaodvTimerWheelTest()
+        : TestCase("TimerWheel")
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /**
+     * Schedule the timers, between two ticks
+     * \param delays the timer delays
+     */
+    void Start(std::vector<Time> delays);
+    /**
+     * Schedule three timers from the context of the wheel, and cancel the
+     * first and the last one
+     */
+    void StartCancel();
+    /**
+     * Record an expiration
+     * \param index the timer index
+     */
+    void Fire(uint32_t index);
+
+    /// The wheel
+    Ptr<TimerWheel> m_wheel;
+    /// Expected expiration time of each timer
+    std::vector<Time> m_expected;
+    /// Actual expiration time of each timer, zero if it did not expire
+    std::vector<Time> m_fired;
+    /// Expiration times in the order the timers fired
+    std::vector<Time> m_order;
+    /// Context of each expiration, in the order the timers fired
+    std::vector<uint32_t> m_contexts;
+};
+
+void
+greyattackaodvTimerWheelTest::Start(std::vector<Time> delays)
+{
+    for (uint32_t i = 0; i < delays.size(); ++i)
+    {
+        int64_t expiry = ((Simulator::Now() + delays[i]).GetNanoSeconds() + 999) / 1000;
+        m_expected.push_back(MicroSeconds(expiry));
+        m_fired.push_back(Seconds(0));
+        m_wheel->Schedule(delays[i],
+                          MakeCallback(&greyattackaodvTimerWheelTest::Fire, this).Bind(i));
+    }
+    uint32_t index = m_fired.size();
+    m_fired.push_back(Seconds(0));
+    TimerWheel::TimerId id =
+        m_wheel->Schedule(MicroSeconds(64),
+                          MakeCallback(&greyattackaodvTimerWheelTest::Fire, this).Bind(index));
+    NS_TEST_EXPECT_MSG_EQ(m_wheel->IsPending(id), true, "Timer pending");
+    m_wheel->Cancel(id);
+    NS_TEST_EXPECT_MSG_EQ(m_wheel->IsPending(id), false, "Timer cancelled");
+}
+
+void
+greyattackaodvTimerWheelTest::StartCancel()
+{
+    std::vector<TimerWheel::TimerId> ids;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        ids.push_back(
+            m_wheel->Schedule(MilliSeconds(1 + i),
+                              MakeCallback(&greyattackaodvTimerWheelTest::Fire, this).Bind(i)));
+    }
+    m_wheel->Cancel(ids[0]);
+    m_wheel->Cancel(ids[2]);
+}
+
+void
+greyattackaodvTimerWheelTest::Fire(uint32_t index)
+{
+    m_fired[index] = Simulator::Now();
+    m_order.push_back(Simulator::Now());
+    m_contexts.push_back(Simulator::GetContext());
+}
+
+void
+greyattackaodvTimerWheelTest::DoRun()
+{
+    m_wheel = CreateObject<TimerWheel>();
+    m_wheel->SetAttribute("Resolution", TimeValue(MicroSeconds(1)));
+    // Delays on each level, around slot boundaries and beyond the 2^24 ticks
+    // of the wheel, started half way through a tick
+    std::vector<Time> delays = {Seconds(0),
+                                NanoSeconds(1),
+                                MicroSeconds(1),
+                                MicroSeconds(63),
+                                MicroSeconds(64),
+                                MicroSeconds(65),
+                                MicroSeconds(4095),
+                                MicroSeconds(4097),
+                                MicroSeconds(262143),
+                                MilliSeconds(300),
+                                Seconds(17),
+                                Seconds(40)};
+    Simulator::Schedule(NanoSeconds(1500), &greyattackaodvTimerWheelTest::Start, this, delays);
+    Simulator::Run();
+    Simulator::Destroy();
+
+    for (uint32_t i = 0; i < delays.size(); ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_fired[i], m_expected[i], "Expiration of timer " << i);
+    }
+    NS_TEST_EXPECT_MSG_EQ(m_fired.back(), Seconds(0), "Cancelled timer did not expire");
+    NS_TEST_EXPECT_MSG_EQ(m_order.size(), delays.size(), "Number of expirations");
+    for (uint32_t i = 1; i < m_order.size(); ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ((m_order[i - 1] <= m_order[i]), true, "Expiration order");
+    }
+
+    // 100 timers within 10 ms need 11 ticks of 1 ms
+    m_wheel = CreateObject<TimerWheel>();
+    m_fired.assign(100, Seconds(0));
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        m_wheel->Schedule(MicroSeconds(100 * i),
+                          MakeCallback(&greyattackaodvTimerWheelTest::Fire, this).Bind(i));
+    }
+    Simulator::Run();
+    Simulator::Destroy();
+
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_fired[i],
+                              MilliSeconds((i + 9) / 10),
+                              "Expiration rounded up to the resolution");
+    }
+    NS_TEST_EXPECT_MSG_EQ(m_wheel->GetTicks(), 11, "Timers batched per tick");
+    NS_TEST_EXPECT_MSG_EQ(m_contexts.back(),
+                          Simulator::NO_CONTEXT,
+                          "No context unless one is set");
+
+    // The tick of the first timer, cancelled while its event is armed, and
+    // the tick of the last one are left without timers
+    m_wheel = CreateObject<TimerWheel>();
+    m_wheel->SetContext(7);
+    m_fired.assign(3, Seconds(0));
+    m_contexts.clear();
+    Simulator::ScheduleWithContext(7, Seconds(1), &greyattackaodvTimerWheelTest::StartCancel, this);
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(Simulator::GetEventCount(), 2, "No event for the emptied ticks");
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(m_wheel->GetTicks(), 1, "One tick with timers");
+    NS_TEST_EXPECT_MSG_EQ(m_fired[0], Seconds(0), "Cancelled timer did not expire");
+    NS_TEST_EXPECT_MSG_EQ(m_fired[1], MilliSeconds(1002), "Timer expired");
+    NS_TEST_EXPECT_MSG_EQ(m_fired[2], Seconds(0), "Cancelled timer did not expire");
+    NS_TEST_ASSERT_MSG_EQ(m_contexts.size(), 1, "One expiration");
+    NS_TEST_EXPECT_MSG_EQ(m_contexts[0], 7, "Callback run in the context of the wheel");
+    m_wheel = nullptr;
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Addresses assigned after a lookup are found by the next one, also
+ * through the precursors resolved before the assignment, and devices of
+ * nodes added after a lookup are found by the next one
+ */
+class greyattackaodvNodeIndexTest : public TestCase
+{
+  public:
+    greyattackaodvNodeIndexTest()
+        : TestCase("Node index after a late address assignment")
+    {
+    }
+
+    void DoRun() override;
+};
+
+void
+greyattackaodvNodeIndexTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(2);
+    greyattackaodvHelper greyattackaodv;
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(greyattackaodv);
+    internet.Install(nodes);
+    SimpleNetDeviceHelper simple;
+    NetDeviceContainer devices = simple.Install(nodes);
+
+    NS_TEST_EXPECT_MSG_EQ(Ipv4NodeIndex::Lookup(Ipv4Address("10.0.0.2")),
+                          Ipv4NodeIndex::NOT_FOUND,
+                          "Not assigned yet");
+    RoutingTableEntry route;
+    route.InsertPrecursor(Ipv4Address("10.0.0.2"));
+    NS_TEST_EXPECT_MSG_EQ(route.GetPrecursorNode(0),
+                          Ipv4NodeIndex::NOT_FOUND,
+                          "Precursor not assigned yet");
+
+    // Same simulated time and same nodes: only the assignment tells the index
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.0");
+    address.Assign(devices);
+    NS_TEST_EXPECT_MSG_EQ(Ipv4NodeIndex::Lookup(Ipv4Address("10.0.0.2")), 1U, "Assigned later");
+    NS_TEST_EXPECT_MSG_EQ(route.GetPrecursorNode(0), 1U, "Precursor resolved again");
+    NS_TEST_EXPECT_MSG_EQ(Ipv4NodeIndex::Lookup(Ipv4Address("10.0.1.2")),
+                          Ipv4NodeIndex::NOT_FOUND,
+                          "Foreign address");
+
+    Mac48Address mac = Mac48Address::ConvertFrom(devices.Get(1)->GetAddress());
+    NS_TEST_EXPECT_MSG_EQ(Mac48NodeIndex::Lookup(mac), 1U, "Device address");
+    Ptr<Node> late = CreateObject<Node>();
+    Mac48Address lateMac = Mac48Address::ConvertFrom(simple.Install(late).Get(0)->GetAddress());
+    NS_TEST_EXPECT_MSG_EQ(Mac48NodeIndex::Lookup(lateMac), 2U, "Device of a node added later");
+    NS_TEST_EXPECT_MSG_EQ(Mac48NodeIndex::Lookup(Mac48Address("00:00:00:00:10:00")),
+                          Mac48NodeIndex::NOT_FOUND,
+                          "Foreign device address");
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Grey hole variant test
+ *
+ * A source reaches a destination through a relay.  The helper installs the
+ * plain RoutingProtocol on the relay, or GreyHoleRoutingProtocol after
+ * SetGreyHole (true); the grey hole relay drops every data packet when given
+ * an attack strategy, and forwards them all otherwise.
+ */
+class greyattackaodvGreyHoleTest : public TestCase
+{
+  public:
+    /**
+     * constructor
+     * \param greyHole give the relay a dropping attack strategy
+     * \param shadow record the decisions of shadow strategies on the relay,
+     * which makes it a grey hole, without active strategy unless greyHole
+     */
+    greyattackaodvGreyHoleTest(bool greyHole, bool shadow = false)
+        : TestCase(shadow ? (greyHole ? "Grey hole relay with shadow strategies"
+                                      : "Grey hole relay with shadow strategies only")
+                          : (greyHole ? "Grey hole relay" : "Honest relay")),
+          m_greyHole(greyHole),
+          m_shadow(shadow),
+          m_received(0)
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /**
+     * Send a data packet
+     * \param socket the sending socket
+     * \param dst the destination
+     */
+    void Send(Ptr<Socket> socket, Ipv4Address dst);
+    /**
+     * Receive packets
+     * \param socket the receiving socket
+     */
+    void Receive(Ptr<Socket> socket);
+
+    /// Give the relay a dropping attack strategy
+    bool m_greyHole;
+    /// Record shadow decisions on the relay
+    bool m_shadow;
+    /// Number of received packets
+    uint32_t m_received;
+};
+
+void
+greyattackaodvGreyHoleTest::Send(Ptr<Socket> socket, Ipv4Address dst)
+{
+    // larger than the MinPacketSize of the attack strategies
+    socket->SendTo(Create<Packet>(512), 0, InetSocketAddress(dst, 9));
+}
+
+void
+greyattackaodvGreyHoleTest::Receive(Ptr<Socket> socket)
+{
+    while (socket->Recv())
+    {
+        ++m_received;
+    }
+}
+
+void
+greyattackaodvGreyHoleTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(3);
+    greyattackaodvHelper honest;
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(honest);
+    internet.Install(nodes.Get(0));
+    internet.Install(nodes.Get(2));
+    greyattackaodvHelper relay;
+    relay.SetGreyHole(m_greyHole || m_shadow);
+    if (m_greyHole)
+    {
+        relay.Set("mStrat", UintegerValue(PACKET_DROP_PERC));
+        relay.Set("PercentDrop", DoubleValue(1.0));
+    }
+    Ptr<ShadowDecisionLog> shadowLog = CreateObject<ShadowDecisionLog>();
+    if (m_shadow)
+    {
+        ObjectFactory factory("ns3::greyattackaodv::PercentAttackStrategy");
+        factory.Set("DropProbability", DoubleValue(0.0));
+        shadowLog->AddStrategy(factory);
+        factory.Set("DropProbability", DoubleValue(1.0));
+        shadowLog->AddStrategy(factory);
+        ObjectFactory select("ns3::greyattackaodv::SelectAttackStrategy");
+        select.Set("SelectChance", DoubleValue(1.0));
+        shadowLog->AddStrategy(select);
+        relay.Set("ShadowLog", PointerValue(shadowLog));
+    }
+    internet.SetRoutingHelper(relay);
+    internet.Install(nodes.Get(1));
+    if (m_greyHole)
+    {
+        AttackObservatory::Get();
+    }
+    SimpleNetDeviceHelper simple;
+    NetDeviceContainer devices = simple.Install(nodes);
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+
+    TypeId::AttributeInformation info;
+    NS_TEST_EXPECT_MSG_EQ(RoutingProtocol::GetTypeId().LookupAttributeByName("mStrat", &info),
+                          false,
+                          "Honest nodes have no attack attributes");
+    TypeId expected = (m_greyHole || m_shadow) ? GreyHoleRoutingProtocol::GetTypeId()
+                                               : RoutingProtocol::GetTypeId();
+    NS_TEST_EXPECT_MSG_EQ(nodes.Get(0)->GetObject<RoutingProtocol>()->GetInstanceTypeId(),
+                          RoutingProtocol::GetTypeId(),
+                          "Variant of the source");
+    NS_TEST_EXPECT_MSG_EQ(nodes.Get(1)->GetObject<RoutingProtocol>()->GetInstanceTypeId(),
+                          expected,
+                          "Variant of the relay");
+
+    // Node 0 reaches node 2 through the relay 1
+    Ptr<SimpleChannel> channel = DynamicCast<SimpleChannel>(devices.Get(0)->GetChannel());
+    Ptr<SimpleNetDevice> src = DynamicCast<SimpleNetDevice>(devices.Get(0));
+    Ptr<SimpleNetDevice> dst = DynamicCast<SimpleNetDevice>(devices.Get(2));
+    channel->BlackList(src, dst);
+    channel->BlackList(dst, src);
+
+    Ptr<Socket> rx = Socket::CreateSocket(nodes.Get(2), UdpSocketFactory::GetTypeId());
+    rx->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+    rx->SetRecvCallback(MakeCallback(&greyattackaodvGreyHoleTest::Receive, this));
+    Ptr<Socket> tx = Socket::CreateSocket(nodes.Get(0), UdpSocketFactory::GetTypeId());
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                       Seconds(1) + MilliSeconds(100) * i,
+                                       &greyattackaodvGreyHoleTest::Send,
+                                       this,
+                                       tx,
+                                       interfaces.GetAddress(2));
+    }
+    Simulator::Stop(Seconds(5));
+    Simulator::Run();
+    Ptr<AttackObservatory> observatory = AttackObservatory::Find();
+    uint32_t observed = observatory ? observatory->GetAttackerDrops(1, Seconds(0), Seconds(5)) : 0;
+    tx->Close();
+    rx->Close();
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(m_received, (m_greyHole ? 0 : 10), "Packets delivered through the relay");
+    NS_TEST_EXPECT_MSG_EQ(observed, (m_greyHole ? 10 : 0), "Drops observed network-wide");
+    NS_TEST_EXPECT_MSG_EQ(AttackObservatory::Find(), nullptr, "Observatory dropped on Destroy");
+    if (m_shadow)
+    {
+        NS_TEST_ASSERT_MSG_EQ(shadowLog->GetNRecords(), 10, "One record per forwarded packet");
+        for (uint32_t i = 0; i < shadowLog->GetNRecords(); ++i)
+        {
+            const ShadowDecisionLog::Record& record = shadowLog->GetRecord(i);
+            NS_TEST_EXPECT_MSG_EQ(record.attacker, 1, "Decided by the relay");
+            NS_TEST_EXPECT_MSG_EQ(record.precursorNode, 0, "Precursor");
+            NS_TEST_EXPECT_MSG_EQ(record.drop, m_greyHole, "Actual decision");
+            NS_TEST_EXPECT_MSG_EQ(shadowLog->GetDecision(i, 1), true, "Shadow decision");
+        }
+        NS_TEST_EXPECT_MSG_EQ(shadowLog->CountDrops(0), 0, "Shadow never dropping");
+        NS_TEST_EXPECT_MSG_EQ(shadowLog->CountDrops(1), 10, "Shadow always dropping");
+        NS_TEST_EXPECT_MSG_EQ(shadowLog->CountDrops(2), 10, "Shadow selecting the source");
+
+        // Magic, version and counts, then 19 bytes per record and its decision word
+        std::string filename = CreateTempDirFilename("shadow-decisions.bin");
+        shadowLog->Save(filename);
+        std::ifstream is(filename, std::ios::binary);
+        char header[17];
+        is.read(header, sizeof(header));
+        NS_TEST_EXPECT_MSG_EQ(std::string(header, 4), "GAAD", "Magic");
+        NS_TEST_EXPECT_MSG_EQ(int(header[4]), 1, "Version");
+        NS_TEST_EXPECT_MSG_EQ(int(header[5]), 3, "Strategy count");
+        NS_TEST_EXPECT_MSG_EQ(int(header[9]), 10, "Record count");
+        is.seekg(0, std::ios::end);
+        NS_TEST_EXPECT_MSG_EQ(uint64_t(is.tellg()), 17 + 10 * (19 + 8), "File size");
+
+        Ptr<ShadowDecisionLog> bounded =
+            CreateObjectWithAttributes<ShadowDecisionLog>("MaxRecords", UintegerValue(4));
+        uint64_t decisions = 0;
+        for (uint32_t i = 0; i < shadowLog->GetNRecords(); ++i)
+        {
+            bounded->Add(shadowLog->GetRecord(i), &decisions);
+        }
+        NS_TEST_EXPECT_MSG_EQ(bounded->GetNRecords(), 4, "Records kept by a full log");
+        NS_TEST_EXPECT_MSG_EQ(bounded->GetNMissed(), 6, "Records missed by a full log");
+    }
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief With a fixed seed and assigned streams, recording shadow decisions
+ * changes neither the actual decisions nor the delivery
+ *
+ * Two grey hole relays drop half of the packets of a chain.  The streams
+ * of the second relay follow those of the first, so shadow random
+ * variables taking streams from the same range would change its decisions.
+ */
+class greyattackaodvShadowStreamsTest : public TestCase
+{
+  public:
+    greyattackaodvShadowStreamsTest()
+        : TestCase("Shadow strategies leave the streams of the run alone")
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /// Decisions and delivery of a run
+    struct Outcome
+    {
+        std::vector<std::string> decisions; ///< relay, packet and decision, in order
+        uint32_t received{0};               ///< number of received packets
+    };
+
+    /**
+     * Run the chain
+     * \param shadow record shadow decisions on the relays
+     * \returns the decisions and delivery
+     */
+    Outcome Run(bool shadow);
+    /**
+     * Record an attack decision
+     * \param context the relay
+     * \param packetId the IP identification of the packet
+     * \param precursor the precursor
+     * \param nextHop the next hop
+     * \param strategy the active strategy
+     * \param drop true if the packet is dropped
+     */
+    void Decision(std::string context,
+                  uint16_t packetId,
+                  Ipv4Address precursor,
+                  Ipv4Address nextHop,
+                  AttackStratSelect strategy,
+                  bool drop);
+    /**
+     * Send a data packet
+     * \param socket the sending socket
+     * \param dst the destination
+     */
+    void Send(Ptr<Socket> socket, Ipv4Address dst);
+    /**
+     * Receive packets
+     * \param socket the receiving socket
+     */
+    void Receive(Ptr<Socket> socket);
+
+    /// Outcome of the current run
+    Outcome m_outcome;
+};
+
+void
+greyattackaodvShadowStreamsTest::Decision(std::string context,
+                                          uint16_t packetId,
+                                          Ipv4Address precursor,
+                                          Ipv4Address nextHop,
+                                          AttackStratSelect strategy,
+                                          bool drop)
+{
+    std::ostringstream oss;
+    oss << context << " " << packetId << " " << drop;
+    m_outcome.decisions.push_back(oss.str());
+}
+
+void
+greyattackaodvShadowStreamsTest::Send(Ptr<Socket> socket, Ipv4Address dst)
+{
+    socket->SendTo(Create<Packet>(512), 0, InetSocketAddress(dst, 9));
+}
+
+void
+greyattackaodvShadowStreamsTest::Receive(Ptr<Socket> socket)
+{
+    while (socket->Recv())
+    {
+        ++m_outcome.received;
+    }
+}
+
+greyattackaodvShadowStreamsTest::Outcome
+greyattackaodvShadowStreamsTest::Run(bool shadow)
+{
+    m_outcome = Outcome();
+    RngSeedManager::SetSeed(7);
+    RngSeedManager::SetRun(1);
+    RngSeedManager::ResetNextStreamIndex();
+
+    NodeContainer nodes;
+    nodes.Create(4);
+    greyattackaodvHelper honest;
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(honest);
+    internet.Install(nodes.Get(0));
+    internet.Install(nodes.Get(3));
+    greyattackaodvHelper relay;
+    relay.SetGreyHole(true);
+    relay.Set("mStrat", UintegerValue(PACKET_DROP_PERC));
+    relay.Set("PercentDrop", DoubleValue(0.5));
+    if (shadow)
+    {
+        Ptr<ShadowDecisionLog> shadowLog = CreateObject<ShadowDecisionLog>();
+        ObjectFactory factory("ns3::greyattackaodv::PercentAttackStrategy");
+        factory.Set("DropProbability", DoubleValue(0.5));
+        shadowLog->AddStrategy(factory);
+        ObjectFactory select("ns3::greyattackaodv::SelectAttackStrategy");
+        select.Set("SelectChance", DoubleValue(0.5));
+        shadowLog->AddStrategy(select);
+        relay.Set("ShadowLog", PointerValue(shadowLog));
+    }
+    internet.SetRoutingHelper(relay);
+    internet.Install(NodeContainer(nodes.Get(1), nodes.Get(2)));
+    SimpleNetDeviceHelper simple;
+    NetDeviceContainer devices = simple.Install(nodes);
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+    relay.AssignStreams(nodes, 0);
+
+    // 0 - 1 - 2 - 3
+    Ptr<SimpleChannel> channel = DynamicCast<SimpleChannel>(devices.Get(0)->GetChannel());
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        for (uint32_t j = i + 2; j < 4; ++j)
+        {
+            Ptr<SimpleNetDevice> a = DynamicCast<SimpleNetDevice>(devices.Get(i));
+            Ptr<SimpleNetDevice> b = DynamicCast<SimpleNetDevice>(devices.Get(j));
+            channel->BlackList(a, b);
+            channel->BlackList(b, a);
+        }
+    }
+    for (uint32_t i = 1; i < 3; ++i)
+    {
+        nodes.Get(i)->GetObject<GreyHoleRoutingProtocol>()->TraceConnect(
+            "AttackDecision",
+            std::to_string(i),
+            MakeCallback(&greyattackaodvShadowStreamsTest::Decision, this));
+    }
+
+    Ptr<Socket> rx = Socket::CreateSocket(nodes.Get(3), UdpSocketFactory::GetTypeId());
+    rx->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+    rx->SetRecvCallback(MakeCallback(&greyattackaodvShadowStreamsTest::Receive, this));
+    Ptr<Socket> tx = Socket::CreateSocket(nodes.Get(0), UdpSocketFactory::GetTypeId());
+    for (uint32_t i = 0; i < 20; ++i)
+    {
+        Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                       Seconds(1) + MilliSeconds(100) * i,
+                                       &greyattackaodvShadowStreamsTest::Send,
+                                       this,
+                                       tx,
+                                       interfaces.GetAddress(3));
+    }
+    Simulator::Stop(Seconds(6));
+    Simulator::Run();
+    tx->Close();
+    rx->Close();
+    Simulator::Destroy();
+    return m_outcome;
+}
+
+void
+greyattackaodvShadowStreamsTest::DoRun()
+{
+    uint32_t seed = RngSeedManager::GetSeed();
+    uint64_t run = RngSeedManager::GetRun();
+    Outcome plain = Run(false);
+    Outcome shadowed = Run(true);
+    RngSeedManager::SetSeed(seed);
+    RngSeedManager::SetRun(run);
+
+    NS_TEST_EXPECT_MSG_GT(plain.decisions.size(), 20, "Both relays decided");
+    NS_TEST_EXPECT_MSG_LT(plain.received, 20, "Some packets dropped");
+    NS_TEST_ASSERT_MSG_EQ(shadowed.decisions.size(),
+                          plain.decisions.size(),
+                          "Number of decisions");
+    for (uint32_t i = 0; i < plain.decisions.size(); ++i)
+    {
+        NS_TEST_EXPECT_MSG_EQ(shadowed.decisions[i], plain.decisions[i], "Decision " << i);
+    }
+    NS_TEST_EXPECT_MSG_EQ(shadowed.received, plain.received, "Delivery");
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief One helper installing several grey hole nodes gives each its own
+ * attack strategy, created by the AttackStrategyFactory attribute
+ */
+class greyattackaodvAttackStrategyFactoryTest : public TestCase
+{
+  public:
+    greyattackaodvAttackStrategyFactoryTest()
+        : TestCase("Attack strategy per node")
+    {
+    }
+
+    void DoRun() override;
+};
+
+void
+greyattackaodvAttackStrategyFactoryTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(3);
+    // The time window strategy runs a timer, which two nodes cannot share
+    ObjectFactory factory("ns3::greyattackaodv::TimeWindowAttackStrategy");
+    factory.Set("DropChance", DoubleValue(1.0));
+    greyattackaodvHelper greyHole;
+    greyHole.Set("AttackStrategyFactory", ObjectFactoryValue(factory));
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(greyHole);
+    internet.Install(nodes);
+    SimpleNetDeviceHelper simple;
+    NetDeviceContainer devices = simple.Install(nodes);
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.0");
+    address.Assign(devices);
+
+    Simulator::Stop(Seconds(1));
+    Simulator::Run();
+    std::vector<Ptr<AttackStrategy>> strategies;
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        Ptr<RoutingProtocol> routing = nodes.Get(i)->GetObject<RoutingProtocol>();
+        NS_TEST_ASSERT_MSG_EQ(routing->GetInstanceTypeId(),
+                              GreyHoleRoutingProtocol::GetTypeId(),
+                              "Grey hole variant");
+        PointerValue strategy;
+        routing->GetAttribute("AttackStrategy", strategy);
+        strategies.push_back(strategy.Get<AttackStrategy>());
+        NS_TEST_ASSERT_MSG_NE(strategies.back(), nullptr, "Strategy created");
+        NS_TEST_EXPECT_MSG_EQ(strategies.back()->GetInstanceTypeId(),
+                              TimeWindowAttackStrategy::GetTypeId(),
+                              "Strategy type");
+        for (uint32_t j = 0; j < i; ++j)
+        {
+            NS_TEST_EXPECT_MSG_NE(strategies[j], strategies[i], "One strategy per node");
+        }
+    }
+    strategies.clear();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief The Schedule of the grey hole routing protocol reaches the time
+ * window and select strategies built from mStrat
+ */
+class greyattackaodvLegacyScheduleTest : public TestCase
+{
+  public:
+    greyattackaodvLegacyScheduleTest()
+        : TestCase("Attack schedule of the mStrat strategies")
+    {
+    }
+
+    void DoRun() override;
+};
+
+void
+greyattackaodvLegacyScheduleTest::DoRun()
+{
+    Ptr<AttackSchedule> schedule =
+        CreateObjectWithAttributes<AttackSchedule>("Duration", TimeValue(Seconds(60)));
+    NodeContainer windowNodes;
+    windowNodes.Create(2);
+    NodeContainer selectNodes;
+    selectNodes.Create(2);
+
+    greyattackaodvHelper window;
+    window.SetGreyHole(true);
+    window.Set("mStrat", UintegerValue(PACKET_DROP_IN_TIME));
+    window.Set("DropWindowChance", DoubleValue(0.5));
+    window.Set("Schedule", PointerValue(schedule));
+    InternetStackHelper windowInternet;
+    windowInternet.SetRoutingHelper(window);
+    windowInternet.Install(windowNodes);
+
+    greyattackaodvHelper select;
+    select.SetGreyHole(true);
+    select.Set("mStrat", UintegerValue(PACKET_DROP_SELECT));
+    select.Set("DropSelectChance", DoubleValue(0.5));
+    select.Set("Schedule", PointerValue(schedule));
+    InternetStackHelper selectInternet;
+    selectInternet.SetRoutingHelper(select);
+    selectInternet.Install(selectNodes);
+    SimpleNetDeviceHelper simple;
+    NetDeviceContainer devices = simple.Install(NodeContainer(windowNodes, selectNodes));
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.0");
+    address.Assign(devices);
+
+    Simulator::Stop(Seconds(1));
+    Simulator::Run();
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        uint32_t windowId = windowNodes.Get(i)->GetId();
+        uint32_t selectId = selectNodes.Get(i)->GetId();
+        NS_TEST_EXPECT_MSG_EQ(schedule->HasWindows(windowId), true, "Windows of node " << windowId);
+        NS_TEST_EXPECT_MSG_EQ(schedule->HasSelection(windowId), false, "No selection");
+        NS_TEST_EXPECT_MSG_EQ(schedule->HasSelection(selectId),
+                              true,
+                              "Selection of node " << selectId);
+        NS_TEST_EXPECT_MSG_EQ(schedule->HasWindows(selectId), false, "No windows");
+    }
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup greyattackaodv-test
+ *
+ * \brief Connection strengths measured from the HELLOs of a neighbour moving away
+ */
+class greyattackaodvLinkQualityTest : public TestCase
+{
+  public:
+    greyattackaodvLinkQualityTest()
+        : TestCase("Link quality monitor")
+    {
+    }
+
+    void DoRun() override;
+};
+
+void
+greyattackaodvLinkQualityTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(2);
+
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator>();
+    positions->Add(Vector(0, 0, 0));
+    positions->Add(Vector(20, 0, 0));
+    mobility.SetPositionAllocator(positions);
+    mobility.Install(nodes);
+
+    WifiHelper wifi;
+    wifi.SetStandard(WIFI_STANDARD_80211a);
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                 "DataMode",
+                                 StringValue("OfdmRate6Mbps"));
+    YansWifiPhyHelper phy;
+    phy.SetChannel(YansWifiChannelHelper::Default().Create());
+    WifiMacHelper mac;
+    mac.SetType("ns3::AdhocWifiMac");
+    NetDeviceContainer devices = wifi.Install(phy, mac, nodes);
+
+    Ptr<TargetNodes> targetNodes = CreateObject<TargetNodes>();
+    greyattackaodvHelper monitored;
+    monitored.Set("MonitorLinkQuality", BooleanValue(true));
+    monitored.Set("targetNodes", PointerValue(targetNodes));
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(monitored);
+    internet.Install(nodes.Get(0));
+    greyattackaodvHelper honest;
+    internet.SetRoutingHelper(honest);
+    internet.Install(nodes.Get(1));
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.255.0");
+    address.Assign(devices);
+
+    Ptr<GreyHoleRoutingProtocol> protocol =
+        DynamicCast<GreyHoleRoutingProtocol>(nodes.Get(0)->GetObject<RoutingProtocol>());
+    NS_TEST_ASSERT_MSG_NE(protocol, nullptr, "MonitorLinkQuality selects the grey hole variant");
+
+    // The neighbour moves from 20 m to 60 m away, while both send a HELLO every second
+    Ptr<MobilityModel> away = nodes.Get(1)->GetObject<MobilityModel>();
+    Simulator::Schedule(Seconds(3), &MobilityModel::SetPosition, away, Vector(60, 0, 0));
+    Simulator::Stop(Seconds(2.9));
+    Simulator::Run();
+    Ptr<LinkQualityMonitor> monitor = protocol->GetLinkQualityMonitor();
+    NS_TEST_ASSERT_MSG_NE(monitor, nullptr, "Monitor created on initialization");
+    double nearRssi = monitor->GetRssi(1);
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+
+    double rssi = monitor->GetRssi(1);
+    NS_TEST_EXPECT_MSG_LT(nearRssi, 0, "HELLOs received while near");
+    NS_TEST_EXPECT_MSG_LT(rssi, nearRssi - 3, "Signal weakened when the neighbour moved away");
+    NS_TEST_EXPECT_MSG_LT(monitor->GetRssiDerivative(1), 0, "Signal weakening");
+    NS_TEST_EXPECT_MSG_EQ_TOL(targetNodes->GetConnectionStrength().Get(1),
+                              rssi,
+                              0.5,
+                              "Connection strength pushed within MinChange");
+    NS_TEST_EXPECT_MSG_EQ(targetNodes->GetConnectionStrength().Get(0), 0, "No frame from itself");
+    NS_TEST_EXPECT_MSG_EQ(targetNodes->CountBelow(rssi + 1), 1, "Counted below its strength");
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup greyattackaodv-test
  *
@@ -742,6 +3312,7 @@ class greyattackaodvTestSuite : public TestSuite
         : TestSuite("routing-greyattackaodv", UNIT)
     {
         AddTestCase(new NeighborTest, TestCase::QUICK);
+        AddTestCase(new NeighborLinkFailureTest, TestCase::QUICK);
         AddTestCase(new TypeHeaderTest, TestCase::QUICK);
         AddTestCase(new RreqHeaderTest, TestCase::QUICK);
         AddTestCase(new RrepHeaderTest, TestCase::QUICK);
@@ -749,8 +3320,40 @@ class greyattackaodvTestSuite : public TestSuite
         AddTestCase(new RerrHeaderTest, TestCase::QUICK);
         AddTestCase(new QueueEntryTest, TestCase::QUICK);
         AddTestCase(new greyattackaodvRqueueTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvRqueueTimeoutTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvRqueueDrainTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvRateLimiterTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvPendingRequestTest, TestCase::QUICK);
         AddTestCase(new greyattackaodvRtableEntryTest, TestCase::QUICK);
         AddTestCase(new greyattackaodvRtableTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvRtableTest(HASH_TABLE), TestCase::QUICK);
+        AddTestCase(new greyattackaodvRtableInPlaceTest(ORDERED_MAP), TestCase::QUICK);
+        AddTestCase(new greyattackaodvRtableInPlaceTest(HASH_TABLE), TestCase::QUICK);
+        AddTestCase(new greyattackaodvRtablePurgeGateTest(ORDERED_MAP), TestCase::QUICK);
+        AddTestCase(new greyattackaodvRtablePurgeGateTest(HASH_TABLE), TestCase::QUICK);
+        AddTestCase(new greyattackaodvRtableBackendTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvSmallVectorTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvAttackStrategyTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvNodeIndexTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvAttackScheduleTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvAttackObservatoryTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvAttackObservatoryRowsTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvDeferredRouteTest(false), TestCase::QUICK);
+        AddTestCase(new greyattackaodvDeferredRouteTest(true), TestCase::QUICK);
+        AddTestCase(new greyattackaodvRerrCoalescingTest(Seconds(0)), TestCase::QUICK);
+        AddTestCase(new greyattackaodvRerrCoalescingTest(MilliSeconds(100)), TestCase::QUICK);
+        AddTestCase(new greyattackaodvInterfaceSocketsTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvRerrCoalescingTest(MilliSeconds(100), true),
+                    TestCase::QUICK);
+        AddTestCase(new greyattackaodvTimerWheelTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvGreyHoleTest(false), TestCase::QUICK);
+        AddTestCase(new greyattackaodvGreyHoleTest(true), TestCase::QUICK);
+        AddTestCase(new greyattackaodvGreyHoleTest(false, true), TestCase::QUICK);
+        AddTestCase(new greyattackaodvGreyHoleTest(true, true), TestCase::QUICK);
+        AddTestCase(new greyattackaodvShadowStreamsTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvAttackStrategyFactoryTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvLegacyScheduleTest, TestCase::QUICK);
+        AddTestCase(new greyattackaodvLinkQualityTest, TestCase::QUICK);
     }
 } g_greyattackaodvTestSuite; ///< the test suite
 
@@ -7,8 +7,14 @@
  * \defgroup shared_vars Description of the shared_vars
  */
 
+#include "ns3/assert.h"
+#include "ns3/node-list.h"
 #include "ns3/object.h"
 
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
 namespace ns3
 {
 
@@ -36,13 +42,261 @@ enum DefenseStratSelect
     INFERENCE
 };
 
+/**
+ * \ingroup shared_vars
+ * \brief Dense per-node values, indexed by node id.
+ *
+ * Reads past the end return the default value, and At() grows the storage
+ * to cover the node, so node ids beyond the initial size never write out of
+ * bounds.  Resize() makes room for all the nodes of the NodeList at once.
+ * The std::vector-like members keep existing code that fills the values
+ * with push_back() and scans them with range-for working.
+ */
+template <typename T>
+class NodeIndexedVector
+{
+  public:
+    /// Iterator over the values
+    typedef typename std::vector<T>::iterator iterator;
+    /// Const iterator over the values
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    /**
+     * \param init value of the nodes not yet written to
+     */
+    NodeIndexedVector(T init = T())
+        : m_init(init)
+    {
+    }
+
+    /// Make room for all the nodes of the NodeList
+    void Resize()
+    {
+        if (m_values.size() < NodeList::GetNNodes())
+        {
+            m_values.resize(NodeList::GetNNodes(), m_init);
+        }
+    }
+
+    /**
+     * \param nodeId the node id
+     * \returns the value of the node, growing the storage if needed
+     */
+    T& At(uint32_t nodeId)
+    {
+        if (nodeId >= m_values.size())
+        {
+            NS_ASSERT_MSG(nodeId < NodeList::GetNNodes() || NodeList::GetNNodes() == 0,
+                          "Node id " << nodeId << " out of range");
+            m_values.resize(std::max<uint32_t>(nodeId + 1, NodeList::GetNNodes()), m_init);
+        }
+        return m_values[nodeId];
+    }
+
+    /**
+     * \param nodeId the node id
+     * \returns the value of the node, or the default value past the end
+     */
+    T Get(uint32_t nodeId) const
+    {
+        return (nodeId < m_values.size()) ? m_values[nodeId] : m_init;
+    }
+
+    /**
+     * \param nodeId the node id, less than size()
+     * \returns the value of the node
+     */
+    T& operator[](uint32_t nodeId)
+    {
+        NS_ASSERT(nodeId < m_values.size());
+        return m_values[nodeId];
+    }
+
+    /**
+     * \param nodeId the node id, less than size()
+     * \returns the value of the node
+     */
+    const T& operator[](uint32_t nodeId) const
+    {
+        NS_ASSERT(nodeId < m_values.size());
+        return m_values[nodeId];
+    }
+
+    /**
+     * Append the value of the next node
+     * \param value the value
+     */
+    void push_back(const T& value)
+    {
+        m_values.push_back(value);
+    }
+
+    /// Forget all the values
+    void clear()
+    {
+        m_values.clear();
+    }
+
+    /**
+     * \returns the number of nodes with storage
+     */
+    uint32_t size() const
+    {
+        return m_values.size();
+    }
+
+    /**
+     * \returns true if no node has storage
+     */
+    bool empty() const
+    {
+        return m_values.empty();
+    }
+
+    /// \returns iterator to the value of node 0
+    iterator begin()
+    {
+        return m_values.begin();
+    }
+
+    /// \returns past-the-end iterator
+    iterator end()
+    {
+        return m_values.end();
+    }
+
+    /// \returns iterator to the value of node 0
+    const_iterator begin() const
+    {
+        return m_values.begin();
+    }
+
+    /// \returns past-the-end iterator
+    const_iterator end() const
+    {
+        return m_values.end();
+    }
+
+  private:
+    T m_init;                ///< value of the nodes not yet written to
+    std::vector<T> m_values; ///< values, by node id
+};
+
 // Define a new class here:
+/**
+ * \ingroup shared_vars
+ * \brief Connection strength of the nodes, as seen by an attacker.
+ *
+ * The strengths are only written through SetConnectionStrength(), which
+ * keeps the number of nodes below each tracked threshold up to date, so that
+ * reading it does not scan the nodes.
+ */
 class TargetNodes : public Object
 {
   public:
     std::vector<uint32_t> node;
-    std::vector<float> connection_strength;
-    std::vector<float> d_connection_strength;
+    NodeIndexedVector<float> d_connection_strength;
+
+    /**
+     * \returns the connection strength of the nodes, by node id
+     */
+    const NodeIndexedVector<float>& GetConnectionStrength() const
+    {
+        return m_connectionStrength;
+    }
+
+    /**
+     * Set the connection strength of a node and update the counts
+     * \param nodeId the node id
+     * \param strength the connection strength
+     */
+    void SetConnectionStrength(uint32_t nodeId, float strength)
+    {
+        float old = m_connectionStrength.Get(nodeId);
+        uint32_t size = m_connectionStrength.size();
+        m_connectionStrength.At(nodeId) = strength;
+        // The nodes given storage on the way hold the default value, as old did
+        uint32_t added = m_connectionStrength.size() - size;
+        for (uint32_t i = 0; i < m_thresholds.size(); ++i)
+        {
+            if (old < m_thresholds[i])
+            {
+                m_below[i] += added;
+                --m_below[i];
+            }
+            if (strength < m_thresholds[i])
+            {
+                ++m_below[i];
+            }
+        }
+    }
+
+    /**
+     * Keep the number of nodes below a threshold up to date from now on
+     * \param threshold the connection strength threshold
+     */
+    void TrackThreshold(float threshold)
+    {
+        auto it = std::lower_bound(m_thresholds.begin(), m_thresholds.end(), threshold);
+        if (it != m_thresholds.end() && *it == threshold)
+        {
+            return;
+        }
+        m_below.insert(m_below.begin() + (it - m_thresholds.begin()), Count(threshold));
+        m_thresholds.insert(it, threshold);
+    }
+
+    /**
+     * \param threshold the connection strength threshold
+     * \returns the number of nodes with storage whose strength is below the
+     * threshold; only tracked thresholds are answered without a scan
+     */
+    uint32_t CountBelow(float threshold) const
+    {
+        auto it = std::lower_bound(m_thresholds.begin(), m_thresholds.end(), threshold);
+        if (it != m_thresholds.end() && *it == threshold)
+        {
+            return m_below[it - m_thresholds.begin()];
+        }
+        return Count(threshold);
+    }
+
+    /**
+     * \returns the number of nodes with storage in each of the intervals
+     * delimited by the tracked thresholds, in increasing order; one more
+     * interval than thresholds
+     */
+    std::vector<uint32_t> GetHistogram() const
+    {
+        std::vector<uint32_t> histogram;
+        uint32_t below = 0;
+        for (auto count : m_below)
+        {
+            histogram.push_back(count - below);
+            below = count;
+        }
+        histogram.push_back(m_connectionStrength.size() - below);
+        return histogram;
+    }
+
+  private:
+    /**
+     * \param threshold the connection strength threshold
+     * \returns the number of nodes with storage below the threshold, by a scan
+     */
+    uint32_t Count(float threshold) const
+    {
+        uint32_t below = 0;
+        for (auto strength : m_connectionStrength)
+        {
+            below += (strength < threshold);
+        }
+        return below;
+    }
+
+    NodeIndexedVector<float> m_connectionStrength; ///< connection strength, by node id
+    std::vector<float> m_thresholds;               ///< tracked thresholds, in increasing order
+    std::vector<uint32_t> m_below;                 ///< nodes below each tracked threshold
 };
 
 class DetectedPacketClass : public Object
@@ -130,7 +384,7 @@ class GymVariables : public Object
 class DroppedStats : public Object
 {
   public:
-    std::vector<uint32_t> drop_count;
+    NodeIndexedVector<uint32_t> drop_count;
 };
 }
 
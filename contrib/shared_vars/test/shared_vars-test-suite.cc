@@ -3,6 +3,8 @@
 #include "ns3/shared_vars.h"
 
 // An essential include is test.h
+#include "ns3/node-container.h"
+#include "ns3/simulator.h"
 #include "ns3/test.h"
 
 // Do not put your test classes in namespace ns3.  You may find it useful
@@ -57,6 +59,95 @@ Shared_varsTestCase1::DoRun()
     NS_TEST_ASSERT_MSG_EQ_TOL(0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+/**
+ * \ingroup shared_vars-tests
+ * Test case for NodeIndexedVector
+ */
+class NodeIndexedVectorTestCase : public TestCase
+{
+  public:
+    NodeIndexedVectorTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+NodeIndexedVectorTestCase::NodeIndexedVectorTestCase()
+    : TestCase("NodeIndexedVector grows on write and defaults on read")
+{
+}
+
+void
+NodeIndexedVectorTestCase::DoRun()
+{
+    NodeIndexedVector<float> values(-1.0);
+    NS_TEST_ASSERT_MSG_EQ(values.empty(), true, "Empty until written to");
+    NS_TEST_ASSERT_MSG_EQ(values.Get(300), -1.0, "Default value past the end");
+    values.At(300) = 2.0;
+    NS_TEST_ASSERT_MSG_EQ(values.size(), 301, "Grown to cover node 300");
+    NS_TEST_ASSERT_MSG_EQ(values[299], -1.0, "Intermediate nodes get the default value");
+    NS_TEST_ASSERT_MSG_EQ(values.Get(300), 2.0, "Value written");
+
+    NodeContainer nodes;
+    nodes.Create(400);
+    values.Resize();
+    NS_TEST_ASSERT_MSG_EQ(values.size(), 400, "Sized from the NodeList");
+    NS_TEST_ASSERT_MSG_EQ(values[300], 2.0, "Values kept on resize");
+    Simulator::Destroy();
+}
+
+class TargetNodesTestCase : public TestCase
+{
+  public:
+    TargetNodesTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+TargetNodesTestCase::TargetNodesTestCase()
+    : TestCase("TargetNodes counts the nodes below its thresholds incrementally")
+{
+}
+
+void
+TargetNodesTestCase::DoRun()
+{
+    Ptr<TargetNodes> targetNodes = CreateObject<TargetNodes>();
+    targetNodes->SetConnectionStrength(0, 0.5);
+    targetNodes->TrackThreshold(1.0);
+    targetNodes->TrackThreshold(-50.0);
+    NS_TEST_ASSERT_MSG_EQ(targetNodes->CountBelow(1.0), 1, "Existing values counted");
+
+    // Nodes 1 to 3 get the default strength, 0
+    targetNodes->SetConnectionStrength(4, -70.0);
+    NS_TEST_ASSERT_MSG_EQ(targetNodes->CountBelow(1.0), 5, "Nodes given storage counted");
+    NS_TEST_ASSERT_MSG_EQ(targetNodes->CountBelow(-50.0), 1, "Weak node counted");
+    targetNodes->SetConnectionStrength(0, 2.0);
+    targetNodes->SetConnectionStrength(4, -40.0);
+    NS_TEST_ASSERT_MSG_EQ(targetNodes->CountBelow(1.0), 4, "Node 0 above 1");
+    NS_TEST_ASSERT_MSG_EQ(targetNodes->CountBelow(-50.0), 0, "Node 4 above -50");
+    NS_TEST_ASSERT_MSG_EQ(targetNodes->CountBelow(0.5), 4, "Untracked threshold scanned");
+
+    std::vector<uint32_t> histogram = targetNodes->GetHistogram();
+    NS_TEST_ASSERT_MSG_EQ(histogram.size(), 3, "One more interval than thresholds");
+    NS_TEST_ASSERT_MSG_EQ(histogram[0], 0, "Below -50");
+    NS_TEST_ASSERT_MSG_EQ(histogram[1], 4, "Between -50 and 1");
+    NS_TEST_ASSERT_MSG_EQ(histogram[2], 1, "Above 1");
+
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        targetNodes->SetConnectionStrength(i, -60.0);
+    }
+    NS_TEST_ASSERT_MSG_EQ(targetNodes->CountBelow(-50.0), 5, "All nodes below -50");
+    targetNodes->SetConnectionStrength(3, 0.0);
+    NS_TEST_ASSERT_MSG_EQ(targetNodes->CountBelow(-50.0), 4, "Node 3 above -50");
+    NS_TEST_ASSERT_MSG_EQ(targetNodes->CountBelow(-50.0),
+                          targetNodes->CountBelow(-50.5),
+                          "Tracked count agrees with a scan");
+    NS_TEST_ASSERT_MSG_EQ(targetNodes->GetConnectionStrength().Get(3), 0.0, "Value read back");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -76,6 +167,8 @@ Shared_varsTestSuite::Shared_varsTestSuite()
 {
     // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
     AddTestCase(new Shared_varsTestCase1, TestCase::QUICK);
+    AddTestCase(new NodeIndexedVectorTestCase, TestCase::QUICK);
+    AddTestCase(new TargetNodesTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite